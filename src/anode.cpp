@@ -108,6 +108,20 @@ const void *anode_t::s_field_visits(const void *buffer, size_t bufsize, size_t&
    return (u_char*) buffer + base_node<anode_t>::s_data_size(buffer, bufsize) + sizeof(uint64_t);
 }
 
+bool anode_t::s_is_robot(const void *buffer, size_t bufsize)
+{
+   serializer_t sr(buffer, bufsize);
+   size_t datasize;
+   bool robot;
+
+   if(s_node_ver(buffer) < 2)
+      return false;
+
+   sr.deserialize((u_char*) s_field_value_hash(buffer, bufsize, datasize) + datasize, robot);
+
+   return robot;
+}
+
 int64_t anode_t::s_compare_hits(const void *buf1, size_t buf1size, const void *buf2, size_t buf2size)
 {
    return s_compare<uint64_t>(buf1, buf1size, buf2, buf2size);
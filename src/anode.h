@@ -65,6 +65,9 @@ struct anode_t : public base_node<anode_t> {
          /// Returns a pointer to the visit count value within a serialized user agent node data.
          static const void *s_field_visits(const void *buffer, size_t bufsize, size_t& datasize);
 
+         /// Returns `true` if a serialized user agent node data describes a robot.
+         static bool s_is_robot(const void *buffer, size_t bufsize);
+
          /// Compares two serialized hit count values.
          static int64_t s_compare_hits(const void *buf1, size_t buf1size, const void *buf2, size_t buf2size);
 
@@ -0,0 +1,219 @@
+/*
+    webalizer - a web server log analysis program
+
+    Copyright (c) 2004-2022, Stone Steps Inc. (www.stonesteps.ca)
+
+    See COPYING and Copyright files for additional licensing and copyright information
+
+    log_generator.cpp
+*/
+#include "log_generator.h"
+
+#include <algorithm>
+#include <cinttypes>
+#include <cmath>
+#include <cstring>
+
+log_generator_t::zipf_dist_t::zipf_dist_t(size_t count, double skew)
+{
+   double sum = 0;
+
+   cdf.reserve(count);
+
+   // rank r has the weight of 1/r^s, so a zero skew yields a uniform distribution
+   for(size_t rank = 1; rank <= count; rank++)
+      cdf.push_back(sum += 1. / std::pow((double) rank, skew));
+
+   for(double& prob : cdf)
+      prob /= sum;
+}
+
+size_t log_generator_t::zipf_dist_t::operator () (std::mt19937_64& rng) const
+{
+   double prob = std::uniform_real_distribution<double>(0., 1.)(rng);
+
+   return std::min((size_t) (std::lower_bound(cdf.begin(), cdf.end(), prob) - cdf.begin()), cdf.size() - 1);
+}
+
+log_generator_t::log_generator_t(const params_t& params) :
+      params(params),
+      rng(params.seed),
+      host_dist(std::max<size_t>(params.hosts, 1), params.skew),
+      url_dist(std::max<size_t>(params.urls, 1), params.skew),
+      ref_dist(std::max<size_t>(params.referrers, 1), params.skew),
+      agent_dist(std::max<size_t>(params.agents, 1), params.skew)
+{
+   make_items();
+}
+
+const char *log_generator_t::get_log_type(log_format_t log_format)
+{
+   switch(log_format) {
+      case FORMAT_NGINX:
+         return "nginx";
+      case FORMAT_W3C:
+         return "w3c";
+      case FORMAT_SQUID:
+         return "squid";
+      case FORMAT_APACHE:
+      default:
+         return "apache";
+   }
+}
+
+const char *log_generator_t::get_log_format(log_format_t log_format)
+{
+   switch(log_format) {
+      case FORMAT_APACHE:
+         return "%h %l %u %t \"%r\" %>s %b \"%{Referer}i\" \"%{User-Agent}i\"";
+      case FORMAT_NGINX:
+         return "$remote_addr - $remote_user [$time_local] \"$request\" $status $bytes_sent \"$http_referer\" \"$http_user_agent\"";
+      default:
+         return nullptr;
+   }
+}
+
+///
+/// Item strings are generated from their indexes, so the same parameters always
+/// generate the same item sets. W3C logs cannot contain spaces within fields, so
+/// spaces in user agents are replaced with `+`, the same way IIS does it.
+///
+void log_generator_t::make_items(void)
+{
+   static const char *browsers[] = {
+      "Mozilla/5.0 (Windows NT 10.0; Win64; x64) AppleWebKit/537.36 (KHTML, like Gecko) Chrome/%zu.0.%zu.0 Safari/537.36",
+      "Mozilla/5.0 (Macintosh; Intel Mac OS X 10_15_7) AppleWebKit/605.1.15 (KHTML, like Gecko) Version/%zu.%zu Safari/605.1.15",
+      "Mozilla/5.0 (X11; Linux x86_64; rv:%zu.%zu) Gecko/20100101 Firefox/%zu.0",
+      "Mozilla/5.0 (iPhone; CPU iPhone OS %zu_%zu like Mac OS X) AppleWebKit/605.1.15 (KHTML, like Gecko) Mobile/15E148",
+      "Mozilla/5.0 (compatible; Googlebot/2.%zu; +http://www.google.com/bot.html) Build/%zu"
+   };
+
+   static const char *url_types[] = {
+      "/section-%zu/page-%zu.html",
+      "/section-%zu/article-%zu/",
+      "/images/img-%zu-%zu.png",
+      "/scripts/lib-%zu-%zu.js",
+      "/search.php?q=term-%zu&page=%zu",
+      "/downloads/file-%zu-%zu.zip"
+   };
+
+   char buffer[512];
+   size_t i;
+
+   hosts.clear();
+   urls.clear();
+   referrers.clear();
+   agents.clear();
+
+   // host addresses are unique across the 11.0.0.0 and up range
+   for(i = 0; i < std::max<size_t>(params.hosts, 1); i++) {
+      uint32_t ipaddr = 0x0B000001u + (uint32_t) i;
+      snprintf(buffer, sizeof(buffer), "%u.%u.%u.%u", ipaddr >> 24, (ipaddr >> 16) & 0xFF, (ipaddr >> 8) & 0xFF, ipaddr & 0xFF);
+      hosts.emplace_back(buffer);
+   }
+
+   for(i = 0; i < std::max<size_t>(params.urls, 1); i++) {
+      snprintf(buffer, sizeof(buffer), url_types[i % (sizeof(url_types)/sizeof(url_types[0]))], i / 100, i);
+      urls.emplace_back(buffer);
+   }
+
+   // the most common referrer is no referrer, followed by search engines and other sites
+   for(i = 0; i < std::max<size_t>(params.referrers, 1); i++) {
+      if(i == 0)
+         referrers.emplace_back("-");
+      else {
+         if(i % 4 == 1)
+            snprintf(buffer, sizeof(buffer), "https://www.google.com/search?q=keyword+%zu&hl=en", i);
+         else
+            snprintf(buffer, sizeof(buffer), "https://site-%zu.example.com/path-%zu/", i / 10, i);
+         referrers.emplace_back(buffer);
+      }
+   }
+
+   for(i = 0; i < std::max<size_t>(params.agents, 1); i++) {
+      snprintf(buffer, sizeof(buffer), browsers[i % (sizeof(browsers)/sizeof(browsers[0]))], 60 + i / 50, i % 50, 60 + i / 50);
+
+      if(params.log_format == FORMAT_W3C)
+         std::replace(buffer, buffer + strlen(buffer), ' ', '+');
+
+      agents.emplace_back(buffer);
+   }
+}
+
+int log_generator_t::write_record(FILE *file, time_t tstamp)
+{
+   static const char *methods[] = {"GET", "GET", "GET", "GET", "GET", "GET", "GET", "POST", "HEAD", "GET"};
+   static const int statuses[] = {200, 200, 200, 200, 200, 200, 200, 200, 200, 200, 200, 200, 200, 200, 200, 200, 304, 304, 404, 500};
+
+   const std::string& host = hosts[host_dist(rng)];
+   const std::string& url = urls[url_dist(rng)];
+   const std::string& referrer = referrers[ref_dist(rng)];
+   const std::string& agent = agents[agent_dist(rng)];
+   const char *method = methods[rng() % (sizeof(methods)/sizeof(methods[0]))];
+   int status = statuses[rng() % (sizeof(statuses)/sizeof(statuses[0]))];
+   uint64_t xfer = status == 304 ? 0 : 200 + rng() % 50000;
+   uint64_t proc_time = rng() % 500;
+   char tsbuf[64];
+   struct tm tm;
+
+   gmtime_r(&tstamp, &tm);
+
+   switch(params.log_format) {
+      case FORMAT_APACHE:
+      case FORMAT_NGINX:
+         strftime(tsbuf, sizeof(tsbuf), "%d/%b/%Y:%H:%M:%S +0000", &tm);
+         return fprintf(file, "%s - - [%s] \"%s %s HTTP/1.1\" %d %" PRIu64 " \"%s\" \"%s\"\n",
+                     host.c_str(), tsbuf, method, url.c_str(), status, xfer, referrer.c_str(), agent.c_str());
+
+      case FORMAT_W3C: {
+         std::string::size_type qmark = url.find('?');
+         std::string stem(url, 0, qmark);
+         const char *query = qmark != std::string::npos ? url.c_str() + qmark + 1 : "-";
+
+         strftime(tsbuf, sizeof(tsbuf), "%Y-%m-%d %H:%M:%S", &tm);
+         // W3C logs request processing time in seconds
+         return fprintf(file, "%s %s - %s %s %s %d %" PRIu64 " %.3f %s %s\n",
+                     tsbuf, host.c_str(), method, stem.c_str(), query, status, xfer, proc_time / 1000., agent.c_str(), referrer.c_str());
+      }
+
+      case FORMAT_SQUID:
+         return fprintf(file, "%" PRId64 ".%03" PRIu64 " %6" PRIu64 " %s TCP_MISS/%03d %" PRIu64 " %s http://www.example.com%s - DIRECT/192.0.2.1 text/html\n",
+                     (int64_t) tstamp, proc_time, proc_time, host.c_str(), status, xfer, method, url.c_str());
+   }
+
+   return -1;
+}
+
+int64_t log_generator_t::write_log(const char *path)
+{
+   FILE *file;
+   int64_t bytes = 0;
+   int written;
+   uint64_t span = (uint64_t) params.days * 86400;
+
+   if((file = fopen(path, "w")) == nullptr)
+      return -1;
+
+   if(params.log_format == FORMAT_W3C) {
+      if((written = fprintf(file, "#Software: webalizer-bench\n#Version: 1.0\n"
+                                  "#Fields: date time c-ip cs-username cs-method cs-uri-stem cs-uri-query sc-status sc-bytes time-taken cs(User-Agent) cs(Referer)\n")) < 0) {
+         fclose(file);
+         return -1;
+      }
+      bytes += written;
+   }
+
+   // time stamps are derived from record numbers, so they never go backwards
+   for(uint64_t recnum = 0; recnum < params.records; recnum++) {
+      if((written = write_record(file, params.start + (time_t) (recnum * span / params.records))) < 0) {
+         fclose(file);
+         return -1;
+      }
+      bytes += written;
+   }
+
+   if(fclose(file))
+      return -1;
+
+   return bytes;
+}
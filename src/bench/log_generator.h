@@ -0,0 +1,107 @@
+/*
+    webalizer - a web server log analysis program
+
+    Copyright (c) 2004-2022, Stone Steps Inc. (www.stonesteps.ca)
+
+    See COPYING and Copyright files for additional licensing and copyright information
+
+    log_generator.h
+*/
+#ifndef LOG_GENERATOR_H
+#define LOG_GENERATOR_H
+
+#include <cstdint>
+#include <cstdio>
+#include <ctime>
+#include <random>
+#include <string>
+#include <vector>
+
+///
+/// @brief  Generates synthetic log files with a configurable number of distinct
+///         hosts, URLs, referrers and user agents.
+///
+/// Each log record picks a host, a URL, a referrer and a user agent from their
+/// respective item sets, using a Zipf distribution, so a few items appear in most
+/// log records, like in real traffic. A zero skew picks items uniformly. Log record
+/// time stamps are spread evenly across the requested number of days.
+///
+/// The same parameters and seed always generate the same log file, so different
+/// builds may be measured against the same workload.
+///
+class log_generator_t {
+   public:
+      ///
+      /// @brief  Generated log file formats
+      ///
+      enum log_format_t {
+         FORMAT_APACHE,             ///< Apache combined log format
+         FORMAT_NGINX,              ///< Nginx combined log format
+         FORMAT_W3C,                ///< W3C extended log format
+         FORMAT_SQUID               ///< Squid native log format
+      };
+
+      ///
+      /// @brief  Log generator parameters
+      ///
+      struct params_t {
+         log_format_t   log_format = FORMAT_APACHE;   ///< Log file format
+         uint64_t       records = 1000000;            ///< Number of log records
+         size_t         hosts = 50000;                ///< Number of distinct hosts
+         size_t         urls = 20000;                 ///< Number of distinct URLs
+         size_t         referrers = 10000;            ///< Number of distinct referrers
+         size_t         agents = 2000;                ///< Number of distinct user agents
+         double         skew = 1.0;                   ///< Zipf distribution exponent
+         uint64_t       seed = 1;                     ///< Random number generator seed
+         time_t         start = 1654041600;           ///< Time stamp of the first log record (2022-06-01 00:00:00 UTC)
+         unsigned int   days = 1;                     ///< Number of days spanned by log records
+      };
+
+   private:
+      ///
+      /// @brief  Picks item indexes with a Zipf distribution
+      ///
+      class zipf_dist_t {
+         private:
+            std::vector<double> cdf;      ///< Cumulative probabilities of item ranks
+
+         public:
+            zipf_dist_t(size_t count, double skew);
+
+            size_t operator () (std::mt19937_64& rng) const;
+      };
+
+   private:
+      params_t                   params;     ///< Log generator parameters
+
+      std::mt19937_64            rng;        ///< Random number generator
+
+      std::vector<std::string>   hosts;      ///< Host IP addresses
+      std::vector<std::string>   urls;       ///< URL paths, with optional query strings
+      std::vector<std::string>   referrers;  ///< Referrer URLs
+      std::vector<std::string>   agents;     ///< User agents
+
+      zipf_dist_t                host_dist;  ///< Host index distribution
+      zipf_dist_t                url_dist;   ///< URL index distribution
+      zipf_dist_t                ref_dist;   ///< Referrer index distribution
+      zipf_dist_t                agent_dist; ///< User agent index distribution
+
+   private:
+      void make_items(void);
+
+      int write_record(FILE *file, time_t tstamp);
+
+   public:
+      log_generator_t(const params_t& params);
+
+      /// Writes a log file with the configured number of log records. Returns the number of bytes written or -1 if an error occurred.
+      int64_t write_log(const char *path);
+
+      /// Returns the log type name for the `LogType` configuration keyword.
+      static const char *get_log_type(log_format_t log_format);
+
+      /// Returns the log format for `ApacheLogFormat` or `NginxLogFormat`, or `nullptr` if the log format needs no configuration.
+      static const char *get_log_format(log_format_t log_format);
+};
+
+#endif // LOG_GENERATOR_H
@@ -0,0 +1,263 @@
+/*
+    webalizer - a web server log analysis program
+
+    Copyright (c) 2004-2022, Stone Steps Inc. (www.stonesteps.ca)
+
+    See COPYING and Copyright files for additional licensing and copyright information
+
+    main.cpp
+
+    An end-to-end throughput benchmark, which generates a synthetic log file in
+    a temporary directory and runs the webalizer executable against it, so every
+    stage of log processing, from reading log files to generating reports, is
+    measured.
+*/
+#include "log_generator.h"
+
+#include <cerrno>
+#include <chrono>
+#include <cinttypes>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+#include <ftw.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+
+///
+/// @brief  Benchmark options
+///
+struct bench_options_t {
+   log_generator_t::params_t  params;           ///< Log generator parameters
+   std::string                webalizer;        ///< Path to the webalizer executable
+   std::string                tmp_dir;          ///< Parent directory for the benchmark directory
+   std::string                include;          ///< Additional configuration file included in the benchmark configuration
+   bool                       reader_thread = false;  ///< Read log files in a separate thread?
+   bool                       keep = false;     ///< Keep the benchmark directory?
+};
+
+static void print_usage(const char *argv0)
+{
+   printf("Usage: %s [options]\n\n", argv0);
+   printf("  -t apache|nginx|w3c|squid   log format (apache)\n");
+   printf("  -n records                  number of log records (1000000)\n");
+   printf("  -H hosts                    number of distinct hosts (50000)\n");
+   printf("  -U urls                     number of distinct URLs (20000)\n");
+   printf("  -R referrers                number of distinct referrers (10000)\n");
+   printf("  -A agents                   number of distinct user agents (2000)\n");
+   printf("  -s skew                     Zipf distribution exponent (1.0)\n");
+   printf("  -S seed                     random number generator seed (1)\n");
+   printf("  -d days                     number of days spanned by log records (1)\n");
+   printf("  -w webalizer                webalizer executable (next to this executable)\n");
+   printf("  -T directory                parent of the benchmark directory ($TMPDIR or /tmp)\n");
+   printf("  -c config                   configuration file included in the benchmark configuration\n");
+   printf("  -r                          read log files in a separate thread\n");
+   printf("  -k                          keep the benchmark directory\n");
+}
+
+static bool parse_options(int argc, char *argv[], bench_options_t& options)
+{
+   for(int i = 1; i < argc; i++) {
+      const char *opt = argv[i];
+
+      if(*opt != '-' || !opt[1] || opt[2])
+         return false;
+
+      // options without values
+      if(opt[1] == 'r') {
+         options.reader_thread = true;
+         continue;
+      }
+
+      if(opt[1] == 'k') {
+         options.keep = true;
+         continue;
+      }
+
+      if(++i == argc)
+         return false;
+
+      const char *value = argv[i];
+
+      switch(opt[1]) {
+         case 't':
+            if(!strcmp(value, "apache"))
+               options.params.log_format = log_generator_t::FORMAT_APACHE;
+            else if(!strcmp(value, "nginx"))
+               options.params.log_format = log_generator_t::FORMAT_NGINX;
+            else if(!strcmp(value, "w3c"))
+               options.params.log_format = log_generator_t::FORMAT_W3C;
+            else if(!strcmp(value, "squid"))
+               options.params.log_format = log_generator_t::FORMAT_SQUID;
+            else
+               return false;
+            break;
+         case 'n': options.params.records = strtoull(value, nullptr, 10); break;
+         case 'H': options.params.hosts = strtoull(value, nullptr, 10); break;
+         case 'U': options.params.urls = strtoull(value, nullptr, 10); break;
+         case 'R': options.params.referrers = strtoull(value, nullptr, 10); break;
+         case 'A': options.params.agents = strtoull(value, nullptr, 10); break;
+         case 's': options.params.skew = strtod(value, nullptr); break;
+         case 'S': options.params.seed = strtoull(value, nullptr, 10); break;
+         case 'd': options.params.days = (unsigned int) strtoul(value, nullptr, 10); break;
+         case 'w': options.webalizer = value; break;
+         case 'T': options.tmp_dir = value; break;
+         case 'c': options.include = value; break;
+         default:
+            return false;
+      }
+   }
+
+   return options.params.records != 0 && options.params.days != 0;
+}
+
+///
+/// The benchmark configuration is saved as `webalizer.conf` in the benchmark
+/// directory, which is the current directory of the webalizer process, so it is
+/// picked up as the default configuration file and no other configuration files
+/// are read.
+///
+static bool write_config(const std::string& path, const std::string& bench_dir, const bench_options_t& options)
+{
+   const char *log_format = log_generator_t::get_log_format(options.params.log_format);
+   FILE *file;
+
+   if((file = fopen(path.c_str(), "w")) == nullptr)
+      return false;
+
+   fprintf(file, "LogType %s\n", log_generator_t::get_log_type(options.params.log_format));
+
+   if(options.params.log_format == log_generator_t::FORMAT_APACHE)
+      fprintf(file, "ApacheLogFormat %s\n", log_format);
+   else if(options.params.log_format == log_generator_t::FORMAT_NGINX)
+      fprintf(file, "NginxLogFormat %s\n", log_format);
+
+   fprintf(file, "OutputDir %s\n", bench_dir.c_str());
+   fprintf(file, "DbPath %s\n", bench_dir.c_str());
+   fprintf(file, "Incremental no\n");
+   fprintf(file, "Quiet yes\n");
+   fprintf(file, "TimeMe yes\n");
+   fprintf(file, "Profile yes\n");
+   fprintf(file, "ProfileName profile.json\n");
+   fprintf(file, "LogReaderThread %s\n", options.reader_thread ? "yes" : "no");
+
+   if(!options.include.empty())
+      fprintf(file, "Include %s\n", options.include.c_str());
+
+   return !fclose(file);
+}
+
+static int remove_path_cb(const char *path, const struct stat *sb, int typeflag, struct FTW *ftwbuf)
+{
+   return remove(path);
+}
+
+///
+/// Runs the webalizer executable in the benchmark directory and returns its exit
+/// code or -1 if it could not be started or was terminated by a signal.
+///
+static int run_webalizer(const bench_options_t& options, const std::string& bench_dir, const std::string& log_path, struct rusage& usage)
+{
+   int status;
+   pid_t pid;
+
+   if((pid = fork()) == -1)
+      return -1;
+
+   if(pid == 0) {
+      if(chdir(bench_dir.c_str()) == 0)
+         execl(options.webalizer.c_str(), options.webalizer.c_str(), log_path.c_str(), (char*) nullptr);
+
+      fprintf(stderr, "Cannot run %s (%s)\n", options.webalizer.c_str(), strerror(errno));
+      _exit(127);
+   }
+
+   if(wait4(pid, &status, 0, &usage) == -1)
+      return -1;
+
+   return WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+}
+
+int main(int argc, char *argv[])
+{
+   bench_options_t options;
+   std::chrono::steady_clock::time_point start;
+   double gen_secs, run_secs;
+   struct rusage usage;
+   int64_t log_size;
+   int retcode;
+
+   if(!parse_options(argc, argv, options)) {
+      print_usage(argv[0]);
+      return EXIT_FAILURE;
+   }
+
+   // look for webalizer next to this executable, unless a path was specified
+   if(options.webalizer.empty()) {
+      const char *slash = strrchr(argv[0], '/');
+      options.webalizer = slash ? std::string(argv[0], slash - argv[0] + 1) + "webalizer" : "./webalizer";
+   }
+
+   // make the webalizer path absolute because webalizer runs in the benchmark directory
+   if(options.webalizer[0] != '/') {
+      char *cwd = getcwd(nullptr, 0);
+      options.webalizer = std::string(cwd ? cwd : ".") + "/" + options.webalizer;
+      free(cwd);
+   }
+
+   if(options.tmp_dir.empty())
+      options.tmp_dir = getenv("TMPDIR") && *getenv("TMPDIR") ? getenv("TMPDIR") : "/tmp";
+
+   std::string bench_dir = options.tmp_dir + "/webalizer-bench-XXXXXX";
+
+   if(mkdtemp(&bench_dir[0]) == nullptr) {
+      fprintf(stderr, "Cannot create a benchmark directory in %s (%s)\n", options.tmp_dir.c_str(), strerror(errno));
+      return EXIT_FAILURE;
+   }
+
+   std::string log_path = bench_dir + "/access.log";
+
+   printf("Generating %" PRIu64 " %s log records in %s\n", options.params.records, log_generator_t::get_log_type(options.params.log_format), bench_dir.c_str());
+
+   start = std::chrono::steady_clock::now();
+
+   if((log_size = log_generator_t(options.params).write_log(log_path.c_str())) == -1 || !write_config(bench_dir + "/webalizer.conf", bench_dir, options)) {
+      fprintf(stderr, "Cannot write benchmark files in %s\n", bench_dir.c_str());
+      retcode = EXIT_FAILURE;
+   }
+   else {
+      gen_secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+      printf("Generated %.1f MB in %.2f seconds\n\n", log_size / 1048576., gen_secs);
+      fflush(stdout);
+
+      start = std::chrono::steady_clock::now();
+
+      retcode = run_webalizer(options, bench_dir, log_path, usage);
+
+      run_secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+      if(retcode != EXIT_SUCCESS)
+         fprintf(stderr, "webalizer failed with the exit code %d\n", retcode);
+      else {
+         printf("\n");
+         printf("Records:     %" PRIu64 "\n", options.params.records);
+         printf("Run time:    %.3f seconds\n", run_secs);
+         printf("Throughput:  %.0f records/sec, %.1f MB/sec\n", options.params.records / run_secs, log_size / 1048576. / run_secs);
+         printf("CPU time:    %.3f user, %.3f system seconds\n", usage.ru_utime.tv_sec + usage.ru_utime.tv_usec / 1000000., usage.ru_stime.tv_sec + usage.ru_stime.tv_usec / 1000000.);
+         printf("Peak RSS:    %.1f MB\n", usage.ru_maxrss / 1024.);
+
+         if(options.keep)
+            printf("Profile:     %s/profile.json\n", bench_dir.c_str());
+      }
+   }
+
+   if(!options.keep) {
+      if(nftw(bench_dir.c_str(), remove_path_cb, 16, FTW_DEPTH | FTW_PHYS))
+         fprintf(stderr, "Cannot remove the benchmark directory %s\n", bench_dir.c_str());
+   }
+
+   return retcode == EXIT_SUCCESS ? EXIT_SUCCESS : EXIT_FAILURE;
+}
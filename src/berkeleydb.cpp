@@ -34,13 +34,13 @@
 //
 // -----------------------------------------------------------------------
 
-berkeleydb_t::cursor_iterator_base::cursor_iterator_base(Db *db) 
+berkeleydb_t::cursor_iterator_base::cursor_iterator_base(Db *db, DbTxn *txn) 
 {
    cursor = nullptr;
    error = 0;
 
    if(db) {
-      if((error = db->cursor(nullptr, &cursor, 0)) != 0)
+      if((error = db->cursor(txn, &cursor, 0)) != 0)
          cursor = nullptr;
    }
 }
@@ -121,19 +121,112 @@ bool berkeleydb_t::cursor_reverse_iterator::prev(Dbt& key, Dbt& data, Dbt *pkey)
    return (!error) ? true : false;
 }
 
+// -----------------------------------------------------------------------
+//
+// berkeleydb_t::transaction_t
+//
+// -----------------------------------------------------------------------
+
+berkeleydb_t::transaction_t::transaction_t(DbEnv& dbenv, size_t max_writes) :
+      dbenv(&dbenv),
+      txn(nullptr),
+      writes(0),
+      max_writes(max_writes),
+      atomic(false)
+{
+}
+
+int berkeleydb_t::transaction_t::begin(bool atomic)
+{
+   int error;
+
+   if(txn)
+      throw std::logic_error("A transaction cannot be started while another one is active");
+
+   if((error = dbenv->txn_begin(nullptr, &txn, 0)) != 0)
+      txn = nullptr;
+
+   writes = 0;
+
+   this->atomic = atomic;
+
+   return error;
+}
+
+///
+/// A committed `DbTxn` handle is freed by Berkeley DB and cannot be used afterwards,
+/// even if the commit failed.
+///
+int berkeleydb_t::transaction_t::commit(bool flush)
+{
+   int error;
+
+   if(!txn)
+      return 0;
+
+   error = txn->commit(0);
+
+   txn = nullptr;
+   writes = 0;
+
+   if(error)
+      return error;
+
+   // transactions are committed without writing the log, so flush it explicitly
+   if(flush)
+      return dbenv->log_flush(nullptr);
+
+   return 0;
+}
+
+int berkeleydb_t::transaction_t::abort(void)
+{
+   int error;
+
+   if(!txn)
+      return 0;
+
+   error = txn->abort();
+
+   txn = nullptr;
+   writes = 0;
+
+   return error;
+}
+
+///
+/// Once the current transaction reaches `max_writes` records, it is committed and a
+/// new transaction is started, so a single transaction doesn't hold more locks than
+/// the environment was configured for. Atomic transactions are never committed here.
+/// Returns zero if there is no active transaction.
+///
+int berkeleydb_t::transaction_t::add_write(void)
+{
+   int error;
+
+   if(!txn || atomic || ++writes < max_writes)
+      return 0;
+
+   if((error = commit(false)) != 0)
+      return error;
+
+   return begin(false);
+}
+
 // -----------------------------------------------------------------------
 //
 // berkeleydb_t::table_t
 //
 // -----------------------------------------------------------------------
 
-berkeleydb_t::table_t::table_t(const config_t& config, DbEnv& dbenv, Db& seqdb, buffer_allocator_t& buffer_allocator) :
+berkeleydb_t::table_t::table_t(const config_t& config, DbEnv& dbenv, Db& seqdb, buffer_allocator_t& buffer_allocator, transaction_t& transaction) :
       config(config),
       dbenv(&dbenv),
       table(new_db(&dbenv, DBFLAGS)),
       values(nullptr),
       seqdb(&seqdb),
       sequence(nullptr),
+      transaction(&transaction),
       buffer_allocator(&buffer_allocator),
       threaded(false)
 {
@@ -146,6 +239,7 @@ berkeleydb_t::table_t::table_t(table_t&& other) noexcept :
       values(other.values),
       seqdb(other.seqdb),
       sequence(other.sequence),
+      transaction(other.transaction),
       indexes(std::move(other.indexes)),
       buffer_allocator(other.buffer_allocator),
       threaded(other.threaded)
@@ -155,6 +249,7 @@ berkeleydb_t::table_t::table_t(table_t&& other) noexcept :
    other.values = nullptr;
    other.seqdb = nullptr;
    other.sequence = nullptr;
+   other.transaction = nullptr;
    other.buffer_allocator = nullptr;
 }
 
@@ -179,6 +274,7 @@ berkeleydb_t::table_t& berkeleydb_t::table_t::operator = (table_t&& other) noexc
    values = other.values;
    seqdb = other.seqdb;
    sequence = other.sequence;
+   transaction = other.transaction;
    buffer_allocator = other.buffer_allocator;
    indexes = std::move(other.indexes);
 
@@ -189,6 +285,7 @@ berkeleydb_t::table_t& berkeleydb_t::table_t::operator = (table_t&& other) noexc
    other.values = nullptr;
    other.seqdb = nullptr;
    other.sequence = nullptr;
+   other.transaction = nullptr;
    other.buffer_allocator = nullptr;
 
    return *this;
@@ -252,7 +349,7 @@ int berkeleydb_t::table_t::open(const char *dbname, bt_compare_cb_t btcb)
 {
    u_int index;
    int error;
-   u_int32_t flags = DB_CREATE;
+   u_int32_t flags = config.is_db_read_only() ? DB_RDONLY : DB_CREATE;
 
    if(threaded)
       flags |= DB_THREAD;
@@ -372,6 +469,66 @@ int berkeleydb_t::table_t::compact(u_int& bytes)
    return 0;
 }
 
+///
+/// Compacts the primary database, starting at the serialized primary key `key`, or at
+/// the beginning of the database if `key` is empty, and stops after `maxpages` pages
+/// have been freed. On return, `key` contains the key at which compaction stopped or
+/// is empty if the end of the database was reached.
+///
+/// Secondary databases are not compacted because their keys are not unique and cannot
+/// be used to continue compaction where it stopped.
+///
+int berkeleydb_t::table_t::compact(u_int32_t maxpages, string_t& key, u_int& bytes)
+{
+   DB_COMPACT c_data;
+   Dbt start, end;
+   int error;
+   u_int32_t pagesize;
+   buffer_holder_t buffer_holder(*buffer_allocator);
+   buffer_t& buffer = buffer_holder.buffer; 
+
+   bytes = 0;
+
+   if((error = table->get_pagesize(&pagesize)) != 0)
+      return error;
+
+   if(!key.isempty()) {
+      start.set_data(const_cast<char*>(key.c_str()));
+      start.set_size((u_int32_t) key.length());
+   }
+
+   if(buffer.capacity() < DBBUFSIZE)
+      buffer.resize(DBBUFSIZE, 0);
+
+   // the key at which compaction stops is returned in the buffer
+   end.set_data(buffer);
+   end.set_ulen((u_int32_t) DBBUFSIZE);
+   end.set_flags(DB_DBT_USERMEM);
+
+   memset(&c_data, 0, sizeof(c_data));
+
+   c_data.compact_pages = maxpages;
+
+   if((error = table->compact(nullptr, !key.isempty() ? &start : nullptr, nullptr, &c_data, DB_FREE_SPACE, &end)) != 0)
+      return error;
+
+   bytes = c_data.compact_pages_truncated * pagesize;
+
+   // serialized keys are binary and string_t::assign would drop a key starting with a zero byte
+   if(end.get_size()) {
+      string_t::char_buffer_t cb(end.get_size() + 1);
+
+      memcpy(cb.get_buffer(), end.get_data(), end.get_size());
+      cb[end.get_size()] = 0;
+
+      key.attach(std::move(cb), end.get_size());
+   }
+   else
+      key.reset();
+
+   return 0;
+}
+
 int berkeleydb_t::table_t::sync(void)
 {
    int error;
@@ -487,7 +644,7 @@ Db *berkeleydb_t::table_t::secondary_db(const char *dbname) const
 
 int berkeleydb_t::table_t::open_sequence(const char *colname, int32_t cachesize, db_seq_t ini_seq_id)
 {
-   u_int32_t flags = DB_CREATE;
+   u_int32_t flags = config.is_db_read_only() ? 0 : DB_CREATE;
    int error;
    Dbt key;
 
@@ -571,6 +728,10 @@ bool berkeleydb_t::table_t::delete_node(const keynode_t<uint64_t>& node)
    buffer_holder_t buffer_holder(*buffer_allocator);
    buffer_t& buffer = buffer_holder.buffer; 
 
+   // Berkeley DB would throw an exception for any write into a read-only database
+   if(config.is_db_read_only())
+      return false;
+
    if(buffer.capacity() < keysize)
       buffer.resize(keysize, 0);
 
@@ -580,7 +741,10 @@ bool berkeleydb_t::table_t::delete_node(const keynode_t<uint64_t>& node)
    key.set_data(buffer);
    key.set_size((u_int32_t) keysize);
 
-   if(table->del(nullptr, &key, 0))
+   if(table->del(transaction->get(), &key, 0))
+      return false;
+
+   if(transaction->add_write())
       return false;
 
    return true;
@@ -594,7 +758,8 @@ bool berkeleydb_t::table_t::delete_node(const keynode_t<uint64_t>& node)
 berkeleydb_t::berkeleydb_t(config_t&& config) :
       config(config.clone()),
       dbenv(DBENVFLAGS),
-      sequences(&dbenv, DBFLAGS)
+      sequences(&dbenv, DBFLAGS),
+      transaction(dbenv, TXN_MAX_WRITES)
 {
    // configure the environment to use the correct memory manager
    if(dbenv.set_alloc(berkeleydb_t::malloc, berkeleydb_t::realloc, berkeleydb_t::free))
@@ -604,6 +769,8 @@ berkeleydb_t::berkeleydb_t(config_t&& config) :
    trickle_thread_stop = false;
 
    trickle = false;
+
+   cache_size = 0;
 }
 
 berkeleydb_t::~berkeleydb_t()
@@ -647,6 +814,33 @@ void berkeleydb_t::reset_db_handles(void)
       tables[i]->init_db_handles();
 }
 
+///
+/// Berkeley DB refuses to run recovery in an environment that has any database handles
+/// created against it, which is always the case for `dbenv` because table handles are
+/// constructed along with their tables. Recovery is run in a separate environment that
+/// is closed as soon as the database is recovered.
+///
+berkeleydb_t::status_t berkeleydb_t::recover(u_int32_t envflags)
+{
+   DbEnv recenv(DBENVFLAGS);
+   status_t status;
+
+   if(!config.get_tmp_path().isempty()) {
+      if(!(status = recenv.set_tmp_dir(config.get_tmp_path())).success())
+         return status;
+   }
+
+   if(cache_size || config.get_db_cache_size()) {
+      if(!(status = recenv.set_cachesize(0, cache_size ? cache_size : config.get_db_cache_size(), 0)).success())
+         return status;
+   }
+
+   if(!(status = recenv.open(config.get_db_dir_ptr(), (envflags & ~(DB_THREAD | DB_INIT_CDB)) | DB_RECOVER, FILEMASK)).success())
+      return status;
+
+   return recenv.close(0);
+}
+
 void *berkeleydb_t::malloc(size_t size)
 {
    return ::malloc(size);
@@ -716,7 +910,7 @@ berkeleydb_t::status_t berkeleydb_t::open(std::initializer_list<table_t*> tblist
 ///
 berkeleydb_t::status_t berkeleydb_t::open(table_t * const tblist[], size_t tblcnt)
 {
-   u_int32_t dbflags = DB_CREATE;
+   u_int32_t dbflags = config.is_db_read_only() ? DB_RDONLY : DB_CREATE;
    u_int32_t envflags = DB_CREATE | DB_INIT_MPOOL | DB_PRIVATE;
    int major, minor, patch;
    status_t status;
@@ -732,9 +926,13 @@ berkeleydb_t::status_t berkeleydb_t::open(table_t * const tblist[], size_t tblcn
 
    // do some additional initialization for threaded environment
    if(!config.is_db_path_empty() && trickle) {
-      // initialize the environment and databases as thread-safe and with a single writer
+      // initialize the environment and databases as thread-safe
       dbflags |= DB_THREAD;
-      envflags |= DB_THREAD | DB_INIT_CDB;
+      envflags |= DB_THREAD;
+
+      // use a single writer, unless locking is initialized for transactions below
+      if(!is_transactional())
+         envflags |= DB_INIT_CDB;
 
       // initialize table databases as free-threaded
       for(size_t i = 0; i < tables.size(); i++)
@@ -747,10 +945,10 @@ berkeleydb_t::status_t berkeleydb_t::open(table_t * const tblist[], size_t tblcn
          return status;
    }
 
-   // if configured cache size is non-zero,
-   if(config.get_db_cache_size()) {
+   // if the cache size was set explicitly or configured as non-zero,
+   if(cache_size || config.get_db_cache_size()) {
       // set the maximum database cache size
-      if(!(status = dbenv.set_cachesize(0, config.get_db_cache_size(), 0)).success())
+      if(!(status = dbenv.set_cachesize(0, cache_size ? cache_size : config.get_db_cache_size(), 0)).success())
          return status;
    }
 
@@ -760,6 +958,48 @@ berkeleydb_t::status_t berkeleydb_t::open(table_t * const tblist[], size_t tblcn
          return status;
    }
 
+   //
+   // Berkeley DB maps database files opened read-only into memory, instead of reading
+   // their pages into the cache, if they are smaller than the mmap size, which is 10 MB
+   // by default. The environment is private and has no locking, so multiple processes
+   // may read the same database file this way.
+   //
+   if(config.is_db_read_only()) {
+      if(!(status = dbenv.set_mp_mmapsize(RDONLY_MMAP_SIZE)).success())
+         return status;
+   }
+
+   // set up a transactional environment
+   if(is_transactional()) {
+      envflags |= DB_INIT_TXN | DB_INIT_LOG | DB_INIT_LOCK;
+
+      //
+      // An atomic transaction holds a lock on every page it updated until it's committed,
+      // so the lock table must be large enough for all pages changed by the state saved
+      // at the end of a run, and the log buffer should fit many records between writes.
+      //
+      if(!(status = dbenv.set_lk_max_locks(TXN_MAX_LOCKS)).success())
+         return status;
+
+      if(!(status = dbenv.set_lk_max_objects(TXN_MAX_LOCKS)).success())
+         return status;
+
+      if(!(status = dbenv.set_lg_bsize(TXN_LOG_BSIZE)).success())
+         return status;
+
+      // don't write the log on each commit and commit updates outside of transactions automatically
+      if(!(status = dbenv.set_flags(DB_TXN_WRITE_NOSYNC | DB_AUTO_COMMIT, 1)).success())
+         return status;
+
+      // remove log files that are no longer needed for recovery
+      if(!(status = dbenv.log_set_config(DB_LOG_AUTO_REMOVE, 1)).success())
+         return status;
+
+      // recover the database, if it wasn't closed properly
+      if(!(status = recover(envflags)).success())
+         return status;
+   }
+
    // open the DB environment
    if(!(status = dbenv.open(config.get_db_dir_ptr(), envflags, FILEMASK)).success())
       return status;
@@ -794,6 +1034,13 @@ berkeleydb_t::status_t berkeleydb_t::close(void)
    if(!config.is_db_path_empty() && trickle)
       stop_trickle_thread();
 
+   // roll back any updates that weren't committed
+   if((error = transaction.abort()) != 0)
+      errcnt++;
+
+   if(errcnt == 1)
+      status = error;
+
    // close all table databases
    for(size_t i = 0; i < tables.size(); i++) {
       if((error = tables[i]->close()) != 0)
@@ -811,6 +1058,15 @@ berkeleydb_t::status_t berkeleydb_t::close(void)
    if(errcnt == 1)
       status = error;
 
+   // write a checkpoint, so the next recovery doesn't need to replay the log
+   if(is_transactional()) {
+      if((error = dbenv.txn_checkpoint(0, 0, 0)) != 0)
+         errcnt++;
+
+      if(errcnt == 1)
+         status = error;
+   }
+
    // finally, close the environment
    if((error = dbenv.close(0)) != 0)
       errcnt++;
@@ -854,6 +1110,47 @@ berkeleydb_t::status_t berkeleydb_t::compact(u_int& bytes)
    return status;
 }
 
+///
+/// Compacts primary databases in registered tables, one at a time, starting with the
+/// table at `tblidx` and the serialized primary key `key`. If the end of a table was
+/// reached before `maxpages` pages were freed, compaction continues in the next table,
+/// so the work done in a single call is bounded by `maxpages` freed pages per table.
+///
+/// On return, `tblidx` and `key` identify the position where the next call should
+/// continue and are expected to be stored by the caller between calls.
+///
+berkeleydb_t::status_t berkeleydb_t::compact(u_int32_t maxpages, u_int& tblidx, string_t& key, u_int& bytes)
+{
+   status_t status;
+   u_int tbytes;
+
+   bytes = 0;
+
+   if(tables.empty())
+      return status;
+
+   // start over if the position doesn't match registered tables
+   if(tblidx >= tables.size()) {
+      tblidx = 0;
+      key.clear();
+   }
+
+   for(size_t i = 0; i < tables.size(); i++) {
+      if(!(status = tables[tblidx]->compact(maxpages, key, tbytes)).success())
+         return status;
+
+      bytes += tbytes;
+
+      // stop if there's more to compact in this table
+      if(!key.isempty())
+         break;
+
+      tblidx = (tblidx + 1) % tables.size();
+   }
+
+   return status;
+}
+
 berkeleydb_t::status_t berkeleydb_t::flush(void)
 {
    status_t status;
@@ -869,6 +1166,78 @@ berkeleydb_t::status_t berkeleydb_t::flush(void)
    return status;
 }
 
+///
+/// Statistics are accumulated from the time the environment was opened. All tables are
+/// stored in a single database file, unless the environment is in memory, so there is
+/// typically only one entry in `filestats`.
+///
+berkeleydb_t::status_t berkeleydb_t::get_cache_stats(cache_stats_t& envstats, std::vector<cache_stats_t>& filestats)
+{
+   DB_MPOOL_STAT *gsp = nullptr;
+   DB_MPOOL_FSTAT **fsp = nullptr;
+   status_t status;
+
+   filestats.clear();
+
+   if(!(status = dbenv.memp_stat(&gsp, &fsp, 0)).success())
+      return status;
+
+   envstats.file_name.reset();
+   envstats.pagesize = 0;
+   envstats.hits = gsp->st_cache_hit;
+   envstats.misses = gsp->st_cache_miss;
+   envstats.pages_created = gsp->st_page_create;
+   envstats.pages_in = gsp->st_page_in;
+   envstats.pages_out = gsp->st_page_out;
+   envstats.evictions = gsp->st_ro_evict + gsp->st_rw_evict;
+
+   // the file statistics array is terminated with a null pointer
+   for(DB_MPOOL_FSTAT **fstat = fsp; fstat && *fstat; fstat++) {
+      cache_stats_t stats;
+
+      if((*fstat)->file_name)
+         stats.file_name = (*fstat)->file_name;
+
+      stats.pagesize = (*fstat)->st_pagesize;
+      stats.hits = (*fstat)->st_cache_hit;
+      stats.misses = (*fstat)->st_cache_miss;
+      stats.pages_created = (*fstat)->st_page_create;
+      stats.pages_in = (*fstat)->st_page_in;
+      stats.pages_out = (*fstat)->st_page_out;
+
+      filestats.push_back(std::move(stats));
+   }
+
+   // each of the structures is allocated in a single block with the environment allocator
+   free(gsp);
+   free(fsp);
+
+   return status;
+}
+
+///
+/// If transactions are not enabled, this method does nothing and all updates are made
+/// outside of transactions.
+///
+berkeleydb_t::status_t berkeleydb_t::begin_transaction(bool atomic)
+{
+   if(!is_transactional())
+      return status_t();
+
+   return transaction.begin(atomic);
+}
+
+///
+/// All transactions started since `begin_transaction` was called are committed without
+/// writing the log and the log is flushed once, which makes all updates durable with a
+/// single log write. If the process terminates before an atomic transaction is committed,
+/// recovery restores the database to the state it was in when the transaction began.
+///
+berkeleydb_t::status_t berkeleydb_t::commit_transaction(void)
+{
+   return transaction.commit(true);
+}
+
 void berkeleydb_t::stop_trickle_thread(void)
 {
    // make sure the trickle thread is or was running
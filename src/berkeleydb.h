@@ -30,6 +30,7 @@
 /// Unit test classes that need access to private members.
 namespace sswtest {
    class BerkeleyDBTest;
+   class BerkeleyDBFileTest;
 }
 
 ///
@@ -42,6 +43,7 @@ namespace sswtest {
 /// 
 class berkeleydb_t {
    friend class sswtest::BerkeleyDBTest;
+   friend class sswtest::BerkeleyDBFileTest;
 
    private:
       static const size_t        DBBUFSIZE = 32768;
@@ -51,6 +53,13 @@ class berkeleydb_t {
 
       static const int           FILEMASK = 0664;        ///< Database file access mask (rw-rw-r--).
 
+      static const size_t        TXN_MAX_WRITES = 5000;  ///< Maximum number of records written in one transaction.
+      static const u_int32_t     TXN_MAX_LOCKS = 1000000;   ///< Maximum number of locks and locked objects in a transactional environment.
+      static const u_int32_t     TXN_LOG_BSIZE = 4194304;   ///< Transaction log buffer size (4 MB).
+
+      /// Read-only database files up to this size are mapped into memory instead of being read into the cache.
+      static const size_t        RDONLY_MMAP_SIZE = (size_t) (sizeof(size_t) > 4 ? UINT64_C(64) * 1024 * 1024 * 1024 : UINT64_C(1024) * 1024 * 1024);
+
    protected:
       //
       // Define BDB callback types (bt_compare_fcn_type, etc are deprecated)
@@ -98,6 +107,16 @@ class berkeleydb_t {
       template <typename node_t> class iterator; 
       template <typename node_t> class reverse_iterator;
 
+      ///
+      /// @brief  A record filter callback type
+      ///
+      /// Iterators call a record filter with the serialized node data before the node
+      /// is unpacked. If the filter returns `false`, the record is skipped without being
+      /// unpacked, which allows reports to reject hidden items by looking at just a few
+      /// fields in the record buffer.
+      ///
+      typedef bool (*rec_filter_cb_t)(const void *data, size_t datasize, void *arg);
+
       ///
       /// @brief  Combines a Berkeley DB error and an application error message in one
       ///         class that is returned from `berkeleydb_t` methods.
@@ -186,6 +205,29 @@ class berkeleydb_t {
             }
       };
 
+      ///
+      /// @brief  Memory pool statistics for the environment or for one database file
+      ///
+      /// Eviction counts are only maintained for the entire environment and are always
+      /// zero for individual database files.
+      ///
+      struct cache_stats_t {
+         string_t    file_name;        ///< Database file name (empty for the environment or in-memory databases).
+         uint32_t    pagesize;         ///< Page size, in bytes (zero for the environment).
+         uint64_t    hits;             ///< Number of pages found in the cache.
+         uint64_t    misses;           ///< Number of pages not found in the cache.
+         uint64_t    pages_created;    ///< Number of pages created in the cache.
+         uint64_t    pages_in;         ///< Number of pages read into the cache.
+         uint64_t    pages_out;        ///< Number of pages written from the cache.
+         uint64_t    evictions;        ///< Number of clean and dirty pages evicted from the cache.
+
+         public:
+            cache_stats_t(void) : pagesize(0), hits(0), misses(0), pages_created(0), pages_in(0), pages_out(0), evictions(0) {}
+
+            /// Returns the percentage of pages found in the cache.
+            double hit_rate(void) const {return hits + misses ? hits * 100. / (hits + misses) : 0.;}
+      };
+
       ///
       /// @brief  Defines an interface for a configuration necessary to construct a
       ///         `berkeleydb_t` instance.
@@ -243,6 +285,15 @@ class berkeleydb_t {
 
             /// Indicates whether OS I/O buffering should be disabled (`true`) or not (`false`).
             virtual bool get_db_direct(void) const = 0;
+
+            /// Indicates whether database updates should be grouped into transactions (`true`) or not (`false`).
+            virtual bool get_db_txn(void) const = 0;
+
+            /// Indicates whether the database should be opened read-only (`true`) or not (`false`).
+            virtual bool get_db_read_only(void) const = 0;
+
+            /// Returns `true` if an existing database file should be opened read-only, `false` otherwise.
+            bool is_db_read_only(void) const {return !is_db_path_empty() && get_db_read_only();}
       };
 
    private:
@@ -261,7 +312,7 @@ class berkeleydb_t {
             cursor_iterator_base& operator = (const cursor_iterator_base&) = delete;
 
          public:
-            cursor_iterator_base(Db *db);
+            cursor_iterator_base(Db *db, DbTxn *txn);
             
             ~cursor_iterator_base(void);
 
@@ -280,7 +331,7 @@ class berkeleydb_t {
       ///
       class cursor_dup_iterator : public cursor_iterator_base {
          public:
-            cursor_dup_iterator(Db *db) : cursor_iterator_base(db) {}
+            cursor_dup_iterator(Db *db, DbTxn *txn) : cursor_iterator_base(db, txn) {}
 
             bool set(Dbt& key, Dbt& data, Dbt *pkey);
 
@@ -292,7 +343,7 @@ class berkeleydb_t {
       ///
       class cursor_iterator : public cursor_iterator_base {
          public:
-            cursor_iterator(Db *db) : cursor_iterator_base(db) {}
+            cursor_iterator(Db *db, DbTxn *txn) : cursor_iterator_base(db, txn) {}
 
             bool next(Dbt& key, Dbt& data, Dbt *pkey);
       };
@@ -302,11 +353,59 @@ class berkeleydb_t {
       ///
       class cursor_reverse_iterator : public cursor_iterator_base {
          public:
-            cursor_reverse_iterator(Db *db) : cursor_iterator_base(db) {}
+            cursor_reverse_iterator(Db *db, DbTxn *txn) : cursor_iterator_base(db, txn) {}
 
             bool prev(Dbt& key, Dbt& data, Dbt *pkey);
       };
 
+      ///
+      /// @brief  A transaction shared by all tables in a transactional environment
+      ///
+      /// Updates made between `begin` and `commit` are grouped into a few large
+      /// transactions, each of which is committed after `max_writes` records have
+      /// been written or deleted, unless the transaction was started as atomic,
+      /// in which case all updates are committed in a single transaction, however
+      /// many there are. Transactions are committed without flushing the log, which
+      /// is flushed once, after the last transaction in the group has been committed.
+      ///
+      /// If there is no active transaction, `get` returns `nullptr` and database
+      /// calls are not transaction-protected or are committed automatically, in
+      /// a transactional environment.
+      ///
+      class transaction_t {
+         private:
+            DbEnv       *dbenv;        ///< Shared DB environment.
+
+            DbTxn       *txn;          ///< Current transaction or `nullptr`.
+
+            size_t      writes;        ///< Number of records written in the current transaction.
+
+            size_t      max_writes;    ///< Maximum number of records written in one transaction.
+
+            bool        atomic;        ///< Indicates whether the current transaction must be committed as a whole.
+
+         public:
+            transaction_t(DbEnv& dbenv, size_t max_writes);
+
+            /// Returns the current transaction or `nullptr` if there isn't one.
+            DbTxn *get(void) const {return txn;}
+
+            /// Returns `true` if there is an active transaction.
+            bool is_active(void) const {return txn != nullptr;}
+
+            /// Begins a new transaction, which is never committed in parts if `atomic` is `true`.
+            int begin(bool atomic);
+
+            /// Commits the current transaction and optionally flushes the log.
+            int commit(bool flush);
+
+            /// Aborts the current transaction, if there is one.
+            int abort(void);
+
+            /// Counts a record write and commits and restarts a full transaction.
+            int add_write(void);
+      };
+
    protected:
       ///
       /// @brief  A table object stores data along with accompanying indexes
@@ -391,6 +490,8 @@ class berkeleydb_t {
 
             DbSequence           *sequence;  // source of primary keys
 
+            transaction_t        *transaction;  // shared transaction
+
             std::vector<db_desc_t> indexes;  // secondary databases
 
             bool                 threaded;
@@ -402,7 +503,7 @@ class berkeleydb_t {
             db_desc_t *get_sc_desc(const char *dbname);
 
          public:
-            table_t(const config_t& config, DbEnv& env, Db& seqdb, buffer_allocator_t& buffer_allocator);
+            table_t(const config_t& config, DbEnv& env, Db& seqdb, buffer_allocator_t& buffer_allocator, transaction_t& transaction);
 
             table_t(table_t&& other) noexcept;
 
@@ -436,6 +537,9 @@ class berkeleydb_t {
             /// rearranges data pages on disk to minimize unused space
             int compact(u_int& bytes);
 
+            /// rearranges primary database pages, starting at `key`, until `maxpages` pages are freed
+            int compact(u_int32_t maxpages, string_t& key, u_int& bytes);
+
             /// flushes dirty data pages to disk
             int sync(void);
 
@@ -454,6 +558,9 @@ class berkeleydb_t {
 
             Db *values_db(void) const {return values;}
 
+            /// Returns the current shared transaction or `nullptr` if there isn't one.
+            DbTxn *current_txn(void) const {return transaction->get();}
+
             /// opens a sequence within a sequence database
             int open_sequence(const char *colname, int32_t cachesize, db_seq_t ini_seq_id = 1);
 
@@ -466,7 +573,7 @@ class berkeleydb_t {
             /// Returns the number of unique keys in the primary or a named secondary database.
             uint64_t count(const char *dbname = nullptr) const;
 
-            /// inserts a new node or updates the existing node in the primary database
+            /// inserts a new node or updates the existing node in the primary database (fails if the database is read-only)
             template <typename node_t>
             bool put_node(const node_t& unode, storage_info_t& storage_info);
 
@@ -474,7 +581,7 @@ class berkeleydb_t {
             template <typename node_t, typename ... param_t>
             bool get_node_by_id(storable_t<node_t>& node, typename node_t::template s_unpack_cb_t<param_t ...> upcb = nullptr, param_t ... param) const;
 
-            /// deletes a node by its key
+            /// deletes a node by its key (fails if the database is read-only)
             bool delete_node(const keynode_t<uint64_t>& node);
 
             /// retrieves a node by its value
@@ -507,9 +614,14 @@ class berkeleydb_t {
 
             buffer_allocator_t      *buffer_allocator;
 
+            rec_filter_cb_t         filter;        // optional record filter
+            void                    *filter_arg;   // record filter argument
+
          protected:
             Dbt& set_dbt_buffer(Dbt& dbt, void *buffer, size_t size) const;
 
+            bool is_filtered(const Dbt& data) const {return filter && !filter(data.get_data(), data.get_size(), filter_arg);}
+
          public:
             iterator_base(buffer_allocator_t& buffer_allocator, cursor_iterator_base& cursor);
 
@@ -521,6 +633,7 @@ class berkeleydb_t {
 
             int get_error(void) const {return cursor.get_error();}
 
+            void set_filter(rec_filter_cb_t filter, void *arg) {this->filter = filter; filter_arg = arg;}
       };
 
       ///
@@ -534,6 +647,7 @@ class berkeleydb_t {
          private:
             using iterator_base<node_t>::set_dbt_buffer;
             using iterator_base<node_t>::buffer_allocator;
+            using iterator_base<node_t>::is_filtered;
 
             cursor_iterator         cursor;
 
@@ -561,6 +675,7 @@ class berkeleydb_t {
          private:
             using iterator_base<node_t>::set_dbt_buffer;
             using iterator_base<node_t>::buffer_allocator;
+            using iterator_base<node_t>::is_filtered;
 
             cursor_reverse_iterator cursor;
 
@@ -580,6 +695,10 @@ class berkeleydb_t {
    private:
       void reset_db_handles(void);
 
+      status_t recover(u_int32_t envflags);
+
+      bool is_transactional(void) const {return !config.is_db_path_empty() && config.get_db_txn() && !config.get_db_read_only();}
+
       void trickle_thread_proc(void);
 
       void stop_trickle_thread(void);
@@ -617,6 +736,8 @@ class berkeleydb_t {
       DbEnv             dbenv;
       Db                sequences;
 
+      transaction_t     transaction;
+
       buffer_stack_t    buffer_stack;
 
       std::vector<table_t*> tables;
@@ -629,8 +750,10 @@ class berkeleydb_t {
 
       bool              trickle;
 
+      uint32_t          cache_size;
+
    protected:
-      table_t make_table(void) {return table_t(config, dbenv, sequences, buffer_stack);}
+      table_t make_table(void) {return table_t(config, dbenv, sequences, buffer_stack, transaction);}
 
    public:
       berkeleydb_t(config_t&& config);
@@ -640,6 +763,9 @@ class berkeleydb_t {
       /// if trickle is enabled, dirty pages will be trickled to disk by a background thread
       void set_trickle(bool value) {trickle = value;}
 
+      /// overrides the configured cache size for subsequent `open` calls, unless it is zero
+      void set_cache_size(uint32_t value) {cache_size = value;}
+
       /// A convenience method that calls `berkeleydb_t::open` with a table array.
       status_t open(std::initializer_list<table_t*> tblist);
 
@@ -657,6 +783,18 @@ class berkeleydb_t {
 
       /// rearranges data pages on disk to minimize unused space
       status_t compact(u_int& bytes);
+
+      /// rearranges some of the data pages, starting where the previous call stopped
+      status_t compact(u_int32_t maxpages, u_int& tblidx, string_t& key, u_int& bytes);
+
+      /// collects memory pool statistics for the environment and for each database file
+      status_t get_cache_stats(cache_stats_t& envstats, std::vector<cache_stats_t>& filestats);
+
+      /// begins a group of transactions, or a single one if `atomic` is `true`, for subsequent updates, if transactions are enabled
+      status_t begin_transaction(bool atomic);
+
+      /// commits all outstanding updates and flushes the transaction log
+      status_t commit_transaction(void);
 };
 
 ///
@@ -85,7 +85,9 @@ int sc_extract_cb(Db *secondary, const Dbt *key, const Dbt *data, Dbt *result)
 template <typename node_t>
 berkeleydb_t::iterator_base<node_t>::iterator_base(buffer_allocator_t& buffer_allocator, cursor_iterator_base& cursor) : 
       buffer_allocator(&buffer_allocator), 
-      cursor(cursor)
+      cursor(cursor),
+      filter(nullptr),
+      filter_arg(nullptr)
 {
 }
 
@@ -113,7 +115,7 @@ Dbt& berkeleydb_t::iterator_base<node_t>::set_dbt_buffer(Dbt& dbt, void *buffer,
 template <typename node_t>
 berkeleydb_t::iterator<node_t>::iterator(buffer_allocator_t& buffer_allocator, const table_t& table, const char *dbname) : 
       iterator_base<node_t>(buffer_allocator, cursor),
-      cursor(dbname ? table.secondary_db(dbname) : table.primary_db())
+      cursor(dbname ? table.secondary_db(dbname) : table.primary_db(), table.current_txn())
 {
    primdb = (dbname == nullptr);
 }
@@ -136,8 +138,11 @@ bool berkeleydb_t::iterator<node_t>::next(storable_t<node_t>& node, typename nod
    if(!primdb)
       set_dbt_buffer(pkey, buffer + DBBUFSIZE*2, DBBUFSIZE);
 
-   if(!cursor.next(key, data, primdb ? nullptr : &pkey))
-      return false;
+   // skip records rejected by the filter without unpacking them
+   do {
+      if(!cursor.next(key, data, primdb ? nullptr : &pkey))
+         return false;
+   } while(is_filtered(data));
 
    if(primdb) {
       if(node.s_unpack_key(key.get_data(), key.get_size()) != key.get_size())
@@ -165,7 +170,7 @@ bool berkeleydb_t::iterator<node_t>::next(storable_t<node_t>& node, typename nod
 template <typename node_t>
 berkeleydb_t::reverse_iterator<node_t>::reverse_iterator(buffer_allocator_t& buffer_allocator, const table_t& table, const char *dbname) : 
       iterator_base<node_t>(buffer_allocator, cursor), 
-      cursor(dbname ? table.secondary_db(dbname) : table.primary_db())
+      cursor(dbname ? table.secondary_db(dbname) : table.primary_db(), table.current_txn())
 {
    primdb = (dbname == nullptr);
 }
@@ -188,8 +193,11 @@ bool berkeleydb_t::reverse_iterator<node_t>::prev(storable_t<node_t>& node, type
    if(!primdb)
       set_dbt_buffer(pkey, buffer + DBBUFSIZE*2, DBBUFSIZE);
 
-   if(!cursor.prev(key, data, primdb ? nullptr : &pkey))
-      return false;
+   // skip records rejected by the filter without unpacking them
+   do {
+      if(!cursor.prev(key, data, primdb ? nullptr : &pkey))
+         return false;
+   } while(is_filtered(data));
 
    if(primdb) {
       if(node.s_unpack_key(key.get_data(), key.get_size()) != key.get_size())
@@ -222,6 +230,10 @@ bool berkeleydb_t::table_t::put_node(const node_t& node, storage_info_t& storage
    buffer_holder_t buffer_holder(*buffer_allocator);
    buffer_t& buffer = buffer_holder.buffer; 
 
+   // Berkeley DB would throw an exception for any write into a read-only database
+   if(config.is_db_read_only())
+      return false;
+
    if(buffer.capacity() < keysize+datasize)
       buffer.resize(keysize+datasize, 0);
 
@@ -237,7 +249,11 @@ bool berkeleydb_t::table_t::put_node(const node_t& node, storage_info_t& storage
    data.set_data(buffer+keysize);
    data.set_size((u_int32_t) datasize);
 
-   if(table->put(nullptr, &key, &data, 0)) 
+   if(table->put(transaction->get(), &key, &data, 0)) 
+      return false;
+
+   // commit the current transaction if it has grown large enough
+   if(transaction->add_write())
       return false;
 
    // indicate that the node came from the database
@@ -269,7 +285,7 @@ bool berkeleydb_t::table_t::get_node_by_id(storable_t<node_t>& node, typename no
    data.set_ulen((u_int32_t) (DBBUFSIZE-keysize));
    data.set_flags(DB_DBT_USERMEM);
 
-   if(table->get(nullptr, &key, &data, 0))
+   if(table->get(transaction->get(), &key, &data, 0))
       return false;
 
    if(node.template s_unpack_data<param_t...>(data.get_data(), data.get_size(), upcb, std::forward<param_t>(param) ...) != data.get_size())
@@ -312,7 +328,7 @@ bool berkeleydb_t::table_t::get_node_by_value(storable_t<node_t>& node, typename
    data.set_flags(DB_DBT_USERMEM);
 
    // open a cursor
-   {cursor_dup_iterator cursor(values);
+   {cursor_dup_iterator cursor(values, transaction->get());
 
    // find the first value hash and get the primary key and value data
    if(!cursor.set(key, data, &pkey))
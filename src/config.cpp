@@ -86,6 +86,8 @@ config_t::config_t(void)
 
    pipe_log_names  = false;
 
+   db_read_only = false;
+
    //
    // public values
    //
@@ -98,6 +100,7 @@ config_t::config_t(void)
    font_anti_aliasing = true;
    graph_true_color = false;
    sort_srch_args = true;
+   srch_host_match = false;
    ignore_referrer_partial = true;
    local_time = true;                         // true=localtime false=GMT (UTC)
    enable_js = false;
@@ -145,6 +148,13 @@ config_t::config_t(void)
    db_cache_size = DB_DEF_CACHE_SIZE;
    db_seq_cache_size = 100;
    db_direct = false;
+   state_snapshot = false;
+   db_txn = false;
+   db_compact_pages = 0;
+   db_cache_auto = false;
+   log_reader_thread = false;
+   month_report_thread = false;
+   profile = false;
 
    http_port = DEF_HTTP_PORT;                 // HTTP port number
    https_port = DEF_HTTPS_PORT;               // HTTPS port number
@@ -196,6 +206,8 @@ config_t::config_t(void)
 
    rpt_title = lang.msg_title;
    hist_fname = "webalizer.hist";             /* name of history file     */
+   ts_fname.reset();                          // no time series file
+   profile_fname.reset();                     // no profile file
    html_ext = "html";                         /* HTML file prefix         */
    dump_ext = "tab";                          /* Dump file prefix         */
    db_fname = "webalizer";                    // database file name
@@ -458,6 +470,12 @@ void config_t::prep_and_validate(void)
       batch = false;
    }
 
+   // only reports and database information may be produced from a read-only database
+   if(db_read_only && !prep_report && !db_info) {
+      messages.push_back(string_t("WARNING: A read-only database may only be used with --prepare-report or --db-info"));
+      db_read_only = false;
+   }
+
    //
    // LOG_IIS is being set if none other log types match, even if an invalid
    // option value is used. Check here that the option value begins with 'i'
@@ -638,6 +656,9 @@ void config_t::prep_and_validate(void)
          page_type.add_nlist(html_ext);
    }
 
+   // index page title patterns, so report generators don't have to scan the list for each URL
+   page_title_index.build(page_titles);
+
    // if there is no GeoIP database configured, don't output country or city information
    if(geoip_db_path.isempty()) {
       ntop_ctrys = 0;
@@ -745,12 +766,15 @@ void config_t::get_config(const char *fname)
                      {"CountryGraph",        54},           // Display ctry graph (0=no)
                      {"DailyGraph",          86},           // Daily Graph (0=no)
                      {"DailyStats",          87},           // Daily Stats (0=no)
+                     {"DbCacheAutoSize",     200},          // Size the database cache for the measured working set?
                      {"DbCacheSize",         146},          // State database cache size
+                     {"DbCompactPages",      199},          // Pages freed per table in incremental compaction
                      {"DbDirect",            153},          // Use OS buffering?
                      {"DbExt",               148},          // State database file extension
                      {"DbName",              145},          // State database file name
                      {"DbPath",              144},          // State database path
                      {"DbSeqCacheSize",      149},          // Database sequence cache size
+                     {"DbTransactions",      198},          // Group database updates into transactions?
                      {"Debug",               8},            // Produce debug information
                      {"DecimalKBytes",       172},          // Use 1000, not 1024 as a transfer multiplier
                      {"DNSCache",            84},           // DNS Cache file name
@@ -876,6 +900,7 @@ void config_t::get_config(const char *fname)
                      {"LocalUTCOffset",      188},          // Do not use local UTC offset?
                      {"LogDir",              183},          // Log directory
                      {"LogFile",             2},            // Log file to use for input
+                     {"LogReaderThread",     201},          // Read and parse log files in a separate thread?
                      {"LogType",             60},           // Log Type (clf/ftp/squid/iis)
                      {"MangleAgents",        24},           // Mangle User Agents
                      {"MaxAgents",           176},          // Maximum User Agents
@@ -891,6 +916,7 @@ void config_t::get_config(const char *fname)
                      {"MaxVisitLength",      187},          // Maximum visit length
                      {"MinVisitLength",      196},          // Minimum visit length for human visitors
                      {"MonthlyTotals",       127},          // Output monthly totals report?
+                     {"MonthReportThread",   206},          // Generate the report for a closed month in a separate thread?
                      {"NginxLogFormat",      195},          // Nginx log file format
                      {"NoDefaultIndexAlias", 92},           // Ignore default index alias?
                      {"OutputDir",           1},            // Output directory
@@ -898,18 +924,23 @@ void config_t::get_config(const char *fname)
                      {"PageEntryURL",        170},          // Show only pages in the entry report?
                      {"PageTitle",           194},          // URL patterns and matching page titles.
                      {"PageType",            49},           // Page Type (pageview)
+                     {"Profile",             203},          // Print processing stage times and counters
+                     {"ProfileName",         204},          // Filename for JSON profile data
                      {"Quiet",               6},            // Run in quiet mode
                      {"ReallyQuiet",         29},           // Dont display ANY messages
                      {"ReportTitle",         3},            // Title for reports
                      {"Robot",               155},          // Robot user agent filter
                      {"SearchEngine",        61},           // SearchEngine strings
+                     {"SearchEngineHostMatch",205},         // Match search engines by referrer host name?
                      {"SiteAlias",           185},          // One or more site aliases
                      {"SiteName",            4},            // Synonym for HostName
                      {"SortSearchArgs",      107},          // Sort search arguments ?
                      {"SpamReferrer",        142},          // Spam referrer
+                     {"StateSnapshot",       197},          // Write a state snapshot file?
                      {"TargetDownloads",     169},          // Treat download URLs as targets?
                      {"TargetURL",           168},          // Target URL pattern
                      {"TimeMe",              7},            // Produce timing results
+                     {"TimeSeriesName",      202},          // Filename for hourly time series data
                      {"TopAgents",           14},           // Top User Agents
                      {"TopASN",              192},          // Top ASN entries
                      {"TopCities",           147},          // Top Cities
@@ -1201,6 +1232,16 @@ void config_t::get_config(const char *fname)
          case 194: page_titles.add_glist(value); break;
          case 195: nginx_log_format = value; break;
          case 196: min_visit_length = get_interval(value, errors); break;
+         case 197: state_snapshot = (string_t::tolower(value[0]) == 'y'); break;
+         case 198: db_txn = (string_t::tolower(value[0]) == 'y'); break;
+         case 199: db_compact_pages = (uint32_t) atoi(value); break;
+         case 200: db_cache_auto = (string_t::tolower(value[0]) == 'y'); break;
+         case 201: log_reader_thread = (string_t::tolower(value[0]) == 'y'); break;
+         case 202: ts_fname = value; break;
+         case 203: profile = (string_t::tolower(value[0]) == 'y'); break;
+         case 204: profile_fname = value; break;
+         case 205: srch_host_match = (string_t::tolower(value[0]) == 'y'); break;
+         case 206: month_report_thread = (string_t::tolower(value[0]) == 'y'); break;
       }
    }
 
@@ -1363,6 +1404,16 @@ bool config_t::is_secure_url(u_char urltype) const
    return urltype == URL_TYPE_HTTPS || (use_https && (urltype & URL_TYPE_HTTPS || urltype == URL_TYPE_UNKNOWN));
 }
 
+///
+/// Host name matching must be requested with `SearchEngineHostMatch` because patterns
+/// that consist of host name characters, such as `excite`, may be intended to match URL
+/// paths. Patterns with wildcards or other characters always need the entire URL.
+///
+bool config_t::is_srch_host_match(void) const
+{
+   return srch_host_match && search_list.is_host_list();
+}
+
 ///
 /// @brief  Evaluates command line arguments and sets corresponding configuration 
 ///         vaues.
@@ -1441,6 +1492,8 @@ void config_t::proc_cmd_line(int argc, const char * const argv[])
             db_info = true;
          else if(!string_t::compare_ci(nptr, "pipe-log-names", nlen))
             pipe_log_names  = true;
+         else if(!string_t::compare_ci(nptr, "read-only", nlen))
+            db_read_only = true;
          else
             messages.push_back(string_t::_format("WARNING: Unknown option --%s\n", string_t(nptr, nlen).c_str()));
 
@@ -1582,6 +1635,29 @@ string_t config_t::get_db_name(void) const
    return (is_default_db() ? db_fname : report_db_name) + '.' + db_fname_ext;
 }
 
+string_t config_t::get_snapshot_path(void) const
+{
+   return get_db_path() + ".snapshot";
+}
+
+///
+/// The cache is sized 25% larger than the working set to leave some room for growth
+/// between runs, but is never set smaller than `DB_MIN_CACHE_SIZE` or larger than four
+/// times the configured cache size.
+///
+uint32_t config_t::get_auto_db_cache_size(uint64_t wset) const
+{
+   uint64_t cachesize = wset + wset / 4;
+
+   if(cachesize < DB_MIN_CACHE_SIZE)
+      return DB_MIN_CACHE_SIZE;
+
+   if(cachesize > (uint64_t) db_cache_size * 4)
+      cachesize = (uint64_t) db_cache_size * 4;
+
+   return cachesize > UINT32_MAX ? UINT32_MAX : (uint32_t) cachesize;
+}
+
 ///
 /// @brief  Splits the path to the DNS database onto the file name and the directory
 ///         path and stores them in the configuration.
@@ -90,6 +90,8 @@ class config_t {
       bool batch;                               ///< batch processing (no report generated)
       
       bool pipe_log_names ;                     ///< Read log file names from stdin?
+
+      bool db_read_only;                        ///< Open the state database read-only (--prepare-report and --db-info only)?
       bool last_log;                            ///< End month after this log file?
 
       bool conv_url_lower_case;                 ///< Convert URL to lower case (including query)
@@ -101,6 +103,7 @@ class config_t {
       bool font_anti_aliasing;                  ///< Use True Type font antialiasing (PNG only)?
       bool graph_true_color;                    ///< Initialize PNG graphing engine sing True Color?
       bool sort_srch_args;                      ///< Sort search arguments by name?
+      bool srch_host_match;                     ///< Match search engine patterns against referrer host names only?
       bool ignore_referrer_partial;             ///< Ignore referrer of partial content HTTP responses (code 206)?
       bool local_time;                          ///< Use local time for reports?
       bool ignore_hist;                         ///< Ignore history file when restoring incremental state?
@@ -200,6 +203,13 @@ class config_t {
       uint32_t db_cache_size;                   ///< Database cache size, in bytes.
       uint32_t db_seq_cache_size;               ///< Database sequence cache size, in elements.
       bool db_direct;                           ///< use system buffering?
+      bool state_snapshot;                      ///< Write a state snapshot file for incremental runs?
+      bool db_txn;                              ///< Group database updates into transactions?
+      uint32_t db_compact_pages;                ///< Maximum number of pages freed per table in incremental compaction (zero if disabled).
+      bool db_cache_auto;                       ///< Size the database cache for the working set measured in the last run?
+      bool log_reader_thread;                   ///< Read and parse log records in a separate thread?
+      bool month_report_thread;                 ///< Generate the report for a closed month in a separate thread?
+      bool profile;                             ///< Print processing stage times and counters at the end of the run?
 
       u_int visit_timeout;                      ///< visit timeout, in seconds (30 min)   
       u_int max_visit_length;                   ///< maximum visit length, in seconds
@@ -232,6 +242,8 @@ class config_t {
 
       string_t hname;                           ///< Host name for reports     
       string_t hist_fname;                      ///< Name of history file     
+      string_t ts_fname;                        ///< Name of the hourly time series file (empty if disabled)
+      string_t profile_fname;                   ///< Name of the JSON profile file (empty if disabled)
       string_t html_ext;                        ///< HTML file prefix         
       string_t dump_ext;                        ///< Dump file prefix         
       string_t out_dir;                         ///< Output directory         
@@ -333,6 +345,7 @@ class config_t {
       nlist site_aliases;                       ///< Web site domain name aliases
 
       glist page_titles;                        ///< URL patterns and matching page titles.
+      glist_index_t page_title_index;           ///< Page title patterns indexed for matching whole URLs.
 
       tm_ranges_t dst_ranges;                   ///< DST time ranges
       int dst_offset;                           ///< DST offset in minutes
@@ -391,12 +404,21 @@ class config_t {
       
       bool is_secure_url(u_char urltype) const;
 
+      /// Returns true if search engine patterns should be matched against referrer host names only.
+      bool is_srch_host_match(void) const;
+
       /// Concatenates all state database path and file components and returns the combined path.
       string_t get_db_path(void) const;
 
       /// Concatenates the current state database file name and extension and returns the combined database name.
       string_t get_db_name(void) const;
 
+      /// Returns the path of the state snapshot file for the current state database.
+      string_t get_snapshot_path(void) const;
+
+      /// Returns the database cache size for the specified working set, in bytes.
+      uint32_t get_auto_db_cache_size(uint64_t wset) const;
+
       bool is_default_db(void) const;
 
       void report_config(void) const;
@@ -44,6 +44,11 @@ system_database_t::system_database_t(const ::config_t& config) : berkeleydb_t(db
 {
 }
 
+system_database_t::system_database_t(const ::config_t& config, const string_t& db_name) : berkeleydb_t(db_config_t(config, db_name)),
+      system(make_table())
+{
+}
+
 system_database_t::~system_database_t(void)
 {
 }
@@ -273,7 +278,15 @@ const struct database_t::index_desc_t {
 //
 // -----------------------------------------------------------------------
 
-database_t::database_t(const ::config_t& config) : berkeleydb_t(db_config_t(config)),
+database_t::database_t(const ::config_t& config) : database_t(db_config_t(config))
+{
+}
+
+database_t::database_t(const ::config_t& config, const string_t& db_name) : database_t(db_config_t(config, db_name))
+{
+}
+
+database_t::database_t(db_config_t&& config) : berkeleydb_t(std::move(config)),
       system(make_table()),
       urls(make_table()),
       hosts(make_table()),
@@ -350,7 +363,7 @@ berkeleydb_t::status_t database_t::open(void)
    //
    for(size_t i = 0; i < sizeof(table_desc)/sizeof(table_desc[0]); i++) {
       // open the sequence database only if we intend to generate new record identifiers
-      if(table_desc[i].sequence_db) {
+      if(table_desc[i].sequence_db && !config.is_db_read_only()) {
          if(!(status = (this->*table_desc[i].table).open_sequence(table_desc[i].sequence_db, config.get_db_seq_cache_size())).success())
             return status;
       }
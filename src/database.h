@@ -19,6 +19,7 @@
 #include "event.h"
 #include "berkeleydb.h"
 #include "storable.h"
+#include "util_path.h"
 
 ///
 /// @brief  Translates application configuration into database configuration.
@@ -28,14 +29,25 @@ class db_config_t : public berkeleydb_t::config_t {
       const ::config_t& config;        /// Application configuration.
       string_t          db_path;       /// Full database path, including the file name.
       string_t          db_name;       /// Database full file name, including extension.
+      bool              db_txn;        /// Use transactions?
 
    public:
       db_config_t(const ::config_t& config) :
-            config(config), db_path(config.get_db_path()), db_name(config.get_db_name())
+            config(config), db_path(config.get_db_path()), db_name(config.get_db_name()), db_txn(config.db_txn)
       {
       }
 
-      const db_config_t& clone(void) const override {return *new db_config_t(config);}
+      ///
+      /// A database file named explicitly is opened without transactions, so its 
+      /// environment does not write log files that would conflict with those of 
+      /// the default database in the same directory.
+      ///
+      db_config_t(const ::config_t& config, const string_t& db_name) :
+            config(config), db_path(make_path(config.db_path, db_name)), db_name(db_name), db_txn(false)
+      {
+      }
+
+      const db_config_t& clone(void) const override {return *new db_config_t(*this);}
 
       void release(void) const override {delete this;}
 
@@ -52,6 +64,10 @@ class db_config_t : public berkeleydb_t::config_t {
       uint32_t get_db_seq_cache_size(void) const override {return config.db_seq_cache_size;}
 
       bool get_db_direct(void) const override {return config.db_direct;}
+
+      bool get_db_txn(void) const override {return db_txn;}
+
+      bool get_db_read_only(void) const override {return config.db_read_only;}
 };
 
 ///
@@ -68,6 +84,9 @@ class system_database_t : public berkeleydb_t {
    public:
       system_database_t(const ::config_t& config);
 
+      /// Opens the system table in the database file `db_name` in the database directory.
+      system_database_t(const ::config_t& config, const string_t& db_name);
+
       ~system_database_t(void);
 
       /// Opens the database with just the system table open.
@@ -111,9 +130,15 @@ class database_t : public berkeleydb_t {
       table_t           cities;
       table_t           asn;
 
+   private:
+      database_t(db_config_t&& config);
+
    public:
       database_t(const ::config_t& config);
 
+      /// Opens the database file `db_name` in the database directory.
+      database_t(const ::config_t& config, const string_t& db_name);
+
       ~database_t(void);
 
       status_t open(void);
@@ -310,5 +310,6 @@ template size_t dlnode_t::s_unpack_data(const void *buffer, size_t bufsize, dlno
 template size_t dlnode_t::s_unpack_data(const void *buffer, size_t bufsize, dlnode_t::s_unpack_cb_t<void*, const storable_t<hnode_t>&> upcb, void *arg, const storable_t<hnode_t>& hnode);
 template size_t dlnode_t::s_unpack_data(const void *buffer, size_t bufsize, dlnode_t::s_unpack_cb_t<storable_t<hnode_t>&> upcb, storable_t<hnode_t>& hnode);
 template size_t dlnode_t::s_unpack_data(const void *buffer, size_t bufsize, dlnode_t::s_unpack_cb_t<void*, storable_t<hnode_t>&> upcb, void *arg, storable_t<hnode_t>& hnode);
+template size_t dlnode_t::s_unpack_data(const void *buffer, size_t bufsize, dlnode_t::s_unpack_cb_t<uint64_t&> upcb, uint64_t& hostid);
 
 #include "hashtab_tmpl.cpp"
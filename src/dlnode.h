@@ -18,6 +18,7 @@
 #include "datanode.h"
 #include "danode.h"
 #include "storable.h"
+#include "timer_wheel.h"
 
 struct hnode_t;
 
@@ -52,7 +53,11 @@ struct hnode_t;
 /// should call `set_host` to link both nodes and should arrange that the download
 /// node is destroyed first.
 ///
-struct dlnode_t : public htab_obj_t<const string_t&, const string_t&>, public keynode_t<uint64_t>, public datanode_t<dlnode_t> {
+/// A download job node with an active download is scheduled in the download timer
+/// wheel in `state_t`, so timed out downloads can be ended without examining every
+/// download job node. The node removes itself from the wheel when it is destroyed.
+///
+struct dlnode_t : public htab_obj_t<const string_t&, const string_t&>, public keynode_t<uint64_t>, public datanode_t<dlnode_t>, public timer_node_t {
       // combined download job data
       string_t    name;                ///< Download job name.
       uint64_t    count;               ///< Number of times this download was performed.
@@ -89,6 +94,12 @@ struct dlnode_t : public htab_obj_t<const string_t&, const string_t&>, public ke
             return hash_ex(hash_ex(0, ipaddr), dlname);
          }
 
+         // same as above, but uses a hash value computed earlier for the IP address
+         static uint64_t hash_key(uint64_t iphash, const string_t& dlname) 
+         {
+            return hash_ex(iphash, dlname);
+         }
+
          virtual uint64_t get_hash(void) const override;
 
          //
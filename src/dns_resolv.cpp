@@ -443,8 +443,9 @@ dns_db_record_t dns_resolver_t::dnode_t::get_db_record(const tstamp_t& ts_runtim
 }
 
 ///
-/// Converts the IP address string from the host node into a sockaddr of 
-/// the appropriate type. 
+/// Copies the binary IP address stored in the host node into a sockaddr of 
+/// the appropriate type. Returns `false` if the host node string could not be 
+/// parsed as an IP address of the same family as the one in this node.
 /// 
 /// Note that while we could do this in the constructor, having a separate 
 /// method with a return value makes this operation more straightforward 
@@ -458,13 +459,19 @@ bool dns_resolver_t::dnode_t::fill_sockaddr(void)
    if(!hnode)
       return false;
 
+   const ipaddr_t& ipaddr = hnode->ipaddr;
+
    if(s_addr_ip.sa_family == AF_INET) {
-      if(inet_pton(AF_INET, hnode->string, &s_addr_ipv4.sin_addr) != 1)
+      if(ipaddr.family != ipaddr_t::IPV4)
          return false;
+
+      memcpy(&s_addr_ipv4.sin_addr, ipaddr.addr, ipaddr.size());
    }
    else if(s_addr_ip.sa_family == AF_INET6) {
-      if(inet_pton(AF_INET6, hnode->string, &s_addr_ipv6.sin6_addr) != 1)
+      if(ipaddr.family != ipaddr_t::IPV6)
          return false;
+
+      memcpy(&s_addr_ipv6.sin6_addr, ipaddr.addr, ipaddr.size());
    }
 
    return true;
@@ -550,7 +557,15 @@ bool dns_resolver_t::put_hnode(hnode_t *hnode)
    if(!hnode || hnode->string.isempty() || hnode->string[0] == ' ') 
       return false;
    
-   if(is_ipv4_address(hnode->string))
+   //
+   // Host nodes parse the IP address when they are created and its binary form 
+   // is used to fill in sockaddr. Malformed IP addresses, such as 256.0.0.1, are 
+   // still identified by their address family, so they are not treated as host 
+   // names below.
+   //
+   if(hnode->ipaddr.family != ipaddr_t::NONE)
+      sa_family = hnode->ipaddr.family == ipaddr_t::IPV4 ? AF_INET : AF_INET6;
+   else if(is_ipv4_address(hnode->string))
       sa_family = AF_INET;
    else if(is_ipv6_address(hnode->string))
       sa_family = AF_INET6;
@@ -584,7 +599,7 @@ bool dns_resolver_t::put_hnode(hnode_t *hnode)
 
    // check if this node should be DNS-resolved
    if(nptr->hnode) {
-      // convert the IP address string to sockaddr
+      // copy the parsed IP address to sockaddr
       if(!nptr->fill_sockaddr()) {
          delete nptr;
          return false;
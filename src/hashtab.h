@@ -65,6 +65,34 @@ struct hash_string {
    }
 };
 
+///
+/// @brief  A string with a precomputed hash value.
+///
+/// This type is used as a key in `std::unordered_set` and `std::unordered_map` to
+/// look up strings that have been hashed before without hashing them again. Lookup
+/// keys may wrap strings they do not own via `string_t::hold`.
+///
+struct hashed_string_t {
+   uint64_t    hashval;             ///< A hash value computed with `hash_ex(0, string)`
+   string_t    string;              ///< A string that was hashed
+
+   hashed_string_t(uint64_t hashval, const string_t& string) : hashval(hashval), string(string) {}
+
+   hashed_string_t(uint64_t hashval, string_t&& string) : hashval(hashval), string(std::move(string)) {}
+
+   bool operator == (const hashed_string_t& other) const {return hashval == other.hashval && string == other.string;}
+};
+
+///
+/// @brief  A hash function for `std::unordered_map` with a `hashed_string_t` key.
+///
+struct hash_hashed_string {
+   size_t operator () (const hashed_string_t& hstr) const
+   {
+      return (size_t) hstr.hashval;
+   }
+};
+
 template <typename node_t> struct htab_node_t;
 template <typename node_t> using node_list_t = std::list<htab_node_t<node_t>*>;
 
@@ -176,9 +204,77 @@ class hash_table_base {
          }
       };
 
+      ///
+      /// @brief  Tracks the combined estimated memory size of hash tables sharing
+      ///         a memory budget against a watermark.
+      ///
+      /// Hash tables update the combined memory size as nodes are inserted and
+      /// removed, so the owner can check whether some nodes should be swapped out
+      /// without having to add up memory sizes of all hash tables.
+      ///
+      class memwatch_t {
+         private:
+            size_t   memsize;          ///< Combined estimated memory size.
+            size_t   watermark;        ///< Memory size above which nodes should be swapped out.
+            int64_t  retry_tstamp;     ///< Time stamp after which a swap-out should be retried or zero.
+
+         public:
+            memwatch_t(void) : memsize(0), watermark(0), retry_tstamp(0) {}
+
+            /// Adds `size` to the combined memory size.
+            void add(size_t size) {memsize += size;}
+
+            /// Subtracts `size` from the combined memory size.
+            void sub(size_t size) {memsize = memsize > size ? memsize - size : 0;}
+
+            /// Returns the combined memory size.
+            size_t get_memsize(void) const {return memsize;}
+
+            /// Sets the memory size above which nodes should be swapped out and cancels any retry.
+            void set_watermark(size_t watermark) {this->watermark = watermark; retry_tstamp = 0;}
+
+            ///
+            /// Sets the watermark back to `maxmem` after a swap-out. If memory size is still
+            /// over `maxmem` because nodes were in use, the watermark is set `stepmem` above
+            /// the current memory size and a swap-out is also due at `retry_tstamp`.
+            ///
+            void update_watermark(size_t maxmem, size_t stepmem, int64_t retry_tstamp)
+            {
+               if(memsize > maxmem) {
+                  watermark = memsize + stepmem;
+                  this->retry_tstamp = retry_tstamp;
+               }
+               else {
+                  watermark = maxmem;
+                  this->retry_tstamp = 0;
+               }
+            }
+
+            /// Returns `true` if the combined memory size exceeds the watermark.
+            bool over_watermark(void) const {return memsize > watermark;}
+
+            /// Returns `true` if the combined memory size exceeds the watermark or if `tstamp` reached the retry time stamp.
+            bool is_swap_out_due(int64_t tstamp) const {return memsize > watermark || (retry_tstamp && tstamp >= retry_tstamp);}
+      };
+
+   protected:
+      memwatch_t  *memwatch;           ///< Combined memory size tracker or `nullptr`.
+
    public:
+      hash_table_base(void) : memwatch(nullptr) {}
+
       virtual ~hash_table_base(void) {}
 
+      /// Moves memory size of this hash table into the specified combined memory size tracker.
+      void set_memwatch(memwatch_t *memwatch)
+      {
+         if(this->memwatch)
+            this->memwatch->sub(get_memsize());
+
+         if((this->memwatch = memwatch) != nullptr)
+            memwatch->add(get_memsize());
+      }
+
       /// Returns estimated memory size for this hash table.
       virtual size_t get_memsize(void) const = 0;
 
@@ -268,6 +364,14 @@ class hash_table : public hash_table_base {
       ///
       typedef void (*swap_cb_t)(node_t *node, void *arg);
 
+      ///
+      /// @brief  Compares two nodes to determine the order in which they are saved in
+      ///         some external storage.
+      ///
+      /// Should return `true` if `node1` should be saved before `node2`, `false` otherwise.
+      ///
+      typedef bool (*order_cb_t)(const typename inner_node<node_t>::type *node1, const typename inner_node<node_t>::type *node2);
+
    public:
       ///
       /// @tparam list_iter_t    Either `std::list::iterator` or `std::list::const_iterator`.
@@ -424,11 +528,16 @@ class hash_table : public hash_table_base {
       size_t      memsize;    ///< Estimated serialized size in bytes of all nodes.
       bucket_t    *htab;      ///< Buckets
 
+      uint64_t    hits;       ///< Number of pre-insert look-ups that found a node
+      uint64_t    misses;     ///< Number of pre-insert look-ups that did not find a node
+      uint64_t    swapped;    ///< Number of nodes swapped out
+
       node_list_t<node_t>  tmlist;  ///< Time-ordered list of regular nodes.
       node_list_t<node_t>  grplist; ///< Unordered list of group nodes.
 
       eval_cb_t   evalcb;     ///< Evaluation callback.
       swap_cb_t   swapcb;     ///< Swap out callback.
+      order_cb_t  ordercb;    ///< Swap out order callback.
       void        *cbarg;     ///< Swap out and evaluation callbacks argument.
 
    private:
@@ -438,6 +547,9 @@ class hash_table : public hash_table_base {
       /// Moves the specified node to the beginning of the bucket list.
       void move_to_front(bucket_t& bucket, htab_node_t<node_t> *nptr) const;
 
+      /// Removes a swapped out node from the hash table and deletes it.
+      typename node_list_t<node_t>::iterator remove_node(htab_node_t<node_t> *nptr, size_t nsize);
+
    public:
       /// Constructs a hash table with the specified number of buckets.
       hash_table(size_t maxhash = MAXHASH, swap_cb_t swapcb = nullptr, void *cbarg = nullptr, eval_cb_t evalcb = nullptr);
@@ -455,6 +567,15 @@ class hash_table : public hash_table_base {
 
       /// Returns estimated memory size for this hash table.
       size_t get_memsize(void) const override {return memsize;}
+
+      /// Returns the number of pre-insert look-ups that found a node.
+      uint64_t get_hits(void) const {return hits;}
+
+      /// Returns the number of pre-insert look-ups that did not find a node.
+      uint64_t get_misses(void) const {return misses;}
+
+      /// Returns the number of nodes swapped out from this hash table.
+      uint64_t get_swapped(void) const {return swapped;}
       /// @}
 
       ///
@@ -463,7 +584,7 @@ class hash_table : public hash_table_base {
       /// @{
 
       /// Sets a swap-out callback function and its argument.
-      void set_swap_out_cb(swap_cb_t swapcb, void *arg, eval_cb_t evalcb = nullptr);
+      void set_swap_out_cb(swap_cb_t swapcb, void *arg, eval_cb_t evalcb = nullptr, order_cb_t ordercb = nullptr);
 
       /// Swaps out oldest nodes with time stamps less than or equal `tstamp` to some external storage.
       void swap_out(int64_t tstamp, size_t maxsize = 0) override;
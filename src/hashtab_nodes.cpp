@@ -21,8 +21,8 @@
 //
 // initialize specialized node versions
 //
-template<> const u_short datanode_t<hnode_t> ::__version = 9;
-template<> const u_short datanode_t<unode_t> ::__version = 3;
+template<> const u_short datanode_t<hnode_t> ::__version = 11;
+template<> const u_short datanode_t<unode_t> ::__version = 4;
 template<> const u_short datanode_t<rnode_t> ::__version = 2;
 template<> const u_short datanode_t<anode_t> ::__version = 3;
 template<> const u_short datanode_t<snode_t> ::__version = 2;
@@ -38,7 +38,7 @@ template<> const u_short datanode_t<danode_t>::__version = 2;
 template<> const u_short datanode_t<scnode_t>::__version = 2;
 template<> const u_short datanode_t<daily_t> ::__version = 2;
 template<> const u_short datanode_t<hourly_t>::__version = 1;
-template<> const u_short datanode_t<sysnode_t>::__version = 6;
+template<> const u_short datanode_t<sysnode_t>::__version = 9;
 
 //
 // hash table base webalizer nodes
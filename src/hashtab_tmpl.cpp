@@ -10,12 +10,16 @@
 #include <cstdlib>
 #include <cstring>
 #include <climits>
+#include <vector>
+#include <memory>
+#include <algorithm>
 
 #include "hashtab.h"
 
 template <typename node_t>
 hash_table<node_t>::hash_table(size_t maxhash, swap_cb_t swapcb, void *cbarg, eval_cb_t evalcb) : 
-      maxhash(maxhash), swapcb(swapcb), cbarg(cbarg), evalcb(evalcb), memsize(0)
+      maxhash(maxhash), swapcb(swapcb), ordercb(nullptr), cbarg(cbarg), evalcb(evalcb), memsize(0),
+      hits(0), misses(0), swapped(0)
 {
    count = 0;
    emptycnt = maxhash;
@@ -30,10 +34,11 @@ hash_table<node_t>::~hash_table(void)
 }
 
 template <typename node_t>
-void hash_table<node_t>::set_swap_out_cb(swap_cb_t swap, void *arg, eval_cb_t eval)
+void hash_table<node_t>::set_swap_out_cb(swap_cb_t swap, void *arg, eval_cb_t eval, order_cb_t order)
 {
    evalcb = eval;
    swapcb = swap;
+   ordercb = order;
    cbarg = arg;
 }
 
@@ -45,6 +50,15 @@ void hash_table<node_t>::set_swap_out_cb(swap_cb_t swap, void *arg, eval_cb_t ev
 /// to derive `tstamp`, which will swap out all nodes that haven't been touched in 
 /// visit timeout time.
 ///
+/// If there is an order callback, nodes are selected first and then passed to the
+/// swap-out callback in the order established by the order callback. Otherwise, each
+/// node is passed to the swap-out callback as soon as it is selected, in the time
+/// stamp order.
+///
+/// Each node is removed from the hash table only after the swap-out callback returned
+/// for this node, so if the callback throws an exception, this node and all nodes that
+/// were not passed to the callback yet remain in the hash table.
+///
 template <typename node_t>
 void hash_table<node_t>::swap_out(int64_t tstamp, size_t maxsize)
 {
@@ -54,6 +68,12 @@ void hash_table<node_t>::swap_out(int64_t tstamp, size_t maxsize)
 
    typename node_list_t<node_t>::iterator lsnode = tmlist.begin();
 
+   // selected nodes to be passed to the swap-out callback in the requested order and their memory sizes
+   std::vector<std::pair<htab_node_t<node_t>*, size_t>> batch;
+
+   // memory size of the nodes in the batch
+   size_t batchsize = 0;
+
    //
    // Swap out oldest nodes with time stamps less than or equal to tstamp until the
    // remaining hash table memory size is less than maxsize. Note, though, that memory
@@ -61,13 +81,12 @@ void hash_table<node_t>::swap_out(int64_t tstamp, size_t maxsize)
    // in the hash table, so once the hash table memory size is zero, ignore it and
    // finish evaluating time stamps.
    //
-   while(lsnode != tmlist.end() && (*lsnode)->tstamp <= tstamp && (!memsize || memsize > maxsize)) {
+   while(lsnode != tmlist.end() && (*lsnode)->tstamp <= tstamp && (memsize == batchsize || memsize - batchsize > maxsize)) {
       // only regular nodes can be in the time stamp list
       if((*lsnode)->node->get_type() != OBJ_REG)
          throw std::logic_error("Only regular object nodes may be swapped out");
 
       htab_node_t<node_t> *nptr = *lsnode;
-      bucket_t& bucket = htab[nptr->hashval % maxhash];
 
       if(nptr->lsnode == tmlist.end())
          throw std::logic_error("Bad time stamp list node reference");
@@ -76,33 +95,71 @@ void hash_table<node_t>::swap_out(int64_t tstamp, size_t maxsize)
       if(evalcb && !evalcb(nptr->node, cbarg))
          lsnode++;
       else {
-         // remove the node from the bucket
-         unlink_node(bucket, nptr);
-
-         // and from the time-ordered list and advance the node iterator
-         lsnode = tmlist.erase(nptr->lsnode);
-
          // serialized node size may have changed since it was added (e.g. city was added later)
          size_t nsize = nptr->node->s_data_size() + sizeof(node_t);
-         if(memsize > nsize)
-            memsize -= nsize;
-         else
-            memsize = 0;
-
-         // adjust counters
-         count--;
-         if(--bucket.count == 0)
-            emptycnt++;
+         if(memsize - batchsize < nsize)
+            nsize = memsize - batchsize;
+
+         if(ordercb) {
+            // hold onto the node until all nodes are selected
+            batch.emplace_back(nptr, nsize);
+            batchsize += nsize;
+            lsnode++;
+         }
+         else {
+            // save the node in some external storage and then remove it from the hash table
+            swapcb(nptr->node, cbarg);
+            lsnode = remove_node(nptr, nsize);
+         }
+      }
+   }
 
-         // wrap the node in a unique pointer in case swapcb throws an exception
-         std::unique_ptr<htab_node_t<node_t>> uptr(nptr);
+   if(!batch.empty()) {
+      std::sort(batch.begin(), batch.end(), [this] (const std::pair<htab_node_t<node_t>*, size_t>& nptr1, const std::pair<htab_node_t<node_t>*, size_t>& nptr2) 
+      {
+         return ordercb(nptr1.first->node, nptr2.first->node);
+      });
 
-         // finally, save the node in some external storage
-         swapcb(nptr->node, cbarg);
+      for(std::pair<htab_node_t<node_t>*, size_t>& nptr : batch) {
+         swapcb(nptr.first->node, cbarg);
+         remove_node(nptr.first, nptr.second);
       }
    }
 }
 
+///
+/// Removes a swapped out node from its bucket and from the time-ordered list and
+/// deletes it. `nsize` is subtracted from the hash table memory size. Returns the
+/// time-ordered list iterator that follows the removed node.
+///
+template <typename node_t>
+typename node_list_t<node_t>::iterator hash_table<node_t>::remove_node(htab_node_t<node_t> *nptr, size_t nsize)
+{
+   bucket_t& bucket = htab[nptr->hashval % maxhash];
+
+   // remove the node from the bucket
+   unlink_node(bucket, nptr);
+
+   // and from the time-ordered list
+   typename node_list_t<node_t>::iterator lsnode = tmlist.erase(nptr->lsnode);
+
+   memsize -= nsize;
+
+   if(memwatch)
+      memwatch->sub(nsize);
+
+   // adjust counters
+   count--;
+   if(--bucket.count == 0)
+      emptycnt++;
+
+   swapped++;
+
+   delete nptr;
+
+   return lsnode;
+}
+
 ///
 /// This method must only be used when incoming object nodes are guaranteed to have
 /// unique keys and the caller didn't need to call `find_node` prior to this call.
@@ -179,7 +236,12 @@ node_t *hash_table<node_t>::put_node(uint64_t hashval, node_t *node, int64_t tst
    *hptr = nptr;
 
    // update sizes and counts
-   memsize += (nptr->node->s_data_size() + sizeof(node_t));
+   size_t nsize = nptr->node->s_data_size() + sizeof(node_t);
+
+   memsize += nsize;
+
+   if(memwatch)
+      memwatch->add(nsize);
 
    htab[hashidx].count++;
    count++;
@@ -274,11 +336,15 @@ node_t *hash_table<node_t>::find_node(uint64_t hashval, nodetype_t type, int64_t
                nptr->lsnode = tmlist.insert(tmlist.end(), nptr);
             }
 
+            hits++;
+
             return nptr->node;
          }
       }
    }
 
+   misses++;
+
    return nullptr;
 }
 
@@ -302,6 +368,10 @@ void hash_table<node_t>::clear(void)
    // now adjust all counts
    count = 0;
    emptycnt = maxhash;
+
+   if(memwatch)
+      memwatch->sub(memsize);
+
    memsize = 0;
 }
 
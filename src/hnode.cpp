@@ -43,7 +43,8 @@ hnode_t::hnode_t(hnode_t&& hnode) noexcept : base_node<hnode_t>(std::move(hnode)
       city(std::move(hnode.city)),
       geoname_id(hnode.geoname_id),
       as_num(hnode.as_num),
-      as_org(std::move(hnode.as_org))
+      as_org(std::move(hnode.as_org)),
+      ipaddr(hnode.ipaddr)
 {
    spammer = hnode.spammer;
    robot = hnode.robot;
@@ -84,11 +85,15 @@ hnode_t::hnode_t(hnode_t&& hnode) noexcept : base_node<hnode_t>(std::move(hnode)
    hnode.visit = nullptr;
 }
 
-hnode_t::hnode_t(const string_t& ipaddr, nodetype_t type) :
-      base_node<hnode_t>(ipaddr, type),
+hnode_t::hnode_t(const string_t& hostaddr, nodetype_t type) :
+      base_node<hnode_t>(hostaddr, type),
       geoname_id(0),
       as_num(0)
 {
+   // parse the IP address once per host, so the DNS resolver doesn't have to
+   if(type == OBJ_REG)
+      parse_ip_address(hostaddr, ipaddr);
+
    spammer = false;
    robot = false;
    resolved = false;
@@ -188,24 +193,39 @@ void hnode_t::reset_ccode(void)
 // serialization
 //
 
+///
+/// Starting with version 10, fields used as secondary database keys (hits, transfer
+/// amount and the value hash) are stored as fixed-width values in front of all other
+/// fields, so field extractors can compute their offsets without parsing the record.
+/// The remaining counters and the time stamp are stored as variable-length values.
+///
+/// Starting with version 11, the binary IP address is stored after all other fields.
+/// It is parsed from the host address when older versions are unpacked.
+///
 size_t hnode_t::s_data_size(void) const
 {
    return base_node<hnode_t>::s_data_size() + 
                sizeof(u_char) * 3 +             // spammer, active, robot
-               sizeof(uint64_t) * 3 +             // count, files, pages
-               sizeof(uint64_t) * 3 +             // visits, visit_max, visits_conv
-               sizeof(uint64_t) * 3 +             // max_v_hits, max_v_files, max_v_pages
-               sizeof(uint64_t)     +             // hash(value)  
-               serializer_t::s_size_of(tstamp) +// tstamp 
+               sizeof(uint64_t) * 3 +           // count, xfer, hash(value)
+               serializer_t::s_size_of_varint(files) + 
+               serializer_t::s_size_of_varint(pages) + 
+               serializer_t::s_size_of_varint(visits) + 
+               serializer_t::s_size_of_varint(visit_max) + 
+               serializer_t::s_size_of_varint(max_v_hits) + 
+               serializer_t::s_size_of_varint(max_v_files) + 
+               serializer_t::s_size_of_varint(max_v_pages) + 
+               serializer_t::s_size_of_varint(max_v_xfer) + 
+               serializer_t::s_size_of_varint(visits_conv) + 
+               serializer_t::s_size_of_varint(tstamp) +  // tstamp 
                sizeof(double)  +                // visit_avg
-               sizeof(uint64_t) * 2 +           // xfer, max_v_xfer
                serializer_t::s_size_of(name) +  // name
                ccode_size         +             // country code
                serializer_t::s_size_of(city) +  // city
                sizeof(double) * 2 +             // latitude, longitude
-               sizeof(uint32_t) +               // geoname_id
-               serializer_t::s_size_of(as_num) +      // as_num
-               serializer_t::s_size_of(as_org);       // as_org
+               serializer_t::s_size_of_varint(geoname_id) +   // geoname_id
+               serializer_t::s_size_of_varint(as_num) +       // as_num
+               serializer_t::s_size_of(as_org) +              // as_org
+               serializer_t::s_size_of(ipaddr);               // ipaddr
 }
 
 size_t hnode_t::s_pack_data(void *buffer, size_t bufsize) const
@@ -215,38 +235,43 @@ size_t hnode_t::s_pack_data(void *buffer, size_t bufsize) const
    size_t basesize = base_node<hnode_t>::s_pack_data(buffer, bufsize);
    void *ptr = (u_char*) buffer + basesize;
 
+   // fixed-width fields referenced by secondary databases
    ptr = sr.serialize(ptr, spammer);
    ptr = sr.serialize(ptr, count);
-   ptr = sr.serialize(ptr, files);
-   ptr = sr.serialize(ptr, pages);
    ptr = sr.serialize(ptr, xfer);
-   ptr = sr.serialize(ptr, visits);
-   ptr = sr.serialize(ptr, visit_avg);
-   ptr = sr.serialize(ptr, visit_max);
-   ptr = sr.serialize(ptr, max_v_hits);
-   ptr = sr.serialize(ptr, max_v_files);
-   ptr = sr.serialize(ptr, max_v_pages);
-   ptr = sr.serialize(ptr, max_v_xfer);
+   ptr = sr.serialize(ptr, s_hash_value());
+
    ptr = sr.serialize(ptr, (visit) ? true : false);
 
-   ptr = sr.serialize(ptr, s_hash_value());
+   ptr = sr.serialize_varint(ptr, files);
+   ptr = sr.serialize_varint(ptr, pages);
+   ptr = sr.serialize_varint(ptr, visits);
+   ptr = sr.serialize(ptr, visit_avg);
+   ptr = sr.serialize_varint(ptr, visit_max);
+   ptr = sr.serialize_varint(ptr, max_v_hits);
+   ptr = sr.serialize_varint(ptr, max_v_files);
+   ptr = sr.serialize_varint(ptr, max_v_pages);
+   ptr = sr.serialize_varint(ptr, max_v_xfer);
+
    ptr = sr.serialize(ptr, name);
    ptr = sr.serialize(ptr, (char (&)[2]) ccode);
 
    ptr = sr.serialize(ptr, robot);
-   ptr = sr.serialize(ptr, visits_conv);
-   ptr = sr.serialize(ptr, tstamp);
+   ptr = sr.serialize_varint(ptr, visits_conv);
+   ptr = sr.serialize_varint(ptr, tstamp);
 
    ptr = sr.serialize(ptr, city);
 
    ptr = sr.serialize(ptr, latitude);
    ptr = sr.serialize(ptr, longitude);
 
-   ptr = sr.serialize(ptr, geoname_id);
+   ptr = sr.serialize_varint(ptr, geoname_id);
 
-   ptr = sr.serialize(ptr, as_num);
+   ptr = sr.serialize_varint(ptr, as_num);
    ptr = sr.serialize(ptr, as_org);
 
+   ptr = sr.serialize(ptr, ipaddr);
+
    return sr.data_size(ptr);
 }
 
@@ -262,71 +287,116 @@ size_t hnode_t::s_unpack_data(const void *buffer, size_t bufsize, s_unpack_cb_t<
 
    u_short version = s_node_ver(buffer);
 
-   ptr = sr.deserialize(ptr, tmp); spammer = tmp;
-   ptr = sr.deserialize(ptr, count);
-   ptr = sr.deserialize(ptr, files);
-   ptr = sr.deserialize(ptr, pages);
-   ptr = sr.deserialize(ptr, xfer);
-   ptr = sr.deserialize(ptr, visits);
-   ptr = sr.deserialize(ptr, visit_avg);
-   ptr = sr.deserialize(ptr, visit_max);
-   ptr = sr.deserialize(ptr, max_v_hits);
-   ptr = sr.deserialize(ptr, max_v_files);
-   ptr = sr.deserialize(ptr, max_v_pages);
-   ptr = sr.deserialize(ptr, max_v_xfer);
-   ptr = sr.deserialize(ptr, active);
-
-   ptr = sr.s_skip_field<uint64_t>(ptr);      // value hash
-
-   ptr = sr.deserialize(ptr, name);
-   ptr = sr.deserialize(ptr, (char (&)[2]) ccode);
-
-   if(version >= 2)
-      {ptr = sr.deserialize(ptr, tmp); robot = tmp;}
-   else
-      robot = false;
+   if(version >= 10) {
+      ptr = sr.deserialize(ptr, tmp); spammer = tmp;
+      ptr = sr.deserialize(ptr, count);
+      ptr = sr.deserialize(ptr, xfer);
 
-   if(version >= 3)
-      ptr = sr.deserialize(ptr, visits_conv);
-   else
-      visits_conv = 0;
+      ptr = sr.s_skip_field<uint64_t>(ptr);      // value hash
 
-   if(version >= 4) {
-      if(version >= 5)
-         ptr = sr.deserialize(ptr, tstamp);
-      else {
-         uint64_t tmp;
-         ptr = sr.deserialize(ptr, tmp);
-         tstamp.reset((time_t) tmp);
-      }
-   }
-   else
-      tstamp.reset();
+      ptr = sr.deserialize(ptr, active);
+
+      ptr = sr.deserialize_varint(ptr, files);
+      ptr = sr.deserialize_varint(ptr, pages);
+      ptr = sr.deserialize_varint(ptr, visits);
+      ptr = sr.deserialize(ptr, visit_avg);
+      ptr = sr.deserialize_varint(ptr, visit_max);
+      ptr = sr.deserialize_varint(ptr, max_v_hits);
+      ptr = sr.deserialize_varint(ptr, max_v_files);
+      ptr = sr.deserialize_varint(ptr, max_v_pages);
+      ptr = sr.deserialize_varint(ptr, max_v_xfer);
+
+      ptr = sr.deserialize(ptr, name);
+      ptr = sr.deserialize(ptr, (char (&)[2]) ccode);
+
+      ptr = sr.deserialize(ptr, tmp); robot = tmp;
+      ptr = sr.deserialize_varint(ptr, visits_conv);
+      ptr = sr.deserialize_varint(ptr, tstamp);
 
-   if(version >= 6)
       ptr = sr.deserialize(ptr, city);
-   else
-      city.clear();
 
-   if(version >= 7) {
       ptr = sr.deserialize(ptr, latitude);
       ptr = sr.deserialize(ptr, longitude);
-   }
 
-   if(version >= 8)
-      ptr = sr.deserialize(ptr, geoname_id);
-   else
-      geoname_id = 0;
+      ptr = sr.deserialize_varint(ptr, geoname_id);
 
-   if(version >= 9) {
-      ptr = sr.deserialize(ptr, as_num);
+      ptr = sr.deserialize_varint(ptr, as_num);
       ptr = sr.deserialize(ptr, as_org);
    }
    else {
-      as_num = 0;
-      as_org.reset();
+      ptr = sr.deserialize(ptr, tmp); spammer = tmp;
+      ptr = sr.deserialize(ptr, count);
+      ptr = sr.deserialize(ptr, files);
+      ptr = sr.deserialize(ptr, pages);
+      ptr = sr.deserialize(ptr, xfer);
+      ptr = sr.deserialize(ptr, visits);
+      ptr = sr.deserialize(ptr, visit_avg);
+      ptr = sr.deserialize(ptr, visit_max);
+      ptr = sr.deserialize(ptr, max_v_hits);
+      ptr = sr.deserialize(ptr, max_v_files);
+      ptr = sr.deserialize(ptr, max_v_pages);
+      ptr = sr.deserialize(ptr, max_v_xfer);
+      ptr = sr.deserialize(ptr, active);
+
+      ptr = sr.s_skip_field<uint64_t>(ptr);      // value hash
+
+      ptr = sr.deserialize(ptr, name);
+      ptr = sr.deserialize(ptr, (char (&)[2]) ccode);
+
+      if(version >= 2)
+         {ptr = sr.deserialize(ptr, tmp); robot = tmp;}
+      else
+         robot = false;
+
+      if(version >= 3)
+         ptr = sr.deserialize(ptr, visits_conv);
+      else
+         visits_conv = 0;
+
+      if(version >= 4) {
+         if(version >= 5)
+            ptr = sr.deserialize(ptr, tstamp);
+         else {
+            uint64_t tmp;
+            ptr = sr.deserialize(ptr, tmp);
+            tstamp.reset((time_t) tmp);
+         }
+      }
+      else
+         tstamp.reset();
+
+      if(version >= 6)
+         ptr = sr.deserialize(ptr, city);
+      else
+         city.clear();
+
+      if(version >= 7) {
+         ptr = sr.deserialize(ptr, latitude);
+         ptr = sr.deserialize(ptr, longitude);
+      }
+
+      if(version >= 8)
+         ptr = sr.deserialize(ptr, geoname_id);
+      else
+         geoname_id = 0;
+
+      if(version >= 9) {
+         ptr = sr.deserialize(ptr, as_num);
+         ptr = sr.deserialize(ptr, as_org);
+      }
+      else {
+         as_num = 0;
+         as_org.reset();
+      }
    }
 
+   if(version >= 11)
+      ptr = sr.deserialize(ptr, ipaddr);
+   else if(flag == OBJ_REG)
+      parse_ip_address(string, ipaddr);
+   else
+      ipaddr = ipaddr_t();
+
    visit = nullptr;
 
    // all hosts in the state database are assumed to be resolved
@@ -341,6 +411,13 @@ size_t hnode_t::s_unpack_data(const void *buffer, size_t bufsize, s_unpack_cb_t<
 const void *hnode_t::s_field_value_hash(const void *buffer, size_t bufsize, size_t& datasize)
 {
    datasize = sizeof(uint64_t);
+
+   if(s_node_ver(buffer) >= 10) {
+      return (u_char*)buffer + base_node<hnode_t>::s_data_size(buffer, bufsize) + 
+               sizeof(u_char) +           // spammer
+               sizeof(uint64_t) * 2;      // count, xfer
+   }
+
    return (u_char*)buffer + base_node<hnode_t>::s_data_size(buffer, bufsize) + 
             sizeof(u_char) * 2 +       // spammer, active
             sizeof(uint64_t) * 3 +     // count, files, pages
@@ -353,6 +430,13 @@ const void *hnode_t::s_field_value_hash(const void *buffer, size_t bufsize, size
 const void *hnode_t::s_field_xfer(const void *buffer, size_t bufsize, size_t& datasize)
 {
    datasize = sizeof(uint64_t);
+
+   if(s_node_ver(buffer) >= 10) {
+      return (u_char*) buffer + base_node<hnode_t>::s_data_size(buffer, bufsize) + 
+               sizeof(u_char) +           // spammer 
+               sizeof(uint64_t);          // count
+   }
+
    return (u_char*) buffer + base_node<hnode_t>::s_data_size(buffer, bufsize) + 
             sizeof(u_char) +           // spammer 
             sizeof(uint64_t) * 3;      // count, files, pages
@@ -365,6 +449,55 @@ const void *hnode_t::s_field_hits(const void *buffer, size_t bufsize, size_t& da
             sizeof(u_char);            // spammer
 }
 
+const void *hnode_t::s_field_name(const void *buffer, size_t bufsize, size_t& datasize)
+{
+   serializer_t sr(buffer, bufsize);
+   const void *ptr;
+
+   if(s_node_ver(buffer) >= 10) {
+      ptr = (u_char*) buffer + base_node<hnode_t>::s_data_size(buffer, bufsize) + 
+               sizeof(u_char) * 2 +       // spammer, active
+               sizeof(uint64_t) * 3;      // count, xfer, value hash
+
+      // files, pages, visits
+      for(size_t i = 0; i < 3; i++)
+         ptr = sr.s_skip_varint(ptr);
+
+      ptr = sr.s_skip_field<double>(ptr);    // visit_avg
+
+      // visit_max, max_v_hits, max_v_files, max_v_pages, max_v_xfer
+      for(size_t i = 0; i < 5; i++)
+         ptr = sr.s_skip_varint(ptr);
+   }
+   else {
+      ptr = (u_char*) s_field_value_hash(buffer, bufsize, datasize) + 
+               sizeof(uint64_t);          // value hash
+   }
+
+   datasize = sr.s_size_of<string_t>(ptr);
+
+   return ptr;
+}
+
+bool hnode_t::s_is_robot(const void *buffer, size_t bufsize)
+{
+   serializer_t sr(buffer, bufsize);
+   size_t datasize;
+   char ccode[2];
+   bool robot;
+
+   if(s_node_ver(buffer) < 2)
+      return false;
+
+   const void *ptr = (u_char*) s_field_name(buffer, bufsize, datasize) + datasize;
+
+   ptr = sr.deserialize(ptr, ccode);
+
+   sr.deserialize(ptr, robot);
+
+   return robot;
+}
+
 int64_t hnode_t::s_compare_xfer(const void *buf1, size_t buf1size, const void *buf2, size_t buf2size)
 {
    return s_compare<uint64_t>(buf1, buf1size, buf2, buf2size);
@@ -18,6 +18,8 @@
 #include "tstamp.h"
 #include "types.h"
 #include "storable.h"
+#include "timer_wheel.h"
+#include "util_ipaddr.h"
 
 ///
 /// @brief  Host node
@@ -51,7 +53,13 @@
 /// sync regardless whether there is a visit active or not. See `vnode_t` for
 /// details.
 ///
-struct hnode_t : public base_node<hnode_t> {
+/// 7. A host node with an active visit is scheduled in the visit timer wheel in
+/// `state_t`, so timed out visits can be ended without examining every host node.
+/// The schedule is not updated with every request and a visit that is found to
+/// be still active when its host node expires is scheduled again. A host node
+/// removes itself from the wheel when it is destroyed.
+///
+struct hnode_t : public base_node<hnode_t>, public timer_node_t {
       static const size_t ccode_size = 2;   ///< In characters, not counting the zero terminator
 
       uint64_t count;                ///< Request count
@@ -96,6 +104,8 @@ struct hnode_t : public base_node<hnode_t> {
       uint32_t as_num;              ///< Autonomous system number.
       string_t as_org;              ///< Autonomous system organization.
 
+      ipaddr_t ipaddr;              ///< Binary IP address (`ipaddr_t::NONE` for host names and groups).
+
       public:
          template <typename ... param_t>
          using s_unpack_cb_t = void (*)(hnode_t& hnode, bool active, param_t ... param);
@@ -103,7 +113,7 @@ struct hnode_t : public base_node<hnode_t> {
       public:
          hnode_t(void);
          hnode_t(hnode_t&& tmp) noexcept;
-         hnode_t(const string_t& ipaddr, nodetype_t type);
+         hnode_t(const string_t& hostaddr, nodetype_t type);
 
          ~hnode_t(void);
 
@@ -141,6 +151,9 @@ struct hnode_t : public base_node<hnode_t> {
          static const void *s_field_value_hash(const void *buffer, size_t bufsize, size_t& datasize);
          static const void *s_field_xfer(const void *buffer, size_t bufsize, size_t& datasize);
          static const void *s_field_hits(const void *buffer, size_t bufsize, size_t& datasize);
+         static const void *s_field_name(const void *buffer, size_t bufsize, size_t& datasize);
+
+         static bool s_is_robot(const void *buffer, size_t bufsize);
 
          static int64_t s_compare_xfer(const void *buf1, size_t buf1size, const void *buf2, size_t buf2size);
          static int64_t s_compare_hits(const void *buf1, size_t buf1size, const void *buf2, size_t buf2size);
@@ -1137,6 +1137,94 @@ void html_output_t::hourly_total_table()
    fputs("</table>\n", out_fp);
 }
 
+//
+// Report filters are called by database iterators with serialized node data
+// and reject hidden items before they are unpacked. Groups are rejected when
+// they are bundled at the top of the report and would be listed twice otherwise.
+//
+bool html_output_t::is_hidden_value(const nlist& hidden, const void *data, size_t datasize, const void *field, size_t maxlen)
+{
+   serializer_t sr(data, datasize);
+   const char *cp;
+   size_t offset;
+   u_int slen;
+
+   // a field outside of the record is not hidden and will be reported when the node is unpacked
+   if(field < data || (offset = (const u_char*) field - (const u_char*) data) > datasize || datasize - offset < sizeof(u_int))
+      return false;
+
+   cp = (const char*) sr.deserialize(field, slen);
+
+   if(datasize - offset - sizeof(u_int) < slen)
+      return false;
+
+   // match the string in the record buffer without copying it
+   return slen && hidden.isinlistex(cp, std::min<size_t>(slen, maxlen), true);
+}
+
+bool html_output_t::filter_hosts_cb(const void *data, size_t datasize, void *arg)
+{
+   const config_t& config = ((const html_output_t*) arg)->config;
+   size_t fieldsize;
+
+   if(hnode_t::s_is_group(data, datasize))
+      return !config.bundle_groups;
+
+   if(config.hide_hosts || config.hide_robots && hnode_t::s_is_robot(data, datasize))
+      return false;
+
+   return !is_hidden_value(config.hidden_hosts, data, datasize, hnode_t::s_field_value(data, datasize, fieldsize)) &&
+            !is_hidden_value(config.hidden_hosts, data, datasize, hnode_t::s_field_name(data, datasize, fieldsize));
+}
+
+bool html_output_t::filter_urls_cb(const void *data, size_t datasize, void *arg)
+{
+   const config_t& config = ((const html_output_t*) arg)->config;
+   size_t fieldsize;
+
+   if(unode_t::s_is_group(data, datasize))
+      return !config.bundle_groups;
+
+   // URLs are hidden by their path, without search arguments
+   return !is_hidden_value(config.hidden_urls, data, datasize, unode_t::s_field_value(data, datasize, fieldsize), unode_t::s_path_length(data, datasize));
+}
+
+bool html_output_t::filter_refs_cb(const void *data, size_t datasize, void *arg)
+{
+   const config_t& config = ((const html_output_t*) arg)->config;
+   size_t fieldsize;
+
+   if(rnode_t::s_is_group(data, datasize))
+      return !config.bundle_groups;
+
+   return !is_hidden_value(config.hidden_refs, data, datasize, rnode_t::s_field_value(data, datasize, fieldsize));
+}
+
+bool html_output_t::filter_agents_cb(const void *data, size_t datasize, void *arg)
+{
+   const config_t& config = ((const html_output_t*) arg)->config;
+   size_t fieldsize;
+
+   if(anode_t::s_is_group(data, datasize))
+      return !config.bundle_groups;
+
+   if(config.hide_robots && anode_t::s_is_robot(data, datasize))
+      return false;
+
+   return !is_hidden_value(config.hidden_agents, data, datasize, anode_t::s_field_value(data, datasize, fieldsize));
+}
+
+bool html_output_t::filter_users_cb(const void *data, size_t datasize, void *arg)
+{
+   const config_t& config = ((const html_output_t*) arg)->config;
+   size_t fieldsize;
+
+   if(inode_t::s_is_group(data, datasize))
+      return !config.bundle_groups;
+
+   return !is_hidden_value(config.hidden_users, data, datasize, inode_t::s_field_value(data, datasize, fieldsize));
+}
+
 /*********************************************/
 /* TOP_SITES_TABLE - generate top n table    */
 /*********************************************/
@@ -1187,20 +1275,11 @@ void html_output_t::top_hosts_table(int flag)
    if(i < tot_num) {
       database_t::reverse_iterator<hnode_t> iter = state.database.rbegin_hosts(flag ? "hosts.xfer" : "hosts.hits");
 
-      while(i < tot_num && iter.prev(h_array[i])) {
-         if(h_array[i].flag == OBJ_REG) {
-            // ignore hosts matching any of the hiding patterns
-            if(config.hide_hosts || h_array[i].robot && config.hide_robots || config.hidden_hosts.isinlist(h_array[i].string) || config.hidden_hosts.isinlist(h_array[i].name))
-               continue;
-         }
-         else if(h_array[i].flag == OBJ_GRP) {
-            // ignore groups if we did them before
-            if(config.bundle_groups)
-               continue;
-         }
+      // skip hidden items and bundled groups without unpacking them
+      iter.set_filter(filter_hosts_cb, this);
 
+      while(i < tot_num && iter.prev(h_array[i]))
          i++;
-      }
 
       iter.close();
    }
@@ -1434,11 +1513,10 @@ int html_output_t::all_hosts_page(void)
    if (!config.hide_hosts) {
       database_t::reverse_iterator<hnode_t> iter = state.database.rbegin_hosts("hosts.hits");
 
+      iter.set_filter(filter_hosts_cb, this);
+
       while(iter.prev(hnode)) {
          if(hnode.flag == OBJ_REG) {
-            if(hnode.robot && config.hide_robots || config.hidden_hosts.isinlist(hnode.string) || config.hidden_hosts.isinlist(hnode.name))
-               continue;
-
             fprintf(out_fp, "%-8" PRIu64 
                      " %6.02f%%  %8" PRIu64 
                      " %6.02f%%  %8" PRIu64 
@@ -1527,20 +1605,11 @@ void html_output_t::top_urls_table(int flag)
    if(i < tot_num) {
       database_t::reverse_iterator<unode_t> iter = state.database.rbegin_urls(flag ? "urls.xfer" : "urls.hits");
 
-      while(i < tot_num && iter.prev(u_array[i])) {
-         if(u_array[i].flag == OBJ_REG) {
-            // ignore URLs matching any of the hiding patterns
-            if(config.hidden_urls.isinlistex(u_array[i].string, u_array[i].pathlen, true))
-               continue;
-         }
-         else if(u_array[i].flag == OBJ_GRP) {
-            // ignore groups if we did them before
-            if(config.bundle_groups)
-               continue;
-         }
+      // skip hidden items and bundled groups without unpacking them
+      iter.set_filter(filter_urls_cb, this);
 
+      while(i < tot_num && iter.prev(u_array[i]))
          i++;
-      }
 
       iter.close();
    }
@@ -1582,7 +1651,7 @@ void html_output_t::top_urls_table(int flag)
       // if we have page titles configured, check if this URL matches any
       if(config.page_titles.size()) {
          if(uptr->flag == OBJ_REG)
-            page_title = config.page_titles.isinglist(uptr->string.c_str(), uptr->string.length(), false);
+            page_title = config.page_title_index.find_name(uptr->string.c_str(), uptr->string.length());
          else if(page_title)
             page_title = nullptr;
       }
@@ -1721,16 +1790,15 @@ int html_output_t::all_urls_page(void)
    /* now do invididual URLs (if any) */
    database_t::reverse_iterator<unode_t> iter = state.database.rbegin_urls("urls.hits");
 
+   iter.set_filter(filter_urls_cb, this);
+
    while (iter.prev(unode)) {
       if(unode.flag == OBJ_REG) {
-         if(config.hidden_urls.isinlistex(unode.string, unode.pathlen, true))
-            continue;
-
          const buffer_formatter_t::scope_t& fmt_scope = buffer_formatter.set_scope_mode(buffer_formatter_t::append);
 
          // if we have page titles configured, check if this URL matches any
          if(config.page_titles.size())
-            page_title = config.page_titles.isinglist(unode.string.c_str(), unode.string.length(), false);
+            page_title = config.page_title_index.find_name(unode.string.c_str(), unode.string.length());
 
          fprintf(out_fp,"%-8" PRIu64 " %6.02f%%  <span data-xfer=\"%" PRIu64 "\">%9s</span> %6.02f%%  %12.3f  %12.3f %c <span",
             unode.count,
@@ -1797,8 +1865,11 @@ void html_output_t::top_entry_table(int flag)
    // traverse the entry/exit tables and populate the array
    database_t::reverse_iterator<unode_t> iter = state.database.rbegin_urls(flag ? "urls.exit" : "urls.entry");
 
+   // skip hidden items without unpacking them
+   iter.set_filter(filter_urls_cb, this);
+
    while(i < tot_num && iter.prev(u_array[i])) {
-      if(u_array[i].flag == OBJ_REG && !config.hidden_urls.isinlistex(u_array[i].string, u_array[i].pathlen, true)) {
+      if(u_array[i].flag == OBJ_REG) {
          // do not show entries with zero entry/exit values
          if(!flag && u_array[i].entry || flag && u_array[i].exit)
             i++;
@@ -1845,7 +1916,7 @@ void html_output_t::top_entry_table(int flag)
       // if we have page titles configured, check if this URL matches any
       if(config.page_titles.size()) {
          if(uptr->flag == OBJ_REG)
-            page_title = config.page_titles.isinglist(uptr->string.c_str(), uptr->string.length(), false);
+            page_title = config.page_title_index.find_name(uptr->string.c_str(), uptr->string.length());
          else if(page_title)
             page_title = nullptr;
       }
@@ -1945,20 +2016,11 @@ void html_output_t::top_refs_table()
    if(i < tot_num) {
       database_t::reverse_iterator<rnode_t> iter = state.database.rbegin_referrers("referrers.hits");
 
-      while(i < tot_num && iter.prev(r_array[i])) {
-         if(r_array[i].flag == OBJ_REG) {
-            // ignore referrers matching any of the hiding patterns
-            if(config.hidden_refs.isinlist(r_array[i].string))
-               continue;
-         }
-         else if(r_array[i].flag == OBJ_GRP) {
-            // ignore groups if we did them before
-            if(config.bundle_groups)
-               continue;
-         }
+      // skip hidden items and bundled groups without unpacking them
+      iter.set_filter(filter_refs_cb, this);
 
+      while(i < tot_num && iter.prev(r_array[i]))
          i++;
-      }
 
       iter.close();
    }
@@ -2480,11 +2542,10 @@ int html_output_t::all_refs_page(void)
 
    database_t::reverse_iterator<rnode_t> iter = state.database.rbegin_referrers("referrers.hits");
 
+   iter.set_filter(filter_refs_cb, this);
+
    while(iter.prev(rnode)) {
       if(rnode.flag == OBJ_REG) {
-         if(config.hidden_refs.isinlist(rnode.string))
-            continue;
-      
          const char *dispurl;
 
          if(rnode.string.isempty())
@@ -2551,20 +2612,11 @@ void html_output_t::top_agents_table()
    if(i < tot_num) {
       database_t::reverse_iterator<anode_t> iter = state.database.rbegin_agents("agents.visits");
 
-      while(i < tot_num && iter.prev(a_array[i])) {
-         if(a_array[i].flag == OBJ_REG) {
-            // ignore agents matching any of the hiding patterns
-            if(config.hide_robots  && a_array[i].robot || config.hidden_agents.isinlist(a_array[i].string))
-               continue;
-         }
-         else if(a_array[i].flag == OBJ_GRP) {
-            // ignore groups if we did them before
-            if(config.bundle_groups)
-               continue;
-         }
+      // skip hidden items and bundled groups without unpacking them
+      iter.set_filter(filter_agents_cb, this);
 
+      while(i < tot_num && iter.prev(a_array[i]))
          i++;
-      }
 
       iter.close();
    }
@@ -2707,11 +2759,10 @@ int html_output_t::all_agents_page(void)
 
    database_t::reverse_iterator<anode_t> iter = state.database.rbegin_agents("agents.visits");
 
+   iter.set_filter(filter_agents_cb, this);
+
    while(iter.prev(anode)) {
       if(anode.flag == OBJ_REG) {
-         if(config.hide_robots  && anode.robot || config.hidden_agents.isinlist(anode.string))
-            continue;
-                     
          fprintf(out_fp,"%-8" PRIu64 " %6.02f%%  <span data-xfer=\"%" PRIu64 "\">%9s</span> %6.02f%%  %8" PRIu64 " %6.02f%%  ",
              anode.count, (state.totals.t_hit==0)?0:((double)anode.count/state.totals.t_hit)*100.0,
              anode.xfer, fmt_xfer(anode.xfer, true),
@@ -2941,20 +2992,11 @@ void html_output_t::top_users_table()
    if(i < tot_num) {
       database_t::reverse_iterator<inode_t> iter = state.database.rbegin_users("users.hits");
 
-      while(i < tot_num && iter.prev(i_array[i])) {
-         if(i_array[i].flag == OBJ_REG) {
-            // ignore referrers matching any of the hiding patterns
-            if(config.hidden_users.isinlist(i_array[i].string))
-               continue;
-         }
-         else if(i_array[i].flag == OBJ_GRP) {
-            // ignore groups if we did them before
-            if(config.bundle_groups)
-               continue;
-         }
+      // skip hidden items and bundled groups without unpacking them
+      iter.set_filter(filter_users_cb, this);
 
+      while(i < tot_num && iter.prev(i_array[i]))
          i++;
-      }
 
       iter.close();
    }
@@ -3092,11 +3134,10 @@ int html_output_t::all_users_page(void)
    /* Now do individual users (if any) */
    database_t::reverse_iterator<inode_t> iter = state.database.rbegin_users("users.hits");
 
+   iter.set_filter(filter_users_cb, this);
+
    while(iter.prev(inode)) {
       if(inode.flag == OBJ_REG) {
-         if(config.hidden_users.isinlist(inode.string))
-            continue;
-         
          buffer_formatter.set_scope_mode(buffer_formatter_t::append),      
          fprintf(out_fp, "%-8" PRIu64 " %6.02f%%  %8" PRIu64 " %6.02f%%  <span data-xfer=\"%" PRIu64 "\">%8s</span> %6.02f%%  %8" PRIu64 " %6.02f%%  %12.3f  %12.3f  %s\n",
             inode.count,
@@ -95,6 +95,14 @@ class html_output_t : public output_t {
 
       bool is_safe_url(const string_t& url);
 
+      static bool is_hidden_value(const nlist& hidden, const void *data, size_t datasize, const void *field, size_t maxlen = SIZE_MAX);
+
+      static bool filter_hosts_cb(const void *data, size_t datasize, void *arg);
+      static bool filter_urls_cb(const void *data, size_t datasize, void *arg);
+      static bool filter_refs_cb(const void *data, size_t datasize, void *arg);
+      static bool filter_agents_cb(const void *data, size_t datasize, void *arg);
+      static bool filter_users_cb(const void *data, size_t datasize, void *arg);
+
    public:
       html_output_t(const config_t& config, const state_t& state);
 
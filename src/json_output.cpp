@@ -31,6 +31,8 @@
 #include "exception.h"
 #include "json_output.h"
 #include "preserve.h"
+#include "timeseries.h"
+#include "util_path.h"
 
 #include <stdexcept>
 
@@ -100,6 +102,9 @@ int json_output_t::write_monthly_report(void)
    dump_daily();
    dump_hourly();
 
+   if(!config.ts_fname.isempty())
+      dump_timeseries();
+
    dump_all_downloads();
    dump_all_urls();     
    dump_all_errors();    
@@ -394,6 +399,63 @@ void json_output_t::dump_hourly(void)
    fclose(out_fp);
 }
 
+///
+/// @brief  Writes hourly totals of the last `TS_MONTHS` months, including the current
+///         month, read from the time series file.
+///
+/// All hours are read from the time series file in a single read, without opening
+/// state databases of previous months.
+///
+void json_output_t::dump_timeseries(void)
+{
+   std::vector<timeseries_t::hour_t> hours;
+   timeseries_t timeseries(make_path(config.out_dir, config.ts_fname));
+   u_int months;
+   FILE     *out_fp;
+   string_t filename;
+   size_t count = 0;
+
+   // months since year zero for the first month in the range
+   months = state.totals.cur_tstamp.year * 12 + state.totals.cur_tstamp.month - TS_MONTHS;
+
+   if(!timeseries.read_hours(timeseries_t::make_time(months / 12, months % 12 + 1, 1, 0), timeseries_t::make_time(state.totals.cur_tstamp.year, state.totals.cur_tstamp.month, 31, 23), hours)) {
+      fprintf(stderr, "%s %s\n", config.lang.msg_tsf_rerr, make_path(config.out_dir, config.ts_fname).c_str());
+      return;
+   }
+
+   filename.format("%s/timeseries_%04d%02d.json",
+      (!config.dump_path.isempty())? config.dump_path.c_str() : ".", state.totals.cur_tstamp.year,state.totals.cur_tstamp.month);
+
+   if((out_fp = open_out_file(filename)) == nullptr) {
+      fprintf(stderr, "%s %s\n", config.lang.msg_no_open, filename.c_str());
+      return;
+   }
+
+   fputs("[\n", out_fp);
+
+   for(const timeseries_t::hour_t& hour : hours) {
+      if(count++)
+         fputs(",\n", out_fp);
+
+      fputs("{\n", out_fp);
+
+      fprintf(out_fp, "\"_id\": %u,\n", hour.time);
+
+      fprintf(out_fp, "\"year\": %u,\n\"month\": %u,\n\"day\": %u,\n\"hour\": %u,\n", hour.time / 1000000, hour.time / 10000 % 100, hour.time / 100 % 100, hour.time % 100);
+      fprintf(out_fp, "\"hits\": {\"$numberLong\": \"%" PRIu64 "\"},\n", hour.hits);
+      fprintf(out_fp, "\"files\": {\"$numberLong\": \"%" PRIu64 "\"},\n", hour.files);
+      fprintf(out_fp, "\"pages\": {\"$numberLong\": \"%" PRIu64 "\"},\n", hour.pages);
+      fprintf(out_fp, "\"visits\": {\"$numberLong\": \"%" PRIu64 "\"},\n", hour.visits);
+      fprintf(out_fp, "\"hosts\": {\"$numberLong\": \"%" PRIu64 "\"},\n", hour.hosts);
+      fprintf(out_fp, "\"xfer\": {\"$numberLong\": \"%" PRIu64 "\"}\n", hour.xfer);
+
+      fputs("}", out_fp);
+   }
+   fputs("\n]\n", out_fp);
+
+   fclose(out_fp);
+}
+
 void json_output_t::dump_all_hosts()
 {
    storable_t<hnode_t> hnode;
@@ -502,7 +564,7 @@ void json_output_t::dump_all_urls()
 
       if(config.page_titles.size()) {
          if(unode.flag == OBJ_REG)
-            title = config.page_titles.isinglist(unode.string.c_str(), unode.string.length(), false);
+            title = config.page_title_index.find_name(unode.string.c_str(), unode.string.length());
          else if(title)
             title = nullptr;
       }
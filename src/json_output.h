@@ -28,6 +28,10 @@ class database_t;
 /// @brief  JSON output
 ///
 class json_output_t : public output_t {
+   private:
+      /// The number of months of hourly totals read from the time series file.
+      static const u_int TS_MONTHS = 12;
+
    private:
       string_t::char_buffer_t buffer;
 
@@ -42,6 +46,7 @@ class json_output_t : public output_t {
       void dump_totals(void);
       void dump_daily(void);
       void dump_hourly(void);
+      void dump_timeseries(void);
 
       void dump_all_hosts(void);
       void dump_all_urls(void);
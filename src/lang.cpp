@@ -86,6 +86,7 @@
          "--end-month         end active visits and close the database", \
          "--compact-db        compact the database", \
          "--db-info           print database information", \
+         "--read-only         open the database read-only (with --prepare-report or --db-info)", \
          "--pipe-log-names    read log file names from standard input"
 
 /* short month names MUST BE 3 CHARS in size... pad if needed*/
@@ -520,6 +521,21 @@ lang_t::lang_t(void) :
    msg_file_err= "Cannot read file";
    msg_use_help= "Using XML help file";
    msg_fpos_err= "Cannot retrieve current file position for";
+   msg_snp_use = "Using state snapshot";
+   msg_snp_werr= "Cannot write the state snapshot";
+   msg_snp_rerr= "Cannot read the state snapshot";
+   msg_tsf_err = "Cannot update the time series file";
+   msg_tsf_rerr= "Cannot read the time series file";
+   msg_dbst_err= "Cannot obtain database cache statistics";
+   msg_dbc_stat= "Database cache";
+   msg_dbc_hits= "hits";
+   msg_dbc_prd = "pages read";
+   msg_dbc_pwr = "pages written";
+   msg_dbc_pev = "pages evicted";
+   msg_dbc_wset= "KB working set";
+   msg_dbc_mem = "(memory)";
+   msg_cmpt_err= "Cannot compact the database";
+   msg_prf_err = "Cannot write the profile file";
 
    /* log record errors */
    msg_big_rec = "Error: Skipping oversized log record";
@@ -797,6 +813,21 @@ void lang_t::init_lang_htab(void)
    ln_htab.emplace(string_t("msg_file_err"), &msg_file_err);
    ln_htab.emplace(string_t("msg_use_help"), &msg_use_help);
    ln_htab.emplace(string_t("msg_fpos_err"), &msg_fpos_err);
+   ln_htab.emplace(string_t("msg_snp_use"), &msg_snp_use);
+   ln_htab.emplace(string_t("msg_snp_werr"), &msg_snp_werr);
+   ln_htab.emplace(string_t("msg_snp_rerr"), &msg_snp_rerr);
+   ln_htab.emplace(string_t("msg_tsf_err"), &msg_tsf_err);
+   ln_htab.emplace(string_t("msg_tsf_rerr"), &msg_tsf_rerr);
+   ln_htab.emplace(string_t("msg_dbst_err"), &msg_dbst_err);
+   ln_htab.emplace(string_t("msg_dbc_stat"), &msg_dbc_stat);
+   ln_htab.emplace(string_t("msg_dbc_hits"), &msg_dbc_hits);
+   ln_htab.emplace(string_t("msg_dbc_prd"), &msg_dbc_prd);
+   ln_htab.emplace(string_t("msg_dbc_pwr"), &msg_dbc_pwr);
+   ln_htab.emplace(string_t("msg_dbc_pev"), &msg_dbc_pev);
+   ln_htab.emplace(string_t("msg_dbc_wset"), &msg_dbc_wset);
+   ln_htab.emplace(string_t("msg_dbc_mem"), &msg_dbc_mem);
+   ln_htab.emplace(string_t("msg_cmpt_err"), &msg_cmpt_err);
+   ln_htab.emplace(string_t("msg_prf_err"), &msg_prf_err);
 
    ln_htab.emplace(string_t("msg_log_err"), &msg_log_err);
    ln_htab.emplace(string_t("msg_log_use"), &msg_log_use);
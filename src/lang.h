@@ -176,6 +176,21 @@ class lang_t {
       const char *msg_file_err;
       const char *msg_use_help;
       const char *msg_fpos_err;
+      const char *msg_snp_use ;
+      const char *msg_snp_werr;
+      const char *msg_snp_rerr;
+      const char *msg_tsf_err ;
+      const char *msg_tsf_rerr;
+      const char *msg_dbst_err;
+      const char *msg_dbc_stat;
+      const char *msg_dbc_hits;
+      const char *msg_dbc_prd ;
+      const char *msg_dbc_pwr ;
+      const char *msg_dbc_pev ;
+      const char *msg_dbc_wset;
+      const char *msg_dbc_mem ;
+      const char *msg_cmpt_err;
+      const char *msg_prf_err ;
 
       const char *msg_log_err ;
       const char *msg_log_use ;
@@ -173,6 +173,37 @@ const string_t *glist::isinglist(const string_t& str) const
    return ((lptr = find_node(str, iter, false)) != nullptr) ? &lptr->name : nullptr;
 }
 
+bool glist::find_node_run(const string_t& str, const_iterator& first, const_iterator& last) const
+{
+   first = last = list.begin();
+
+   // find the first matching node
+   if(find_node(str, last) == nullptr) {
+      first = last = list.end();
+      return false;
+   }
+
+   first = std::prev(last);
+
+   // extend the run while the following nodes match (see find_node for next == true)
+   while(last != list.end() && isinstrex(str, last->key(), str.length(), last->key().length(), true, &last->delta_table, false))
+      last++;
+
+   return true;
+}
+
+bool glist::is_host_list(void) const
+{
+   for(const gnode_t& node : list) {
+      for(const char *cp = node.key(); *cp; cp++) {
+         if(!string_t::isalnum(*cp) && *cp != '.' && *cp != '-' && *cp != '_')
+            return false;
+      }
+   }
+
+   return true;
+}
+
 const string_t *glist::isinglist(const char *str, size_t slen, bool substr) const
 {
    const gnode_t *lptr;
@@ -199,6 +230,106 @@ void glist::for_each(const char *str, void (*cb)(const char *, void*), void *ptr
    }
 }
 
+//
+// glist_index_t
+//
+
+glist_index_t::glist_index_t(void)
+{
+   trie.push_back({nullptr, 0});
+}
+
+void glist_index_t::build(const glist& list)
+{
+   size_t order = 0;
+   const char *wildcard;
+
+   exact.clear();
+   edges.clear();
+   others.clear();
+
+   trie.clear();
+   trie.push_back({nullptr, 0});
+
+   for(const gnode_t& gnode : list) {
+      // empty patterns never match anything
+      if(!gnode.string.isempty()) {
+         wildcard = strchr(gnode.string, '*');
+
+         // keep the first node for patterns that appear more than once
+         if(wildcard == nullptr)
+            exact.emplace(gnode.string, entry_t{&gnode, order});
+         else if(wildcard == &gnode.string[gnode.string.length()-1])
+            add_prefix(gnode, order);
+         else
+            others.push_back({&gnode, order});
+      }
+
+      order++;
+   }
+}
+
+///
+/// A single asterisk is treated as an empty prefix, which matches any non-empty
+/// string, same as `isinstrex` does.
+///
+void glist_index_t::add_prefix(const gnode_t& gnode, size_t order)
+{
+   size_t node = 0;
+   edge_map_t::iterator edge;
+
+   for(size_t index = 0; index < gnode.string.length()-1; index++) {
+      if((edge = edges.find(edge_key(node, gnode.string[index]))) != edges.end())
+         node = edge->second;
+      else {
+         edges.emplace(edge_key(node, gnode.string[index]), trie.size());
+         node = trie.size();
+         trie.push_back({nullptr, 0});
+      }
+   }
+
+   if(!trie[node].gnode)
+      trie[node] = {&gnode, order};
+}
+
+const string_t *glist_index_t::find_name(const char *str, size_t slen) const
+{
+   const entry_t *match = nullptr;
+   exact_map_t::const_iterator eptr;
+   edge_map_t::const_iterator edge;
+   size_t node = 0;
+
+   if(str == nullptr || *str == 0 || slen == 0)
+      return nullptr;
+
+   if((eptr = exact.find(string_t::hold(str, slen))) != exact.end())
+      match = &eptr->second;
+
+   // check every prefix of str, starting with the empty one
+   for(size_t index = 0; ; index++) {
+      if(trie[node].gnode && (!match || trie[node].order < match->order))
+         match = &trie[node];
+
+      if(index == slen || (edge = edges.find(edge_key(node, str[index]))) == edges.end())
+         break;
+
+      node = edge->second;
+   }
+
+   // remaining patterns only need to be evaluated up to the best match so far
+   for(const entry_t& other : others) {
+      if(match && other.order > match->order)
+         break;
+
+      if(isinstrex(str, other.gnode->string, slen, other.gnode->string.length(), false, &other.gnode->delta_table, false)) {
+         match = &other;
+         break;
+      }
+   }
+
+   return match ? &match->gnode->name : nullptr;
+}
+
 //
 // Instantiate linked list templates (see comments at the end of hashtab.cpp)
 //
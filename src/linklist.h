@@ -15,8 +15,11 @@
 #include "util_string.h"
 #include "tstring.h"
 #include "types.h"
+#include "hashtab.h"
 
 #include <list>
+#include <vector>
+#include <unordered_map>
 
 ///
 /// @brief  A list node with a string pattern for matching beginning or ending of a
@@ -182,6 +185,12 @@ class glist : public base_list<gnode_t> {
       /// scan glist values case-sensitively for str as substring and return group name if found or nullptr otherwise
       const string_t *isinglist(const char *str, size_t slen, bool substr) const;
 
+      /// find the first run of consecutive nodes with patterns matching str as substring and return true if found
+      bool find_node_run(const string_t& str, const_iterator& first, const_iterator& last) const;
+
+      /// returns true if all patterns contain only host name characters and no wildcards, false otherwise
+      bool is_host_list(void) const;
+
       /// calls the callback function for each node with no name or a name (not pattern) matching str
       void for_each(const char *str, void (*cb)(const char *, void*), void *ptr = nullptr, bool nocase = false, bool delmatch = false);
 
@@ -192,4 +201,54 @@ class glist : public base_list<gnode_t> {
       bool get_has_names(void) const {return has_names;}
 };
 
+///
+/// @brief  An index of `glist` patterns for matching whole strings without scanning
+///         the entire list.
+///
+/// Patterns without asterisks are kept in a hash map and patterns with a single
+/// trailing asterisk are kept in a prefix trie, so a string can be matched against
+/// both in time proportional to its length. All other patterns, such as those with
+/// a leading asterisk, are evaluated in the list order.
+///
+/// `find_name` returns the same name as `glist::isinglist` called with `substr` set
+/// to `false`, which is the name of the first matching pattern in the list order.
+///
+/// The index references nodes of the list it was built from and must be rebuilt if
+/// the list is changed.
+///
+class glist_index_t {
+   private:
+      ///
+      /// @brief  A list node and its position in the list
+      ///
+      struct entry_t {
+         const gnode_t  *gnode;           ///< List node, or `nullptr` if there is none
+         size_t         order;            ///< Position of the node in the list
+      };
+
+      typedef std::unordered_map<string_t, entry_t, hash_string> exact_map_t;
+
+      typedef std::unordered_map<uint64_t, size_t> edge_map_t;
+
+   private:
+      exact_map_t          exact;         ///< Patterns without asterisks
+      std::vector<entry_t> trie;          ///< Prefix trie nodes, with the root at index zero
+      edge_map_t           edges;         ///< Trie edges keyed by the parent node index and a character
+      std::vector<entry_t> others;        ///< Remaining patterns, in the list order
+
+   private:
+      static uint64_t edge_key(size_t node, char chr) {return ((uint64_t) node << 8) | (u_char) chr;}
+
+      void add_prefix(const gnode_t& gnode, size_t order);
+
+   public:
+      glist_index_t(void);
+
+      /// Indexes all patterns in `list`, replacing any patterns indexed earlier.
+      void build(const glist& list);
+
+      /// Returns the name of the first pattern matching the entire `str`, or `nullptr` if there is none.
+      const string_t *find_name(const char *str, size_t slen) const;
+};
+
 #endif  // LINKLIST_H 
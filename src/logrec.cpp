@@ -11,7 +11,7 @@
 
 #include "logrec.h"
 
-log_struct::log_struct(void) : resp_code(0), xfer_size(0), proc_time(0), port(0)
+log_struct::log_struct(void) : hostname_hash(0), resp_code(0), xfer_size(0), proc_time(0), port(0)
 {
 }
 
@@ -26,6 +26,8 @@ void log_struct::reset(void)
    ident.reset();
    xsrchstr.reset();
 
+   hostname_hash = 0;
+
    tstamp.reset();
 
    resp_code = 0;
@@ -57,6 +57,8 @@ struct  log_struct  {
       string_t   ident;                ///< user identification
       string_t   xsrchstr;             ///< referrer query
 
+      uint64_t   hostname_hash;        ///< host name hash, computed once by the parser
+
       uint64_t   xfer_size;            ///< transfer size, in bytes
       uint64_t   proc_time;            ///< request processing time (ms)
 
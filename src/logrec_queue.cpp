@@ -0,0 +1,205 @@
+/*
+    webalizer - a web server log analysis program
+
+    Copyright (c) 2004-2022, Stone Steps Inc. (www.stonesteps.ca)
+
+    See COPYING and Copyright files for additional licensing and copyright information
+
+    logrec_queue.cpp
+*/
+#include "pch.h"
+
+#include "logrec_queue.h"
+
+#include <utility>
+
+logrec_queue_t::logrec_queue_t(size_t batch_count, size_t batch_size) :
+      put_batch(nullptr),
+      get_batch(nullptr),
+      get_index(0),
+      closed(false),
+      stopped(false)
+{
+   // the producer needs one batch to fill while the consumer is working on another
+   if(batch_count < 2)
+      batch_count = 2;
+
+   if(!batch_size)
+      batch_size = 1;
+
+   for(size_t i = 0; i < batch_count; i++) {
+      batches.push_back(std::make_unique<batch_t>(batch_size));
+      free_batches.push_back(batches.back().get());
+   }
+}
+
+logrec_queue_t::~logrec_queue_t(void)
+{
+   if(producer_thread.joinable()) {
+      stop();
+      producer_thread.join();
+   }
+}
+
+void logrec_queue_t::start(producer_t producer)
+{
+   producer_thread = std::thread(&logrec_queue_t::producer_thread_proc, this, std::move(producer));
+}
+
+///
+/// Runs the producer and closes the queue when the producer returns. Any exception
+/// thrown by the producer is saved for the consumer.
+///
+void logrec_queue_t::producer_thread_proc(producer_t producer)
+{
+   try {
+      producer(*this);
+      close(nullptr);
+   }
+   catch (...) {
+      close(std::current_exception());
+   }
+}
+
+///
+/// Queues the current producer batch. Returns `false` if the consumer stopped,
+/// in which case the batch is discarded.
+///
+bool logrec_queue_t::push_batch(void)
+{
+   {
+      std::lock_guard<std::mutex> lock(queue_mtx);
+
+      if(stopped)
+         return false;
+
+      ready_batches.push_back(put_batch);
+      put_batch = nullptr;
+   }
+
+   ready_cv.notify_one();
+
+   return true;
+}
+
+///
+/// The log record is swapped with a log record in the producer batch, so the
+/// caller gets back a log record from an earlier batch, which should be reset
+/// before it is used. If all batches are in use, waits until the consumer
+/// releases one.
+///
+bool logrec_queue_t::push_logrec(log_struct& logrec)
+{
+   if(!put_batch) {
+      std::unique_lock<std::mutex> lock(queue_mtx);
+
+      free_cv.wait(lock, [this] {return stopped || !free_batches.empty();});
+
+      if(stopped)
+         return false;
+
+      put_batch = free_batches.back();
+      free_batches.pop_back();
+   }
+
+   std::swap(logrec, put_batch->logrecs[put_batch->count++]);
+
+   // queue the batch when it's full
+   if(put_batch->count == put_batch->logrecs.size())
+      return push_batch();
+
+   return true;
+}
+
+void logrec_queue_t::close(std::exception_ptr error)
+{
+   // queue a partial batch
+   if(put_batch && put_batch->count)
+      push_batch();
+
+   {
+      std::lock_guard<std::mutex> lock(queue_mtx);
+
+      // return an empty or a discarded batch to the free list
+      if(put_batch) {
+         put_batch->count = 0;
+         free_batches.push_back(put_batch);
+         put_batch = nullptr;
+      }
+
+      this->error = error;
+      closed = true;
+   }
+
+   ready_cv.notify_one();
+}
+
+///
+/// The returned log record remains valid until the next call to `next_logrec`
+/// or `stop`. If the producer closed the queue with an error, the producer
+/// exception is thrown after all queued log records have been returned.
+///
+log_struct *logrec_queue_t::next_logrec(void)
+{
+   std::exception_ptr except;
+
+   if(get_batch && get_index < get_batch->count)
+      return &get_batch->logrecs[get_index++];
+
+   {
+      std::unique_lock<std::mutex> lock(queue_mtx);
+
+      // return the consumed batch to the producer
+      if(get_batch) {
+         get_batch->count = 0;
+         free_batches.push_back(get_batch);
+         get_batch = nullptr;
+         free_cv.notify_one();
+      }
+
+      ready_cv.wait(lock, [this] {return closed || !ready_batches.empty();});
+
+      if(!ready_batches.empty()) {
+         get_batch = ready_batches.front();
+         ready_batches.pop_front();
+         get_index = 0;
+      }
+      else
+         std::swap(except, error);
+   }
+
+   if(except)
+      std::rethrow_exception(except);
+
+   if(!get_batch)
+      return nullptr;
+
+   return &get_batch->logrecs[get_index++];
+}
+
+///
+/// After this call the producer will fail to push any log records and should
+/// return. Any queued log records are discarded.
+///
+void logrec_queue_t::stop(void)
+{
+   {
+      std::lock_guard<std::mutex> lock(queue_mtx);
+
+      if(get_batch) {
+         get_batch->count = 0;
+         free_batches.push_back(get_batch);
+         get_batch = nullptr;
+      }
+
+      while(!ready_batches.empty()) {
+         ready_batches.front()->count = 0;
+         free_batches.push_back(ready_batches.front());
+         ready_batches.pop_front();
+      }
+
+      stopped = true;
+   }
+
+   free_cv.notify_all();
+}
@@ -0,0 +1,106 @@
+/*
+    webalizer - a web server log analysis program
+
+    Copyright (c) 2004-2022, Stone Steps Inc. (www.stonesteps.ca)
+
+    See COPYING and Copyright files for additional licensing and copyright information
+
+    logrec_queue.h
+*/
+#ifndef LOGREC_QUEUE_H
+#define LOGREC_QUEUE_H
+
+#include "logrec.h"
+
+#include <vector>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <functional>
+#include <exception>
+
+///
+/// @brief  A bounded queue that passes parsed log records from the thread
+///         reading log files to the thread aggregating log records.
+///
+/// Log records are passed in batches to keep locking overhead low. A fixed
+/// number of batches is allocated up front and batches are recycled between
+/// the producer and the consumer, so string buffers in log records are reused
+/// after the first few batches and the reader thread cannot get more than a
+/// few batches ahead of the consumer.
+///
+/// Log records are moved into the queue by swapping them with the records in
+/// a free batch, which makes the log record passed into `push_logrec` reusable
+/// by the parser without allocating new string buffers.
+///
+/// The producer runs in a thread owned by the queue. If the producer throws an
+/// exception, it will be rethrown from `next_logrec` after all queued log records
+/// have been consumed. The queue stops the producer and waits for the thread to
+/// finish when it is destroyed, so the consumer may leave the queue at any point,
+/// including when an exception is thrown while log records are being processed.
+///
+class logrec_queue_t {
+   public:
+      /// Reads log records and passes them to `push_logrec` until it returns `false`.
+      typedef std::function<void(logrec_queue_t& logrec_queue)> producer_t;
+
+   private:
+      ///
+      /// @brief  A batch of log records
+      ///
+      struct batch_t {
+         std::vector<log_struct> logrecs;    ///< Log records; only the first `count` are valid
+         size_t                  count;      ///< Number of log records in this batch
+
+         batch_t(size_t batch_size) : logrecs(batch_size), count(0) {}
+      };
+
+   private:
+      std::mutex              queue_mtx;     ///< Protects all batch lists and flags
+      std::condition_variable ready_cv;      ///< Signaled when a batch is ready or the queue is closed
+      std::condition_variable free_cv;       ///< Signaled when a batch is released or the queue is stopped
+
+      std::vector<std::unique_ptr<batch_t>> batches;  ///< Owns all batches
+
+      std::deque<batch_t*>    ready_batches; ///< Batches filled by the producer, in log record order
+      std::vector<batch_t*>   free_batches;  ///< Batches available to the producer
+
+      batch_t                 *put_batch;    ///< Batch being filled by the producer
+      batch_t                 *get_batch;    ///< Batch being consumed by the consumer
+      size_t                  get_index;     ///< Next log record index in `get_batch`
+
+      bool                    closed;        ///< The producer will not push any more log records
+      bool                    stopped;       ///< The consumer will not take any more log records
+
+      std::exception_ptr      error;         ///< A producer exception to be rethrown for the consumer
+
+      std::thread             producer_thread;  ///< Runs the producer
+
+   private:
+      bool push_batch(void);
+
+      void close(std::exception_ptr error);
+
+      void producer_thread_proc(producer_t producer);
+
+   public:
+      logrec_queue_t(size_t batch_count, size_t batch_size);
+
+      ~logrec_queue_t(void);
+
+      /// Starts a thread running the producer.
+      void start(producer_t producer);
+
+      /// Moves the log record into the queue. Returns `false` if the consumer stopped.
+      bool push_logrec(log_struct& logrec);
+
+      /// Returns the next log record or a null pointer at the end of data.
+      log_struct *next_logrec(void);
+
+      /// Releases all batches and tells the producer to stop.
+      void stop(void);
+};
+
+#endif // LOGREC_QUEUE_H
@@ -20,6 +20,7 @@
 #include "unicode.h"
 #include "util_url.h"
 #include "util_time.h"
+#include "hnode.h"
 
 #include <vector>
 
@@ -214,6 +215,9 @@ bool parser_t::fmt_logrec(char *buffer, bool noparen, bool noquotes, bool bsesc,
 // 0123456789012345678901234567
 // [07/Dec/2004:21:30:21 -0500]
 //
+// The date part is 13 characters long and the UTC offset part is 7 characters 
+// long, which includes the separating space and the closing bracket.
+//
 bool parser_t::parse_clf_tstamp(const char *dt, tstamp_t& ts)
 {
    int offset; // UTC offset (+/-hhmm)
@@ -225,6 +229,26 @@ bool parser_t::parse_clf_tstamp(const char *dt, tstamp_t& ts)
    if(dt[0] != '[' || dt[27] != ']' || dt[28] != 0)
       return false;
 
+   // same time stamp as in the previous log record
+   if(clf_tscache.match(dt, 28)) {
+      ts = clf_tscache.tstamp;
+      return true;
+   }
+
+   // same date and UTC offset, so just parse the time
+   if(clf_tscache.match_date(dt, 28)) {
+      const tstamp_t& cts = clf_tscache.tstamp;
+
+      ts.reset(cts.year, cts.month, cts.day, atoi(&dt[13]), atoi(&dt[16]), atoi(&dt[19]), cts.offset);
+
+      if(ts.hour > 23 || ts.min > 59 || ts.sec > 59)
+         return false;
+
+      clf_tscache.update(dt, 28, 13, 7, ts);
+
+      return true;
+   }
+
    month = 0;
 
    for(int index = 0; index < 12; index++) {
@@ -244,6 +268,8 @@ bool parser_t::parse_clf_tstamp(const char *dt, tstamp_t& ts)
 
    if(ts.year < 1900 || ts.month > 12 || ts.hour > 23 || ts.min > 59 || ts.sec > 59)
       return false;
+
+   clf_tscache.update(dt, 28, 13, 7, ts);
    
    return true;
 }
@@ -379,6 +405,9 @@ int parser_t::parse_record(char *buffer, size_t reclen, log_struct& log_rec)
 
       // convert possible host names and IPv6 addresses to lower case
       log_rec.hostname.tolower();
+
+      // hash the host name while it's in cache, so it's not hashed again for every lookup
+      log_rec.hostname_hash = hnode_t::hash_key(log_rec.hostname);
    }
 
    return retval;
@@ -985,12 +1014,24 @@ int parser_t::parse_record_w3c(char *buffer, size_t reclen, log_struct& log_rec,
 
       switch (log_rec_fields[fldindex]) {
          case eDate:
-            // <date>  = 4<digit> "-" 2<digit> "-" 2<digit>
-            year = (u_int) str2ul(cp1, &cp1);
-            if(!cp1 || *cp1++ != '-') return PARSE_CODE_ERROR;
-            month = (u_int) str2ul(cp1, &cp1);
-            if(!cp1 || *cp1++ != '-') return PARSE_CODE_ERROR;
-            day = (u_int) str2ul(cp1);
+            // dates rarely change between log records, so reuse the last one, if it's the same
+            if(w3c_datecache.match(cp1, slen)) {
+               year = w3c_datecache.tstamp.year;
+               month = w3c_datecache.tstamp.month;
+               day = w3c_datecache.tstamp.day;
+            }
+            else {
+               const char *date = cp1;
+
+               // <date>  = 4<digit> "-" 2<digit> "-" 2<digit>
+               year = (u_int) str2ul(cp1, &cp1);
+               if(!cp1 || *cp1++ != '-') return PARSE_CODE_ERROR;
+               month = (u_int) str2ul(cp1, &cp1);
+               if(!cp1 || *cp1++ != '-') return PARSE_CODE_ERROR;
+               day = (u_int) str2ul(cp1);
+
+               w3c_datecache.update(date, slen, slen, 0, tstamp_t(year, month, day, 0, 0, 0));
+            }
             tsdate = true;
             break;
 
@@ -1268,6 +1309,8 @@ int parser_t::parse_record_nginx(char *buffer, size_t reclen, log_struct& log_re
    size_t slen;
    size_t fldindex = 0, fieldcnt;
    const char *cp1;
+   const char *tstamp;
+   size_t date_len, zone_len;
    u_int year = 0, month = 0, day = 0, hour = 0, min = 0, sec = 0, offset = 0;
 
    if(!buffer || !*buffer)
@@ -1304,6 +1347,38 @@ int parser_t::parse_record_nginx(char *buffer, size_t reclen, log_struct& log_re
             // 2022-06-25T21:13:03+00:00
             // 2022-06-25T12:24:17-04:00
             //
+            // Time stamps in consecutive log records are often the same 
+            // and nearly always have the same date and UTC offset, which
+            // are reused from the previous log record, if they match.
+            //
+            if(iso_tscache.match(cp1, slen)) {
+               log_rec.tstamp = iso_tscache.tstamp;
+               break;
+            }
+
+            if(iso_tscache.match_date(cp1, slen)) {
+               const tstamp_t& cts = iso_tscache.tstamp;
+               const char *tsstr = cp1;
+
+               cp1 += iso_tscache.date_len;
+
+               hour = (u_int) str2ul(cp1, &cp1);
+               if(!cp1 || *cp1++ != ':') return PARSE_CODE_ERROR;
+               min = (u_int) str2ul(cp1, &cp1);
+               if(!cp1 || *cp1++ != ':') return PARSE_CODE_ERROR;
+               sec = (u_int) str2ul(cp1, &cp1);
+
+               // seconds must be followed by the cached UTC offset
+               if(!cp1 || cp1 != tsstr + slen - iso_tscache.zone_len) return PARSE_CODE_ERROR;
+
+               log_rec.tstamp.reset(cts.year, cts.month, cts.day, hour, min, sec, cts.offset);
+
+               iso_tscache.update(tsstr, slen, iso_tscache.date_len, iso_tscache.zone_len, log_rec.tstamp);
+               break;
+            }
+
+            tstamp = cp1;
+
             year = (u_int) str2ul(cp1, &cp1);
             if(!cp1 || *cp1++ != '-') return PARSE_CODE_ERROR;
             month = (u_int) str2ul(cp1, &cp1);
@@ -1312,18 +1387,26 @@ int parser_t::parse_record_nginx(char *buffer, size_t reclen, log_struct& log_re
 
             if(!cp1 || *cp1++ != 'T') return PARSE_CODE_ERROR;
 
+            date_len = cp1 - tstamp;
+
             hour = (u_int) str2ul(cp1, &cp1);
             if(!cp1 || *cp1++ != ':') return PARSE_CODE_ERROR;
             min = (u_int) str2ul(cp1, &cp1);
             if(!cp1 || *cp1++ != ':') return PARSE_CODE_ERROR;
             sec = (u_int) str2ul(cp1, &cp1);
 
-            if(!cp1 || (*cp1++ != '-' && *cp1++ != '+')) return PARSE_CODE_ERROR;
+            if(!cp1) return PARSE_CODE_ERROR;
+
+            zone_len = slen - (cp1 - tstamp);
+
+            if(*cp1++ != '-' && *cp1++ != '+') return PARSE_CODE_ERROR;
             offset = (u_int) str2ul(cp1, &cp1) * 60;
             if(!cp1 || (*cp1++ != ':')) return PARSE_CODE_ERROR;
             offset += (u_int) str2ul(cp1, &cp1);
 
             log_rec.tstamp.reset(year, month, day, hour, min, sec, offset);
+
+            iso_tscache.update(tstamp, slen, date_len, zone_len, log_rec.tstamp);
             break;
          case eClfTime:
             // [25/Jun/2022:12:24:17 -0400]
@@ -15,8 +15,10 @@
 #include <cstdlib>
 
 #include "config.h"
+#include "tstamp.h"
 
 #include <vector>
+#include <cstring>
 
 /* Parse codes */
 #define PARSE_CODE_ERROR      0
@@ -83,6 +85,55 @@ class parser_t {
 
       static constexpr u_int SQUID_FIELD_COUNT = 10;
 
+      ///
+      /// @brief  Time stamp text of the last parsed log record and its value
+      ///
+      /// Consecutive log records often have the same time stamp and nearly always
+      /// have the same date and UTC offset, so time stamp text is compared against
+      /// the one in the previous log record and only the time part is parsed if
+      /// just the time changed. The date part is the leading `date_len` characters
+      /// and the UTC offset part is the trailing `zone_len` characters of the time
+      /// stamp text.
+      ///
+      struct tstamp_cache_t {
+         static const size_t TEXT_SIZE = 32;
+
+         char        text[TEXT_SIZE];  ///< Time stamp text (not null-terminated)
+         size_t      length;           ///< Length of the time stamp text or zero if the cache is empty
+         size_t      date_len;         ///< Length of the date part
+         size_t      zone_len;         ///< Length of the UTC offset part
+         tstamp_t    tstamp;           ///< Time stamp parsed from `text`
+
+         public:
+            tstamp_cache_t(void) : length(0), date_len(0), zone_len(0) {}
+
+            /// Returns `true` if `str` is the same as the cached time stamp text.
+            bool match(const char *str, size_t slen) const
+            {
+               return slen == length && !memcmp(text, str, slen);
+            }
+
+            /// Returns `true` if `str` has the same date and UTC offset as the cached time stamp text.
+            bool match_date(const char *str, size_t slen) const
+            {
+               return slen == length && !memcmp(text, str, date_len) && !memcmp(text + length - zone_len, str + slen - zone_len, zone_len);
+            }
+
+            /// Caches time stamp text and its parsed value.
+            void update(const char *str, size_t slen, size_t date_len, size_t zone_len, const tstamp_t& tstamp)
+            {
+               if(slen > TEXT_SIZE)
+                  length = 0;
+               else {
+                  memcpy(text, str, slen);
+                  length = slen;
+                  this->date_len = date_len;
+                  this->zone_len = zone_len;
+                  this->tstamp = tstamp;
+               }
+            }
+      };
+
    private:
       const config_t& config;
 
@@ -92,6 +143,10 @@ class parser_t {
 
       tstamp_t iis_tstamp;
 
+      tstamp_cache_t clf_tscache;      ///< Last CLF time stamp (Apache, CLF and Nginx)
+      tstamp_cache_t iso_tscache;      ///< Last ISO-8601 local time stamp (Nginx)
+      tstamp_cache_t w3c_datecache;    ///< Last W3C date field
+
       static const char *log_month[12];
 
    private:
@@ -27,6 +27,8 @@
 #include "lang.h"
 #include "exception.h"
 #include "history.h"
+#include "snapshot.h"
+#include "timeseries.h"
 
 #include <ctime>
 #include <cstdio>
@@ -35,11 +37,15 @@
 #include <cctype>
 #include <memory>
 #include <algorithm>
+#include <future>
+#include <random>
 
 state_t::state_t(const config_t& config, end_visit_cb_t end_visit_cb, end_download_cb_t end_download_cb, void *end_cb_arg) : 
-   config(config), history(config), database(config),
+   config(config), visit_timers(config.visit_timeout), download_timers(config.download_timeout), history(config), database(config),
+   db_name(config.get_db_name()), db_path(config.get_db_path()), closed_month(false),
    end_visit_cb(end_visit_cb), end_download_cb(end_download_cb), end_cb_arg(end_cb_arg),
-   cleared_htabs{&dl_htab, &hm_htab, &um_htab, &rm_htab, &am_htab, &sr_htab, &im_htab, &rc_htab, &ct_htab, &as_htab}
+   cleared_htabs{&dl_htab, &hm_htab, &um_htab, &rm_htab, &am_htab, &sr_htab, &im_htab, &rc_htab, &ct_htab, &as_htab},
+   swapped_htabs{&dl_htab, &hm_htab, &um_htab, &rm_htab, &am_htab, &sr_htab, &im_htab}
 {
    buffer = new char[BUFSIZE];
 
@@ -47,6 +53,23 @@ state_t::state_t(const config_t& config, end_visit_cb_t end_visit_cb, end_downlo
    dl_ended.reserve(128); 
 }
 
+///
+/// A state of a closed month is only used to generate a report from the database 
+/// file that was renamed by `rollover_database`, which no other state accesses, so 
+/// the report may be generated on a separate thread while log files are processed
+/// into the new database. Only totals, countries, cities and ASN entries are loaded
+/// into memory and active visits and downloads are not tracked.
+///
+state_t::state_t(const config_t& config, const string_t& db_name) : 
+   config(config), visit_timers(config.visit_timeout), download_timers(config.download_timeout), history(config), database(config, db_name),
+   db_name(db_name), db_path(make_path(config.db_path, db_name)), closed_month(true),
+   end_visit_cb(nullptr), end_download_cb(nullptr), end_cb_arg(nullptr),
+   cleared_htabs{&dl_htab, &hm_htab, &um_htab, &rm_htab, &am_htab, &sr_htab, &im_htab, &rc_htab, &ct_htab, &as_htab},
+   swapped_htabs{&dl_htab, &hm_htab, &um_htab, &rm_htab, &am_htab, &sr_htab, &im_htab}
+{
+   buffer = new char[BUFSIZE];
+}
+
 state_t::~state_t(void)
 {
    //
@@ -101,6 +124,19 @@ bool state_t::eval_unode_cb(const unode_t *unode, void *arg)
    return (unode->vstref) == 0;
 }
 
+///
+/// @brief  Orders swapped out nodes by their node IDs.
+///
+/// Node IDs are primary keys in the database and storing nodes in the key order
+/// makes consecutive writes land on the same B-tree leaf pages, which are likely
+/// to be in the database cache, instead of updating random pages.
+///
+template <typename node_t>
+bool state_t::swap_out_order_cb(const node_t *node1, const node_t *node2)
+{
+   return node1->nodeid < node2->nodeid;
+}
+
 ///
 /// @brief  Stores a node without any special dependency considerations in
 ///         the database.
@@ -190,14 +226,82 @@ void state_t::swap_out_node_cb<dlnode_t, &database_t::put_dlnode>(storable_t<dln
    }
 }
 
+///
+/// @brief  Measures the database cache working set for this run and reports cache
+///         statistics, if requested.
+///
+/// The working set is measured as the size of all pages read into or created in the
+/// cache. Pages that were evicted and read again are counted more than once, which
+/// makes the working set larger than the cache when the cache is too small.
+///
+void state_t::update_cache_stats(void)
+{
+   database_t::cache_stats_t envstats;
+   std::vector<database_t::cache_stats_t> filestats;
+   database_t::status_t status;
+   uint64_t wset = 0;
+
+   if(!(status = database.get_cache_stats(envstats, filestats)).success()) {
+      fprintf(stderr, "%s (%s)\n", config.lang.msg_dbst_err, status.err_msg().c_str());
+      return;
+   }
+
+   for(const database_t::cache_stats_t& stats : filestats)
+      wset += (stats.pages_in + stats.pages_created) * stats.pagesize;
+
+   sysnode.cache_wset = wset;
+
+   if(config.verbose > 1) {
+      printf("%s: %.2f%% %s (%" PRIu64 "/%" PRIu64 "), %" PRIu64 " %s, %" PRIu64 " %s, %" PRIu64 " %s, %" PRIu64 " %s\n", 
+               config.lang.msg_dbc_stat, envstats.hit_rate(), config.lang.msg_dbc_hits, envstats.hits, envstats.hits + envstats.misses, 
+               envstats.pages_in, config.lang.msg_dbc_prd, envstats.pages_out, config.lang.msg_dbc_pwr, envstats.evictions, config.lang.msg_dbc_pev, 
+               wset / 1024, config.lang.msg_dbc_wset);
+
+      for(const database_t::cache_stats_t& stats : filestats) {
+         printf("   %s: %.2f%% %s (%" PRIu64 "/%" PRIu64 "), %" PRIu64 " %s, %" PRIu64 " %s\n", 
+               !stats.file_name.isempty() ? stats.file_name.c_str() : config.lang.msg_dbc_mem, stats.hit_rate(), config.lang.msg_dbc_hits, stats.hits, stats.hits + stats.misses, 
+               stats.pages_in, config.lang.msg_dbc_prd, stats.pages_out, config.lang.msg_dbc_pwr);
+      }
+   }
+}
+
+///
+/// @brief  Compacts some of the database pages, starting where compaction stopped
+///         in the previous run.
+///
+/// Compaction errors are reported, but are not considered fatal because compaction
+/// doesn't change any of the data in the database.
+///
+void state_t::compact_database(void)
+{
+   database_t::status_t status;
+   u_int bytes;
+
+   if(!(status = database.compact(config.db_compact_pages, sysnode.compact_table, sysnode.compact_key, bytes)).success()) {
+      fprintf(stderr, "%s (%s)\n", config.lang.msg_cmpt_err, status.err_msg().c_str());
+      return;
+   }
+
+   // save the position at which the next run will continue
+   if(!database.put_sysnode(sysnode, sysnode.storage_info))
+      throw exception_t(0, string_t::_format("%s (system node)", config.lang.msg_data_err));
+
+   if(config.verbose > 1)
+      printf("%s: %d KB\n", config.lang.msg_cmpctdb, bytes / 1024);
+}
+
 ///
 /// @brief  Saves the current monthly state to the database.
 ///
 /// This method may report progress messages to the standard output stream and will throw
 /// an instance of `exception_t` in case of an error. If an exception is thrown, the state
-/// will become corrupt and cannot be recovered because there is no transaction support in
-/// the current implementation and there is no way to rollback partially-saved data, even
-/// if Berkeley DB manages to save its state.
+/// will become corrupt and cannot be recovered, unless database transactions are enabled.
+///
+/// With transactions enabled, all updates are written in a single transaction, which is
+/// aborted when the database is closed after an error, or rolled back by recovery if the
+/// process terminates before the transaction is committed. Only updates made by this
+/// method are undone in this case. Nodes swapped out earlier in this run were committed
+/// as they were written and remain in the database.
 ///
 void state_t::save_state(void)
 {
@@ -210,6 +314,8 @@ void state_t::save_state(void)
    vnode_t vnode;
    dlnode_t dlnode;
 
+   database_t::status_t status;
+
    /* Saving current run data... */
    if (config.verbose>1)
    {
@@ -231,8 +337,27 @@ void state_t::save_state(void)
    if(!config.is_maintenance()) {
       sysnode.incremental = config.incremental;
       sysnode.batch = config.batch;
+
+      update_cache_stats();
+   }
+
+   //
+   // A new checkpoint ties the snapshot written below to this state of the database.
+   // Saving the system node without a checkpoint invalidates any existing snapshot.
+   //
+   sysnode.checkpoint = 0;
+
+   if(is_snapshot_enabled()) {
+      std::random_device rdev;
+
+      while(!sysnode.checkpoint)
+         sysnode.checkpoint = ((uint64_t) rdev() << 32) | rdev();
    }
 
+   // write all updates below in a single transaction, if transactions are enabled
+   if(!(status = database.begin_transaction(true)).success())
+      throw exception_t(0, string_t::_format("Cannot begin a database transaction (%s)", status.err_msg().c_str()));
+
    if(!database.put_sysnode(sysnode, sysnode.storage_info)) {
       throw exception_t(0, string_t::_format("%s (system node)", config.lang.msg_data_err));
    }
@@ -338,7 +463,6 @@ void state_t::save_state(void)
             throw exception_t(0, string_t::_format("%s (downloads)", config.lang.msg_data_err));
       }
    }
-   dl_htab.clear();
 
    // monthly hosts
    hash_table<storable_t<hnode_t>>::iterator h_iter = hm_htab.begin();
@@ -355,7 +479,6 @@ void state_t::save_state(void)
             throw exception_t(0, string_t::_format("%s (hosts)", config.lang.msg_data_err));
       }
    }
-   hm_htab.clear();
 
    /* URL list */
    hash_table<storable_t<unode_t>>::iterator u_iter = um_htab.begin();
@@ -366,8 +489,19 @@ void state_t::save_state(void)
             throw exception_t(0, string_t::_format("%s (urls)", config.lang.msg_data_err));
       }
    }
+
+   // all nodes referenced by active visits and downloads have been saved at this point
+   if(sysnode.checkpoint)
+      save_snapshot();
+
+   // clear in the dependency order described above
+   dl_htab.clear();
+   hm_htab.clear();
    um_htab.clear();
 
+   download_timers.clear();
+   visit_timers.clear();
+
    /* Referrer list */
    if (totals.t_ref != 0) {
       hash_table<storable_t<rnode_t>>::iterator r_iter = rm_htab.begin();
@@ -427,6 +561,16 @@ void state_t::save_state(void)
    }
    rc_htab.clear();
 
+   // all swapped out hash tables are empty, so forget any watermark raised by swap-outs
+   htab_memwatch.set_watermark(config.db_cache_size);
+
+   if(!(status = database.commit_transaction()).success())
+      throw exception_t(0, string_t::_format("Cannot commit a database transaction (%s)", status.err_msg().c_str()));
+
+   // reclaim some of the pages freed by deleted records, if requested
+   if(config.db_compact_pages && !config.is_maintenance())
+      compact_database();
+
    //
    // Update history for the current month. If the history file was missing, 
    // a new one will be created with this data. 
@@ -436,6 +580,29 @@ void state_t::save_state(void)
    // put_history will report the error
    if(!history.put_history())
       throw exception_t(0, string_t::_format("%s (history)", config.lang.msg_data_err));
+
+   // append hours completed since the last save to the time series file, if requested
+   if(!config.ts_fname.isempty())
+      update_timeseries();
+}
+
+///
+/// @brief  Appends totals of hours completed since the state was last saved to the
+///         time series file.
+///
+/// The hour in progress is kept in the totals node and is appended after a log record
+/// from a later hour is processed or the month ends. The time series file is not needed
+/// to process logs or to generate reports, so write errors are reported as warnings and
+/// completed hours are kept for the next attempt.
+///
+void state_t::update_timeseries(void)
+{
+   timeseries_t timeseries(make_path(config.out_dir, config.ts_fname));
+
+   if(!timeseries.append_hours(ts_hours))
+      fprintf(stderr, "%s %s\n", config.lang.msg_tsf_err, make_path(config.out_dir, config.ts_fname).c_str());
+   else
+      ts_hours.clear();
 }
 
 ///
@@ -457,19 +624,19 @@ bool state_t::initialize(void)
    
    if(config.is_maintenance()) {
       // make sure database exists, so database_t::open doesn't create an empty one
-      if(access(config.get_db_path(), F_OK)) {
-         fprintf(stderr, "%s: %s\n", config.lang.msg_nofile, config.get_db_path().c_str());
+      if(access(db_path, F_OK)) {
+         fprintf(stderr, "%s: %s\n", config.lang.msg_nofile, db_path.c_str());
          return false;
       }
    }
 
    database_t::status_t status;
-   system_database_t sysdb(config);
+   std::unique_ptr<system_database_t> sysdb(closed_month ? new system_database_t(config, db_name) : new system_database_t(config));
 
-   if(!(status = sysdb.open()).success()) {
+   if(!(status = sysdb->open()).success()) {
       // report any errors except that the database file does not exist
       if(status.err_num() != ENOENT) {
-         fprintf(stderr, "Cannot open the sysdb %s (%s)", config.get_db_path().c_str(), status.err_msg().c_str());
+         fprintf(stderr, "Cannot open the sysdb %s (%s)", db_path.c_str(), status.err_msg().c_str());
          return false;
       }
    }
@@ -478,7 +645,7 @@ bool state_t::initialize(void)
       // If there is a system node, check if we have anything to do, given state of 
       // the database and current run parameters.
       //
-      if(sysdb.get_sysnode_by_id(sysnode, nullptr)) {
+      if(sysdb->get_sysnode_by_id(sysnode, nullptr)) {
          // cannot read any data if byte order isn' t the same
          if(!sysnode.check_byte_order())
             throw exception_t(0, "Incompatible database format (byte order)");
@@ -508,32 +675,40 @@ bool state_t::initialize(void)
             throw exception_t(0, "Incompatible database format (time settings)");
 
          // upgrade older databases to make them compatible with the latest version
-         if(sysnode.appver && sysnode.appver_last != VERSION && !config.db_info)
-            upgrade_database(sysnode, sysdb);
+         if(sysnode.appver && sysnode.appver_last != VERSION && !config.db_info) {
+            if(config.db_read_only)
+               throw exception_t(0, string_t::_format("Cannot upgrade a database opened read-only (%s)", state_t::get_version(sysnode.appver_last).c_str()));
+
+            upgrade_database(sysnode, *sysdb);
+         }
       }
 
       // make sure the database base is closed properly to ensure schema upgrades
-      if(!(status = sysdb.close()).success()) {
-         fprintf(stderr, "Cannot close the database %s (%s)", config.get_db_path().c_str(), status.err_msg().c_str());
+      if(!(status = sysdb->close()).success()) {
+         fprintf(stderr, "Cannot close the database %s (%s)", db_path.c_str(), status.err_msg().c_str());
          return false;
       }
    }
 
    // set up background writing for log processing
-   if(!config.is_maintenance()) {
+   if(!config.is_maintenance() && !closed_month) {
       // enable trickling for log processing
       database.set_trickle(true);
    }
 
+   // size the cache for the working set measured in the last run, if requested (reports don't need it)
+   if(config.db_cache_auto && sysnode.cache_wset && !closed_month)
+      database.set_cache_size(config.get_auto_db_cache_size(sysnode.cache_wset));
+
    // open the full state database (sysnode is already up to date)
    if(!(status = database.open()).success()) {
-      fprintf(stderr, "Cannot open the database %s (%s)", config.get_db_path().c_str(), status.err_msg().c_str());
+      fprintf(stderr, "Cannot open the database %s (%s)", db_path.c_str(), status.err_msg().c_str());
       return false;
    }
 
    // report which database was opened
    if(config.verbose > 1)
-      printf("%s %s\n", config.lang.msg_use_db, config.get_db_path().c_str());
+      printf("%s %s\n", config.lang.msg_use_db, db_path.c_str());
 
    // no need to initialize the rest if we just need database information
    if(config.db_info)
@@ -542,9 +717,13 @@ bool state_t::initialize(void)
    // nothing to do if just compacting the database or printing information
    if(!config.compact_db && !config.db_info) {
       // attach indexes to generate a report or to end the current month
-      if(config.prep_report || config.end_month) {
-         // if the last run was in the batch mode, rebuild indexes
-         if(!(status = database.attach_indexes(sysnode.batch ? true : false)).success())
+      if(config.prep_report || config.end_month || closed_month) {
+         // indexes cannot be rebuilt in a database opened read-only
+         if(sysnode.batch && config.db_read_only)
+            throw exception_t(0, "Cannot rebuild indexes of a database opened read-only (the last run was in the batch mode)");
+
+         // if the last run was in the batch mode or the month was just closed, rebuild indexes
+         if(!(status = database.attach_indexes(sysnode.batch || closed_month)).success())
             throw exception_t(0, string_t::_format("Cannot activate secondary database indexes (%s)", status.err_msg().c_str()));
       }
       else {
@@ -586,13 +765,16 @@ bool state_t::initialize(void)
    // initalize counters and hash tables
    init_counters();                      
 
-   dl_htab.set_swap_out_cb(&swap_out_node_cb<dlnode_t, &database_t::put_dlnode>, this);
-   hm_htab.set_swap_out_cb(&swap_out_node_cb<hnode_t, &database_t::put_hnode>, this, eval_hnode_cb);
-   um_htab.set_swap_out_cb(&swap_out_node_cb<unode_t, &database_t::put_unode>, this, eval_unode_cb);
-   rm_htab.set_swap_out_cb(&swap_out_node_cb<rnode_t, &database_t::put_rnode>, this);
-   am_htab.set_swap_out_cb(&swap_out_node_cb<anode_t, &database_t::put_anode>, this);
-   sr_htab.set_swap_out_cb(&swap_out_node_cb<snode_t, &database_t::put_snode>, this);
-   im_htab.set_swap_out_cb(&swap_out_node_cb<inode_t, &database_t::put_inode>, this);
+   dl_htab.set_swap_out_cb(&swap_out_node_cb<dlnode_t, &database_t::put_dlnode>, this, nullptr, &swap_out_order_cb<dlnode_t>);
+   hm_htab.set_swap_out_cb(&swap_out_node_cb<hnode_t, &database_t::put_hnode>, this, eval_hnode_cb, &swap_out_order_cb<hnode_t>);
+   um_htab.set_swap_out_cb(&swap_out_node_cb<unode_t, &database_t::put_unode>, this, eval_unode_cb, &swap_out_order_cb<unode_t>);
+   rm_htab.set_swap_out_cb(&swap_out_node_cb<rnode_t, &database_t::put_rnode>, this, nullptr, &swap_out_order_cb<rnode_t>);
+   am_htab.set_swap_out_cb(&swap_out_node_cb<anode_t, &database_t::put_anode>, this, nullptr, &swap_out_order_cb<anode_t>);
+   sr_htab.set_swap_out_cb(&swap_out_node_cb<snode_t, &database_t::put_snode>, this, nullptr, &swap_out_order_cb<snode_t>);
+   im_htab.set_swap_out_cb(&swap_out_node_cb<inode_t, &database_t::put_inode>, this, nullptr, &swap_out_order_cb<inode_t>);
+
+   for(hash_table_base *htab : swapped_htabs)
+      htab->set_memwatch(&htab_memwatch);
 
    return true;
 }
@@ -719,6 +901,20 @@ void state_t::restore_state(void)
       database.get_scnode_by_id(response[i]);
    }
 
+   //
+   // If there is no record of the current month, set the initial history using 
+   // values from the state database.
+   //
+   if(!history.find_month(totals.cur_tstamp.year, totals.cur_tstamp.month))
+      history.update(totals.cur_tstamp.year, totals.cur_tstamp.month, totals.t_hit, totals.t_file, totals.t_page, totals.t_visits, totals.t_hosts, totals.t_xfer, totals.f_day, totals.l_day);
+
+   //
+   // Active visits and downloads, as well as countries, cities and ASN entries
+   // are restored from the state snapshot if there is one for this database.
+   //
+   if(is_snapshot_enabled() && restore_snapshot(htab_tstamp))
+      return;
+
    // restore country code data
    {database_t::iterator<ccnode_t> iter = database.begin_countries(nullptr);
    storable_t<ccnode_t> ccnode;
@@ -747,25 +943,67 @@ void state_t::restore_state(void)
    }
 
    //
-   // If there is no record of the current month, set the initial history using 
-   // values from the state database.
-   //
-   if(!history.find_month(totals.cur_tstamp.year, totals.cur_tstamp.month))
-      history.update(totals.cur_tstamp.year, totals.cur_tstamp.month, totals.t_hit, totals.t_file, totals.t_page, totals.t_visits, totals.t_hosts, totals.t_xfer, totals.f_day, totals.l_day);
-
-   //
-   // No need to restore the rest in the report-only mode
+   // No need to restore the rest in the report-only mode or for a closed month
    //
-   if(config.prep_report)
+   if(config.prep_report || closed_month)
       return;
 
+   active_hosts_t active_hosts;
+
    {// restore active visits and the associated host and URL nodes
-   storable_t<vnode_t> vnode;
    database_t::iterator<vnode_t> iter = database.begin_visits();
-   storable_t<hnode_t> hnode;
-   storable_t<unode_t> unode, *uptr;
+   visit_batch_t batch, next_batch;
+
+   bool more = read_visit_batch(iter, batch);
+
+   while(more) {
+      //
+      // Read and unpack the next batch on a worker thread while nodes from the 
+      // current batch are being inserted into hash tables. Only the worker thread
+      // accesses the database until the reader is joined in `get`, so database
+      // handles and buffer allocators are never used concurrently.
+      //
+      std::future<bool> reader = std::async(std::launch::async, &state_t::read_visit_batch, this, std::ref(iter), std::ref(next_batch));
+
+      insert_visits(batch, htab_tstamp, active_hosts);
+
+      more = reader.get();
+
+      batch.swap(next_batch);
+   }}
+
+   {// restore active download jobs and the associated download nodes
+   database_t::iterator<danode_t> iter = database.begin_active_downloads();
+   storable_t<danode_t> danode;
+   storable_t<dlnode_t> dlnode;
+   uint64_t hostid = 0;
+   while(iter.next(danode)) {
+      // read the download node and get the host ID from it
+      dlnode.nodeid = danode.nodeid;
+      if(!database.get_dlnode_by_id<uint64_t&>(dlnode, unpack_dlnode_hostid_cb, hostid))
+         throw std::runtime_error(string_t::_format("Cannot find the download node (ID: %" PRIu64 ")", dlnode.nodeid));
+
+      insert_download(dlnode, danode, hostid, active_hosts, htab_tstamp);
+
+      dlnode.reset();
+      danode.reset();
+   }}
+}
+
+///
+/// Moves nodes out of `batch` into hash tables and remembers host nodes with active
+/// visits in `active_hosts`, so active downloads can be linked to their hosts.
+///
+void state_t::insert_visits(visit_batch_t& batch, int64_t htab_tstamp, active_hosts_t& active_hosts)
+{
+   storable_t<unode_t> *uptr;
    hnode_t *hptr;
-   while(iter.next<void *, storable_t<hnode_t>&, storable_t<unode_t>&>(vnode, unpack_vnode_cb, this, hnode, unode)) {
+
+   for(visit_rec_t& visit : batch) {
+      storable_t<vnode_t>& vnode = visit.vnode;
+      storable_t<hnode_t>& hnode = visit.hnode;
+      storable_t<unode_t>& unode = visit.unode;
+
       // check if the visit has a reference to the last visited URL
       if(unode.nodeid) {
          //
@@ -780,42 +1018,294 @@ void state_t::restore_state(void)
 
       hnode.set_visit(new storable_t<vnode_t>(std::move(vnode)));
 
+      uint64_t hashval = hnode.get_hash();
+      uint64_t hostid = hnode.nodeid;
+
       // remember spammers
       if(hnode.spammer)
-         sp_htab.insert(hnode.string);
+         sp_htab.emplace(hashval, hnode.string);
 
       // now we can move the host node into the new instance in the hash table
-      hptr = hm_htab.put_node(new storable_t<hnode_t>(std::move(hnode)), htab_tstamp);
+      hptr = hm_htab.put_node(hashval, new storable_t<hnode_t>(std::move(hnode)), htab_tstamp);
 
-      hnode.reset();
-      unode.reset();
-      vnode.reset();
-   }}
+      visit_timers.schedule(*hptr, hptr->visit->end.mktime() + config.visit_timeout);
 
-   {// restore active download jobs and the associated host and download nodes
-   database_t::iterator<danode_t> iter = database.begin_active_downloads();
-   storable_t<danode_t> danode;
-   storable_t<dlnode_t> dlnode;
-   storable_t<hnode_t> hnode;
-   hnode_t *hptr;
-   while(iter.next<void *, storable_t<dlnode_t>&, storable_t<hnode_t>&>(danode, unpack_danode_cb, this, dlnode, hnode)) {
-      // the host must be in the hosts table because active downloads are a subset of active visits
-      if((hptr = hm_htab.find_node(OBJ_REG, htab_tstamp, hnode.string)) == nullptr)
-         throw std::runtime_error(string_t::_format("%s (no host %s for download %" PRIu64 ")", config.lang.msg_bad_data, hnode.string.c_str(), dlnode.nodeid));
+      active_hosts.emplace(hostid, hptr);
+   }
+}
 
-      // make a copy of the active download and link it to the kdownload node
-      dlnode.download = new storable_t<danode_t>(danode);
+void state_t::insert_download(storable_t<dlnode_t>& dlnode, storable_t<danode_t>& danode, uint64_t hostid, const active_hosts_t& active_hosts, int64_t htab_tstamp)
+{
+   // the host must be in the hosts table because active downloads are a subset of active visits
+   active_hosts_t::const_iterator host = active_hosts.find(hostid);
 
-      // associate the download with the host node
-      dlnode.set_host(hptr);
+   if(host == active_hosts.end())
+      throw std::runtime_error(string_t::_format("%s (no host ID %" PRIu64 " for download %" PRIu64 ")", config.lang.msg_bad_data, hostid, dlnode.nodeid));
 
-      // finish up and insert the download node into the hash table
-      dl_htab.put_node(new storable_t<dlnode_t>(std::move(dlnode)), htab_tstamp);
+   // make a copy of the active download and link it to the kdownload node
+   dlnode.download = new storable_t<danode_t>(danode);
 
-      dlnode.reset();
-      danode.reset();
-      hnode.reset();
-   }}
+   // associate the download with the host node
+   dlnode.set_host(host->second);
+
+   // finish up and insert the download node into the hash table
+   storable_t<dlnode_t> *dlptr = dl_htab.put_node(new storable_t<dlnode_t>(std::move(dlnode)), htab_tstamp);
+
+   download_timers.schedule(*dlptr, dlptr->download->tstamp.mktime() + config.download_timeout);
+}
+
+///
+/// A state snapshot is only written and used for incremental runs that process log 
+/// files against the default state database. Maintenance runs may not have the working
+/// set restored, so they write no snapshot, which invalidates any existing snapshot when
+/// the system node is saved.
+///
+bool state_t::is_snapshot_enabled(void) const
+{
+   return config.state_snapshot && config.incremental && !config.is_maintenance() && config.is_default_db() && !closed_month;
+}
+
+///
+/// The snapshot is written after all nodes have been saved in the state database, so
+/// node IDs and storage flags match those in the database. The snapshot checkpoint in
+/// the system node must be saved before this method is called.
+///
+/// Failing to write a snapshot is not an error because the state database contains 
+/// the same data. The snapshot is written into a temporary file, which is removed if
+/// any write fails. An existing snapshot is either left in place, in which case it
+/// will be ignored in the next run because its checkpoint will not match the one in
+/// the database, or it is deleted if the temporary file could not be renamed.
+///
+void state_t::save_snapshot(void)
+{
+   snapshot_t snapshot;
+
+   if(snapshot.create(config.get_snapshot_path(), VERSION, sysnode.checkpoint)) {
+      // active visits, each followed by its host and the last URL, if there is one
+      hash_table<storable_t<hnode_t>>::iterator h_iter = hm_htab.begin();
+      while(h_iter.next()) {
+         const storable_t<hnode_t> *hptr = h_iter.item();
+         if(hptr->visit) {
+            snapshot.write_node(*hptr->visit);
+            snapshot.write_node(*hptr);
+
+            if(hptr->visit->lasturl)
+               snapshot.write_node(*hptr->visit->lasturl);
+         }
+      }
+      snapshot.end_section();
+
+      // active downloads, each preceded by its download job node
+      hash_table<storable_t<dlnode_t>>::iterator dl_iter = dl_htab.begin();
+      while(dl_iter.next()) {
+         const storable_t<dlnode_t> *dlptr = dl_iter.item();
+         if(dlptr->download) {
+            snapshot.write_node(*dlptr);
+            snapshot.write_node(*dlptr->download);
+         }
+      }
+      snapshot.end_section();
+
+      // countries with any activity, same as in the database
+      hash_table<storable_t<ccnode_t>>::iterator cc_iter = cc_htab.begin();
+      while(cc_iter.next()) {
+         if(cc_iter.item()->count)
+            snapshot.write_node(*cc_iter.item());
+      }
+      snapshot.end_section();
+
+      hash_table<storable_t<ctnode_t>>::iterator ct_iter = ct_htab.begin();
+      while(ct_iter.next())
+         snapshot.write_node(*ct_iter.item());
+      snapshot.end_section();
+
+      hash_table<storable_t<asnode_t>>::iterator as_iter = as_htab.begin();
+      while(as_iter.next())
+         snapshot.write_node(*as_iter.item());
+      snapshot.end_section();
+   }
+
+   if(!snapshot.commit())
+      fprintf(stderr, "%s %s\n", config.lang.msg_snp_werr, config.get_snapshot_path().c_str());
+}
+
+///
+/// Returns `true` if the snapshot matching the database checkpoint was read and all 
+/// of its nodes were inserted into hash tables. Returns `false` if there is no usable
+/// snapshot, in which case hash tables are not changed and the state should be 
+/// restored from the database.
+///
+/// The snapshot file is deleted after it has been read because the database will be
+/// changed while logs are processed and the snapshot cannot be used after that.
+///
+bool state_t::restore_snapshot(int64_t htab_tstamp)
+{
+   snapshot_t snapshot;
+   visit_batch_t visits;
+   std::vector<download_rec_t> downloads;
+   std::vector<storable_t<ccnode_t>> ccnodes;
+   std::vector<storable_t<ctnode_t>> ctnodes;
+   std::vector<storable_t<asnode_t>> asnodes;
+   active_hosts_t active_hosts;
+   bool restored = false;
+
+   if(!sysnode.checkpoint)
+      return false;
+
+   if(snapshot.open(config.get_snapshot_path(), VERSION, sysnode.checkpoint)) {
+      try {
+         restored = read_snapshot(snapshot, visits, downloads, ccnodes, ctnodes, asnodes);
+      }
+      catch (const std::exception& err) {
+         if(config.verbose > 1)
+            fprintf(stderr, "%s %s (%s)\n", config.lang.msg_snp_rerr, config.get_snapshot_path().c_str(), err.what());
+      }
+
+      snapshot.close();
+   }
+
+   remove(config.get_snapshot_path());
+
+   if(!restored)
+      return false;
+
+   if(config.verbose > 1)
+      printf("%s %s\n", config.lang.msg_snp_use, config.get_snapshot_path().c_str());
+
+   for(const storable_t<ccnode_t>& ccnode : ccnodes)
+      cc_htab.update_ccnode(ccnode, 0);
+
+   for(storable_t<ctnode_t>& ctnode : ctnodes)
+      ct_htab.put_node(new storable_t<ctnode_t>(std::move(ctnode)), 0);
+
+   for(storable_t<asnode_t>& asnode : asnodes)
+      as_htab.put_node(new storable_t<asnode_t>(std::move(asnode)), 0);
+
+   insert_visits(visits, htab_tstamp, active_hosts);
+
+   for(download_rec_t& download : downloads)
+      insert_download(download.dlnode, download.danode, download.hostid, active_hosts, htab_tstamp);
+
+   return true;
+}
+
+///
+/// @brief  Reads nodes from the current snapshot section until the end of the section
+///         is reached.
+///
+template <typename node_t>
+static bool read_snapshot_section(snapshot_t& snapshot, std::vector<storable_t<node_t>>& nodes)
+{
+   while(true) {
+      nodes.emplace_back();
+
+      if(!snapshot.read_node(nodes.back())) {
+         nodes.pop_back();
+         break;
+      }
+   }
+
+   return !snapshot.is_error();
+}
+
+///
+/// Sections are read in the same order they are written in `save_snapshot`. Returns
+/// `false` if any of the sections is malformed.
+///
+bool state_t::read_snapshot(snapshot_t& snapshot, visit_batch_t& visits, std::vector<download_rec_t>& downloads, std::vector<storable_t<ccnode_t>>& ccnodes, std::vector<storable_t<ctnode_t>>& ctnodes, std::vector<storable_t<asnode_t>>& asnodes) const
+{
+   // active visits, along with their hosts and last URLs
+   while(true) {
+      visits.emplace_back();
+      visit_rec_t& visit = visits.back();
+
+      if(!snapshot.read_node<vnode_t, uint64_t&>(visit.vnode, unpack_vnode_urlid_cb, visit.urlid)) {
+         visits.pop_back();
+         break;
+      }
+
+      if(!snapshot.read_node<hnode_t, void*>(visit.hnode, unpack_active_hnode_cb, (void*) this) || visit.hnode.nodeid != visit.vnode.nodeid)
+         return false;
+
+      if(visit.urlid && (!snapshot.read_node(visit.unode) || visit.unode.nodeid != visit.urlid))
+         return false;
+   }
+
+   if(snapshot.is_error())
+      return false;
+
+   // active downloads, along with their download jobs
+   while(true) {
+      downloads.emplace_back();
+      download_rec_t& download = downloads.back();
+
+      if(!snapshot.read_node<dlnode_t, uint64_t&>(download.dlnode, unpack_dlnode_hostid_cb, download.hostid)) {
+         downloads.pop_back();
+         break;
+      }
+
+      if(!snapshot.read_node(download.danode) || download.danode.nodeid != download.dlnode.nodeid)
+         return false;
+   }
+
+   if(snapshot.is_error())
+      return false;
+
+   return read_snapshot_section(snapshot, ccnodes) && read_snapshot_section(snapshot, ctnodes) && read_snapshot_section(snapshot, asnodes);
+}
+
+///
+/// Reads up to `VISIT_BATCH_SIZE` active visits in key order and then looks up hosts 
+/// and last visited URLs for the entire batch, sorted by their node IDs, so database
+/// pages are visited sequentially rather than bouncing between the visit, host and 
+/// URL tables for each visit.
+///
+/// Returns `false` if there are no more active visits, in which case `batch` is empty.
+///
+bool state_t::read_visit_batch(database_t::iterator<vnode_t>& iter, visit_batch_t& batch) const
+{
+   std::vector<size_t> order;
+
+   batch.clear();
+   batch.reserve(VISIT_BATCH_SIZE);
+
+   // read visits in key order and remember last URL IDs for later
+   while(batch.size() < VISIT_BATCH_SIZE) {
+      batch.emplace_back();
+
+      if(!iter.next<uint64_t&>(batch.back().vnode, unpack_vnode_urlid_cb, batch.back().urlid)) {
+         batch.pop_back();
+         break;
+      }
+   }
+
+   if(batch.empty())
+      return false;
+
+   // visits share node IDs with their hosts and are already sorted by the host ID
+   for(visit_rec_t& visit : batch) {
+      visit.hnode.nodeid = visit.vnode.nodeid;
+      if(!database.get_hnode_by_id(visit.hnode, unpack_active_hnode_cb, (void*) this))
+         throw std::runtime_error(string_t::_format("Cannot find the host node (ID: %" PRIu64 ") for visit (ID: %" PRIu64 ")", visit.hnode.nodeid, visit.vnode.nodeid));
+   }
+
+   // sort visits with the last URL by the URL ID
+   for(size_t i = 0; i < batch.size(); i++) {
+      if(batch[i].urlid)
+         order.push_back(i);
+   }
+
+   std::sort(order.begin(), order.end(), [&batch](size_t i1, size_t i2) {return batch[i1].urlid < batch[i2].urlid;});
+
+   for(size_t i : order) {
+      visit_rec_t& visit = batch[i];
+
+      visit.unode.nodeid = visit.urlid;
+      if(!database.get_unode_by_id(visit.unode))
+         throw std::runtime_error(string_t::_format("Cannot find the last URL (ID: %" PRIu64 ") of an active visit (ID: %" PRIu64 ")", visit.urlid, visit.vnode.nodeid));
+   }
+
+   return true;
 }
 
 ///
@@ -879,17 +1369,25 @@ void state_t::init_counters(void)
    for(hash_table_base *htab : cleared_htabs) 
       htab->clear();
 
+   // all scheduled nodes were removed along with their hash tables
+   visit_timers.clear();
+   download_timers.clear();
+
    sp_htab.clear();
+
+   // hash tables are empty, so swap out nodes when they grow past the configured size
+   htab_memwatch.set_watermark(config.db_cache_size);
 }
 
 ///
 /// The current state database file is renamed to include the year and the month
-/// of `tstamp` in the file name and a new empty state database is created.
+/// of `tstamp` in the file name and a new empty state database is created. The new 
+/// name of the renamed file is returned, so the file may be opened for a report.
 ///
-void state_t::rollover_database(const tstamp_t& tstamp)
+string_t state_t::rollover_database(const tstamp_t& tstamp)
 {
    u_int seqnum = 1;
-   string_t path, curpath, newpath;
+   string_t curpath, newname, newpath;
    berkeleydb_t::status_t status;
 
    // rollover is only called for the default database
@@ -900,16 +1398,17 @@ void state_t::rollover_database(const tstamp_t& tstamp)
    if(!(status = database.close()).success())
       throw exception_t(0, string_t::_format("Cannot close the database for a rollover (%s)", status.err_msg().c_str()));
 
-   // make the initial part of the path
-   path = make_path(config.db_path, config.db_fname);
+   curpath = make_path(config.db_path, config.get_db_name());
 
    // create a file name with a year/month sequence (e.g. webalizer_200706.db)
-   curpath.format("%s.%s", path.c_str(), config.db_fname_ext.c_str());
-   newpath.format("%s_%04d%02d.%s", path.c_str(), tstamp.year, tstamp.month, config.db_fname_ext.c_str());
+   newname.format("%s_%04d%02d.%s", config.db_fname.c_str(), tstamp.year, tstamp.month, config.db_fname_ext.c_str());
+   newpath = make_path(config.db_path, newname);
 
    // if the file exists, increment the sequence number until a unique name is found
-   while(!access(newpath, F_OK))
-      newpath.format("%s_%04d%02d_%d.%s", path.c_str(), tstamp.year, tstamp.month, seqnum++, config.db_fname_ext.c_str());
+   while(!access(newpath, F_OK)) {
+      newname.format("%s_%04d%02d_%d.%s", config.db_fname.c_str(), tstamp.year, tstamp.month, seqnum++, config.db_fname_ext.c_str());
+      newpath = make_path(config.db_path, newname);
+   }
 
    // rename the file
    if(rename(curpath, newpath))
@@ -918,19 +1417,26 @@ void state_t::rollover_database(const tstamp_t& tstamp)
    // and reopen the database
    if(!(status = database.open()).success())
       throw exception_t(0, string_t::_format("Cannot open the database after a rollover (%s)", status.err_msg().c_str()));
+
+   return newname;
 }
 
 /*********************************************/
 /* CLEAR_MONTH - initalize monthly stuff     */
 /*********************************************/
 
-void state_t::clear_month()
+///
+/// Returns the name of the rolled over database file or an empty string if there
+/// was no data in the database.
+///
+string_t state_t::clear_month()
 {
    database_t::status_t status;
+   string_t db_name;
 
    // if there's any data in the database, rename the file
    if(!totals.cur_tstamp.null) {
-      rollover_database(totals.cur_tstamp);
+      db_name = rollover_database(totals.cur_tstamp);
       
       // it's a new database - reset the system node
       sysnode.reset(config);
@@ -938,6 +1444,8 @@ void state_t::clear_month()
 
    // reset monthly counters and clear hash tables
    init_counters();
+
+   return db_name;
 }
 
 template <typename type_t>
@@ -981,6 +1489,10 @@ void state_t::update_hourly_stats(void)
 
    // update hourly maximum hits
    if (totals.ht_hits > totals.hm_hit) totals.hm_hit = totals.ht_hits;
+
+   // queue totals of the completed hour for the time series file
+   if(!config.ts_fname.isempty())
+      ts_hours.push_back(timeseries_t::hour_t(totals.cur_tstamp.year, totals.cur_tstamp.month, totals.cur_tstamp.day, totals.cur_tstamp.hour, totals.ht_hits, totals.ht_files, totals.ht_pages, totals.ht_visits, totals.ht_hosts, totals.ht_xfer));
    
    // reset hourly counters
    totals.ht_hits = totals.ht_files = totals.ht_pages = 0;
@@ -1011,30 +1523,41 @@ void state_t::set_tstamp(const tstamp_t& tstamp)
 ///
 /// @brief  Stores all nodes with last access time stamps that are less than or
 ///         equal to `tstamp` in the database, up to `maxmem` in hash table memory
-///         size.
+///         size, and sets the memory watermark for the next swap-out.
+///
+/// Each swap-out frees up only a small fraction of `maxmem`, so nodes are swapped
+/// out in small batches as hash tables grow, instead of in large periodic batches.
+/// If nodes cannot be swapped out because they are still in use, the next swap-out
+/// is deferred until hash tables grow by the same fraction or until `tstamp` moves
+/// past the visit timeout, whichever comes first, so nodes that are no longer in use
+/// are swapped out even if hash tables stop growing.
+///
+/// Use `is_swap_out_due` to check when this method should be called.
 ///
 void state_t::swap_out(int64_t tstamp, size_t maxmem)
 {
-   size_t totmem = 0;
-   hash_table_base *hti[] = {&dl_htab, &hm_htab, &um_htab, &rm_htab, &am_htab, &sr_htab, &im_htab};
-
-   // compute total memory used by all hash tables
-   for(hash_table_base *h : hti)
-      totmem += h->get_memsize();
+   // combined memory size is maintained by hash tables in swapped_htabs
+   size_t totmem = htab_memwatch.get_memsize();
+   size_t stepmem = maxmem / 20;
 
    // check if if we are over the requested limit
    if(totmem > maxmem) {
       //
       // Compute how much memory to swap out, which is all memory over the
-      // maximum, plus 20% of the maximum allowed size.
+      // maximum, plus 5% of the maximum allowed size.
       //
-      size_t overmem = totmem - maxmem + maxmem / 5;
+      size_t overmem = totmem - maxmem + stepmem;
+      database_t::status_t status;
+
+      // write all swapped out nodes in a few large transactions, if they are enabled
+      if(!(status = database.begin_transaction(false)).success())
+         throw exception_t(0, string_t::_format("Cannot begin a database transaction (%s)", status.err_msg().c_str()));
 
       //
       // Walk all tables and for each compute the size of the excess memory
       // that proportional to the size they occupy in the total memory.
       //
-      for(hash_table_base *h : hti) {
+      for(hash_table_base *h : swapped_htabs) {
          size_t htotmem = h->get_memsize();
 
          if(htotmem) {
@@ -1049,7 +1572,13 @@ void state_t::swap_out(int64_t tstamp, size_t maxmem)
                h->swap_out(tstamp, htotmem - hcutmem);
          }
       }
+
+      if(!(status = database.commit_transaction()).success())
+         throw exception_t(0, string_t::_format("Cannot commit a database transaction (%s)", status.err_msg().c_str()));
    }
+
+   // if nodes are still in use, retry when memory grows or when they may be out of use
+   htab_memwatch.update_watermark(maxmem, stepmem, tstamp + config.visit_timeout);
 }
 
 // -----------------------------------------------------------------------
@@ -1114,50 +1643,31 @@ void state_t::unpack_dlnode_and_host_cb(dlnode_t& dlnode, uint64_t hostid, bool
 }
 
 ///
-/// This method is intended for loading downloads and their associated hosts during 
-/// `state_t` initialization using active downloads as input.
+/// This method is intended for loading downloads during `state_t` initialization using
+/// active downloads as input.
 ///
-/// All host nodes loaded by this method must already be in the host hash table because
-/// active visits and their associated hosts are loaded before downloads and a download 
-/// can be active only within an active visit. Consequently, only the host IP address 
-/// from `hnode` is needed, so the host can be found in the host hash table after this
-/// call returns, along with the active visit and the associated URL.
+/// All host nodes referenced by active downloads must already be in the host hash table
+/// because active visits and their associated hosts are loaded before downloads and a 
+/// download can be active only within an active visit. Consequently, only the host ID 
+/// is returned in `dlhostid` and the host node is not read from the database.
 ///
-/// Neither of the node arguments is linked to one another. See `unpack_dlnode_and_host_cb`.
-///
-void state_t::unpack_danode_cb(danode_t& danode, void *arg, storable_t<dlnode_t>& dlnode, storable_t<hnode_t>& hnode)
+void state_t::unpack_dlnode_hostid_cb(dlnode_t& dlnode, uint64_t hostid, bool active, uint64_t& dlhostid)
 {
-   std::unique_ptr<storable_t<dlnode_t>> dlptr;
-   const state_t *_this = (const state_t*) arg;
+   // a download node must have a valid host node ID
+   if(!hostid)
+      throw std::runtime_error(string_t::_format("Invalid host node for the download (ID: %" PRIu64 ")", dlnode.nodeid));
 
-   // read the download and the host from the database
-   dlnode.nodeid = danode.nodeid;
-   if(!_this->database.get_dlnode_by_id<void *, storable_t<hnode_t>&>(dlnode, unpack_dlnode_and_host_cb, arg, hnode))
-      throw std::runtime_error(string_t::_format("Cannot find the download node (ID: %" PRIu64 ")", dlnode.nodeid));
+   dlhostid = hostid;
 }
 
 ///
-/// This method reads from the database a host and a URL node associated with the active 
-/// visit identified by `vnode` and is intended to be used during `state_t` initialization, 
-/// when active visits are being loaded from the database.
-///
-/// Neither of the node arguments is linked to one another. See `unpack_dlnode_and_host_cb`.
+/// This method does not read anything from the database and just returns the ID of the
+/// last URL of the active visit, so URL nodes for a batch of visits can be read in the
+/// URL ID order. See `read_visit_batch`.
 ///
-void state_t::unpack_vnode_cb(vnode_t& vnode, uint64_t urlid, void *arg, storable_t<hnode_t>& hnode, storable_t<unode_t>& unode)
+void state_t::unpack_vnode_urlid_cb(vnode_t& vnode, uint64_t urlid, uint64_t& vurlid)
 {
-   const state_t *_this = (state_t*) arg;
-
-   if(urlid) {
-      unode.nodeid = urlid;
-
-      // look up a URL node in the database
-      if(!_this->database.get_unode_by_id(unode))
-         throw std::runtime_error(string_t::_format("Cannot find the last URL (ID: %d) of an active visit (ID: %" PRIu64 ")", urlid, vnode.nodeid));
-   }
-
-   hnode.nodeid = vnode.nodeid;
-   if(!_this->database.get_hnode_by_id(hnode, unpack_active_hnode_cb, arg))
-      throw std::runtime_error(string_t::_format("Cannot find the host node (ID: %" PRIu64 ") for visit (ID: %" PRIu64 ")", hnode.nodeid, vnode.nodeid));
+   vurlid = urlid;
 }
 
 ///
@@ -21,12 +21,16 @@
 #include "database.h"
 #include "hashtab_nodes.h"
 #include "storable.h"
+#include "timer_wheel.h"
+#include "timeseries.h"
 
 #include <vector>
 #include <unordered_set>
+#include <unordered_map>
 
 class config_t;
 class lang_t;
+class snapshot_t;
 
 ///
 /// @brief  Keeps the entire processing state for the current month
@@ -40,6 +44,36 @@ class state_t {
       typedef storable_t<vnode_t> *(*end_visit_cb_t)(storable_t<hnode_t> *hnode, void *arg);
       typedef storable_t<danode_t> *(*end_download_cb_t)(storable_t<dlnode_t> *dlnode, void *arg);
 
+   private:
+      ///
+      /// @brief  An active visit read from the state database, along with its host and
+      ///         the last visited URL.
+      ///
+      struct visit_rec_t {
+         storable_t<vnode_t> vnode;
+         storable_t<hnode_t> hnode;
+         storable_t<unode_t> unode;
+         uint64_t            urlid = 0;       ///< Last URL ID, as stored in the visit.
+      };
+
+      typedef std::vector<visit_rec_t> visit_batch_t;
+
+      ///
+      /// @brief  An active download read from a state snapshot, along with its download 
+      ///         job node.
+      ///
+      struct download_rec_t {
+         storable_t<dlnode_t> dlnode;
+         storable_t<danode_t> danode;
+         uint64_t             hostid = 0;      ///< Host ID, as stored in the download job.
+      };
+
+      /// Hosts with active visits, so active downloads can find them by ID.
+      typedef std::unordered_map<uint64_t, hnode_t*> active_hosts_t;
+
+      /// The number of active visits read from the state database in one batch.
+      static const size_t VISIT_BATCH_SIZE = 1024;
+
    public:
       storable_t<totals_t> totals;
 
@@ -47,8 +81,25 @@ class state_t {
 
       storable_t<hourly_t> t_hourly[24];        // hourly totals
 
+      std::vector<timeseries_t::hour_t> ts_hours;  ///< Completed hours not yet appended to the time series file.
+
       sc_table_t response;                      // HTTP status codes
 
+      //
+      // Host nodes with active visits and download job nodes with active downloads
+      // are scheduled in these timer wheels to be checked for timeouts. Timer wheels
+      // must be declared before hash tables, so they are destroyed after all nodes.
+      //
+      timer_wheel_t visit_timers;               ///< Host nodes with active visits.
+      timer_wheel_t download_timers;            ///< Download job nodes with active downloads.
+
+      //
+      // Combined memory size of hash tables that may be swapped out, which hash tables
+      // update as nodes are inserted and removed. It must be declared before hash tables,
+      // which update it when they are destroyed.
+      //
+      hash_table_base::memwatch_t htab_memwatch;
+
       ///
       /// @name   Monthly state hash tables
       ///
@@ -98,10 +149,12 @@ class state_t {
 
       /// @}
 
-      std::unordered_set<string_t, hash_string> sp_htab; ///< Spammer hosts
+      std::unordered_set<hashed_string_t, hash_hashed_string> sp_htab; ///< Spammer hosts
 
       std::vector<hash_table_base*> cleared_htabs; ///< A vector or hash tables to clear on month switch (order is important).
 
+      std::vector<hash_table_base*> swapped_htabs; ///< A vector of hash tables that may be swapped out.
+
       std::vector<uint64_t> v_ended;             // ended active visit node IDs
       std::vector<uint64_t> dl_ended;            // ended active download node IDs
 
@@ -111,6 +164,12 @@ class state_t {
    private:
       const config_t&   config;
 
+      const string_t    db_name;               ///< State database file name.
+
+      const string_t    db_path;               ///< Full path of the state database file.
+
+      const bool        closed_month;          ///< Reads a rolled over database to generate a report?
+
       char              *buffer;
 
       storable_t<sysnode_t> sysnode;
@@ -125,17 +184,47 @@ class state_t {
 
       void init_counters(void);
 
-      /// Closes and renamed the current database file and opens a new empty one.
-      void rollover_database(const tstamp_t& tstamp);
+      /// Closes and renames the current database file, opens a new empty one and returns the new name of the closed file.
+      string_t rollover_database(const tstamp_t& tstamp);
+
+      /// Reads the next batch of active visits, along with their hosts and last URLs.
+      bool read_visit_batch(database_t::iterator<vnode_t>& iter, visit_batch_t& batch) const;
+
+      /// Inserts active visits, along with their hosts and last URLs, into hash tables.
+      void insert_visits(visit_batch_t& batch, int64_t htab_tstamp, active_hosts_t& active_hosts);
+
+      /// Inserts an active download and its download job into the download hash table.
+      void insert_download(storable_t<dlnode_t>& dlnode, storable_t<danode_t>& danode, uint64_t hostid, const active_hosts_t& active_hosts, int64_t htab_tstamp);
+
+      /// Returns `true` if a state snapshot should be written and used for this run.
+      bool is_snapshot_enabled(void) const;
+
+      /// Writes active visits, active downloads, countries, cities and ASN entries into a state snapshot.
+      void save_snapshot(void);
+
+      /// Frees up to `DbCompactPages` database pages, continuing where compaction stopped in the previous run.
+      void compact_database(void);
+
+      /// Stores the database cache working set in the system node and reports cache statistics if `verbose` is greater than one.
+      void update_cache_stats(void);
+
+      /// Appends totals of completed hours to the time series file.
+      void update_timeseries(void);
+
+      /// Restores active visits, active downloads, countries, cities and ASN entries from a state snapshot.
+      bool restore_snapshot(int64_t htab_tstamp);
+
+      /// Reads all snapshot sections without changing any of the hash tables.
+      bool read_snapshot(snapshot_t& snapshot, visit_batch_t& visits, std::vector<download_rec_t>& downloads, std::vector<storable_t<ccnode_t>>& ccnodes, std::vector<storable_t<ctnode_t>>& ctnodes, std::vector<storable_t<asnode_t>>& asnodes) const;
 
       ///
       /// @name   Serialization callbacks
       ///
       /// @{
 
-      static void unpack_danode_cb(danode_t& danode, void *arg, storable_t<dlnode_t>& dlnode, storable_t<hnode_t>& hnode);
+      static void unpack_vnode_urlid_cb(vnode_t& vnode, uint64_t urlid, uint64_t& vurlid);
 
-      static void unpack_vnode_cb(vnode_t& vnode, uint64_t urlid, void *_this, storable_t<hnode_t>& hnode, storable_t<unode_t>& unode);
+      static void unpack_dlnode_hostid_cb(dlnode_t& dlnode, uint64_t hostid, bool active, uint64_t& dlhostid);
 
       static void unpack_active_hnode_cb(hnode_t& hnode, bool active, void *_this);
       /// @}
@@ -144,12 +233,18 @@ class state_t {
 
       static bool eval_unode_cb(const unode_t *unode, void *arg);
 
+      template <typename node_t>
+      static bool swap_out_order_cb(const node_t *node1, const node_t *node2);
+
       template <typename node_t, bool (database_t::*put_node)(const node_t& node, storage_info_t& strg_info)>
       static void swap_out_node_cb(storable_t<node_t> *node, void *arg);
 
    public:
       state_t(const config_t& config, end_visit_cb_t end_visit_db, end_download_cb_t end_download_cb, void *and_cb_arg);
 
+      /// Creates a state for a closed month in the rolled over database `db_name` to generate a report.
+      state_t(const config_t& config, const string_t& db_name);
+
       ~state_t(void);
 
       bool initialize(void);
@@ -162,7 +257,7 @@ class state_t {
 
       static void upgrade_database(storable_t<sysnode_t>& sysnode, system_database_t& sysdb);
 
-      void clear_month(void);
+      string_t clear_month(void);
       
       void update_hourly_stats(void);
 
@@ -174,6 +269,9 @@ class state_t {
 
       void swap_out(int64_t tstamp, size_t maxmem);
 
+      /// Returns `true` if hash tables grew past the point when `swap_out` should be called or if it's time to retry a swap-out that freed too little memory.
+      bool is_swap_out_due(int64_t tstamp) const {return htab_memwatch.is_swap_out_due(tstamp);}
+
       ///
       /// @name   Serialization callbacks
       ///
@@ -0,0 +1,150 @@
+/*
+    webalizer - a web server log analysis program
+
+    Copyright (c) 2004-2022, Stone Steps Inc. (www.stonesteps.ca)
+
+    See COPYING and Copyright files for additional licensing and copyright information
+
+    profiler.cpp
+*/
+#include "pch.h"
+
+#include "profiler.h"
+
+#include <cinttypes>
+
+///
+/// The innermost active timer in each thread. Timers in different threads are
+/// not nested, so each thread maintains its own timer chain.
+///
+static thread_local profiler_t::timer_t *active_timer = nullptr;
+
+const char *profiler_t::stage_names[STAGE_COUNT] = {
+   "read",
+   "parse",
+   "process",
+   "dns",
+   "swap_out",
+   "save",
+   "report"
+};
+
+profiler_t::timer_t::timer_t(profiler_t& profiler, stage_t stage) :
+      profiler(profiler.enabled ? &profiler : nullptr),
+      stage(stage),
+      outer(nullptr)
+{
+   if(!this->profiler)
+      return;
+
+   start = std::chrono::steady_clock::now();
+
+   // pause the outer timer, so its stage doesn't include time spent in this one
+   if((outer = active_timer) != nullptr)
+      outer->pause(start);
+
+   active_timer = this;
+
+   profiler.stages[stage].calls++;
+}
+
+profiler_t::timer_t::~timer_t(void)
+{
+   if(!profiler)
+      return;
+
+   time_point_t now = std::chrono::steady_clock::now();
+
+   pause(now);
+
+   // resume the outer timer
+   if((active_timer = outer) != nullptr)
+      outer->start = now;
+}
+
+void profiler_t::timer_t::pause(time_point_t now)
+{
+   profiler->stages[stage].nsecs += std::chrono::duration_cast<std::chrono::nanoseconds>(now - start).count();
+}
+
+profiler_t::profiler_t(void) : enabled(false)
+{
+}
+
+void profiler_t::add_htab_stats(const char *name, uint64_t hits, uint64_t misses, uint64_t swapped)
+{
+   htab_stats.push_back({name, hits, misses, swapped});
+}
+
+void profiler_t::print_table(FILE *file) const
+{
+   uint64_t total_nsecs = 0;
+
+   for(size_t i = 0; i < STAGE_COUNT; i++)
+      total_nsecs += stages[i].nsecs;
+
+   fprintf(file, "%-10s %12s %6s %12s %12s %14s %12s\n", "Stage", "Seconds", "%", "Calls", "Records", "Bytes", "Records/sec");
+
+   for(size_t i = 0; i < STAGE_COUNT; i++) {
+      const stage_stats_t& stats = stages[i];
+      double secs = stats.nsecs / 1000000000.;
+
+      fprintf(file, "%-10s %12.3f %6.1f %12" PRIu64 " %12" PRIu64 " %14" PRIu64 " %12.0f\n",
+                  stage_names[i], secs,
+                  total_nsecs ? stats.nsecs * 100. / total_nsecs : 0.,
+                  stats.calls, stats.records, stats.bytes,
+                  secs > 0. ? stats.records / secs : 0.);
+   }
+
+   if(!htab_stats.empty()) {
+      fprintf(file, "\n%-10s %14s %14s %8s %14s\n", "Table", "Hits", "Misses", "Hit %", "Swapped");
+
+      for(const htab_stats_t& stats : htab_stats) {
+         fprintf(file, "%-10s %14" PRIu64 " %14" PRIu64 " %8.1f %14" PRIu64 "\n",
+                     stats.name, stats.hits, stats.misses,
+                     stats.hits + stats.misses ? stats.hits * 100. / (stats.hits + stats.misses) : 0.,
+                     stats.swapped);
+      }
+   }
+}
+
+///
+/// Stage and hash table names are fixed identifiers and are written without JSON
+/// encoding.
+///
+bool profiler_t::write_json(const string_t& path) const
+{
+   FILE *file;
+   bool error = false;
+
+   if((file = fopen(path, "w")) == nullptr)
+      return false;
+
+   fputs("{\n  \"stages\": {", file);
+
+   for(size_t i = 0; i < STAGE_COUNT; i++) {
+      const stage_stats_t& stats = stages[i];
+
+      fprintf(file, "%s\n    \"%s\": {\"nsecs\": %" PRIu64 ", \"calls\": %" PRIu64 ", \"records\": %" PRIu64 ", \"bytes\": %" PRIu64 "}",
+                  i ? "," : "", stage_names[i], stats.nsecs, stats.calls, stats.records, stats.bytes);
+   }
+
+   fputs("\n  },\n  \"hash_tables\": {", file);
+
+   for(size_t i = 0; i < htab_stats.size(); i++) {
+      const htab_stats_t& stats = htab_stats[i];
+
+      fprintf(file, "%s\n    \"%s\": {\"hits\": %" PRIu64 ", \"misses\": %" PRIu64 ", \"swapped\": %" PRIu64 "}",
+                  i ? "," : "", stats.name, stats.hits, stats.misses, stats.swapped);
+   }
+
+   fputs("\n  }\n}\n", file);
+
+   if(ferror(file))
+      error = true;
+
+   if(fclose(file))
+      error = true;
+
+   return !error;
+}
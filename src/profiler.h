@@ -0,0 +1,138 @@
+/*
+    webalizer - a web server log analysis program
+
+    Copyright (c) 2004-2022, Stone Steps Inc. (www.stonesteps.ca)
+
+    See COPYING and Copyright files for additional licensing and copyright information
+
+    profiler.h
+*/
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include "types.h"
+#include "tstring.h"
+
+#include <cstdio>
+#include <chrono>
+#include <vector>
+
+///
+/// @brief  Collects time spent in each processing stage, along with record and
+///         byte counts for each stage and hash table look-up counts.
+///
+/// Processing stages are timed with scoped timers. Stage times are exclusive, so
+/// when a timer is started while another one is active in the same thread, such as
+/// swapping out hash table nodes while processing a log record, the time of the
+/// outer stage is paused until the inner timer goes out of scope.
+///
+/// Each stage must be timed in one thread at a time. Reading and parsing log records
+/// may be done in the log reader thread, while all other stages are timed in the
+/// main thread.
+///
+/// If the profiler is disabled, timers do not read the clock and the cost of each
+/// timer is a single flag check.
+///
+class profiler_t {
+   public:
+      ///
+      /// @brief  Processing stages
+      ///
+      enum stage_t {
+         STAGE_READ,          ///< Reading log lines, including decompression
+         STAGE_PARSE,         ///< Parsing log lines into log records
+         STAGE_PROCESS,       ///< Aggregating log records in the monthly state
+         STAGE_DNS,           ///< Waiting for DNS and GeoIP look-ups
+         STAGE_SWAP_OUT,      ///< Swapping out hash table nodes to the state database
+         STAGE_SAVE,          ///< Saving and rolling over the monthly state
+         STAGE_REPORT,        ///< Generating reports
+         STAGE_COUNT          ///< Number of stages (must be last)
+      };
+
+      ///
+      /// @brief  A scoped timer that adds the time between its construction and
+      ///         destruction to a processing stage.
+      ///
+      class timer_t {
+         private:
+            typedef std::chrono::steady_clock::time_point time_point_t;
+
+         private:
+            profiler_t  *profiler;     ///< Profiler, or `nullptr` if profiling is disabled
+            stage_t     stage;         ///< Stage being timed
+            timer_t     *outer;        ///< Timer that was active in this thread when this one started
+            time_point_t start;        ///< Start of the current uninterrupted timing interval
+
+         private:
+            void pause(time_point_t now);
+
+         public:
+            timer_t(profiler_t& profiler, stage_t stage);
+
+            ~timer_t(void);
+
+            timer_t(const timer_t&) = delete;
+            timer_t& operator = (const timer_t&) = delete;
+      };
+
+      ///
+      /// @brief  Hash table look-up counts
+      ///
+      struct htab_stats_t {
+         const char  *name;         ///< Hash table name
+         uint64_t    hits;          ///< Number of look-ups that found a node
+         uint64_t    misses;        ///< Number of look-ups that did not find a node
+         uint64_t    swapped;       ///< Number of nodes swapped out
+      };
+
+      ///
+      /// @brief  Stage timing and counters
+      ///
+      struct stage_stats_t {
+         uint64_t    nsecs = 0;     ///< Exclusive time spent in this stage, in nanoseconds
+         uint64_t    calls = 0;     ///< Number of times this stage was entered
+         uint64_t    records = 0;   ///< Number of records processed in this stage
+         uint64_t    bytes = 0;     ///< Number of bytes processed in this stage
+      };
+
+   private:
+      static const char *stage_names[STAGE_COUNT];
+
+      bool                       enabled;             ///< Is profiling enabled?
+
+      stage_stats_t              stages[STAGE_COUNT]; ///< Per-stage timing and counters
+
+      std::vector<htab_stats_t>  htab_stats;          ///< Hash table look-up counts
+
+   public:
+      profiler_t(void);
+
+      /// Enables or disables profiling.
+      void set_enabled(bool enabled) {this->enabled = enabled;}
+
+      /// Returns `true` if profiling is enabled.
+      bool is_enabled(void) const {return enabled;}
+
+      /// Adds record and byte counts to the specified stage.
+      void add_counts(stage_t stage, uint64_t records, uint64_t bytes = 0)
+      {
+         if(enabled) {
+            stages[stage].records += records;
+            stages[stage].bytes += bytes;
+         }
+      }
+
+      /// Returns timing and counters for the specified stage.
+      const stage_stats_t& get_stage_stats(stage_t stage) const {return stages[stage];}
+
+      /// Adds look-up counts for a hash table.
+      void add_htab_stats(const char *name, uint64_t hits, uint64_t misses, uint64_t swapped);
+
+      /// Prints a table with stage times and counters.
+      void print_table(FILE *file) const;
+
+      /// Writes stage times and counters as a JSON object into the specified file.
+      bool write_json(const string_t& path) const;
+};
+
+#endif // PROFILER_H
@@ -12,6 +12,7 @@
 #include "serialize.h"
 
 #include <stdexcept>
+#include <type_traits>
 
 serializer_t::serializer_t(const void *buffer, size_t bufsize) :
       buffer(buffer),
@@ -85,11 +86,50 @@ size_t serializer_t::s_size_of(bool value)
    return s_size_of<bool>();
 }
 
+size_t serializer_t::s_size_of(const ipaddr_t& ipaddr)
+{
+   return s_size_of<u_char>() + ipaddr.size();
+}
+
 template <> size_t serializer_t::s_size_of(const char (&chars)[2])
 {
    return sizeof(char[2]);
 }
 
+///
+/// Signed values are zigzag-encoded before they are measured, so the returned size
+/// matches the number of bytes written by `serialize_varint` for the same value.
+///
+template <typename type_t>
+size_t serializer_t::s_size_of_varint(type_t value)
+{
+   typedef typename std::make_unsigned<type_t>::type utype_t;
+
+   utype_t uvalue = std::is_signed<type_t>::value ? 
+               (utype_t) (((utype_t) value << 1) ^ (utype_t) (value >> (sizeof(type_t) * 8 - 1))) : 
+               (utype_t) value;
+
+   size_t datasize = 1;
+
+   while(uvalue >>= 7)
+      datasize++;
+
+   return datasize;
+}
+
+size_t serializer_t::s_size_of_varint(const tstamp_t& tstamp)
+{
+   size_t datasize = s_size_of<u_char>();       // null, utc
+
+   if(tstamp.null)
+      return datasize;
+
+   datasize += s_size_of_varint<int64_t>(tstamp_t::mktime(tstamp.year, tstamp.month, tstamp.day, tstamp.hour, tstamp.min, tstamp.sec));
+
+   return tstamp.utc ? datasize : 
+               datasize + s_size_of_varint<int>(tstamp.offset);
+}
+
 template <typename type_t>
 size_t serializer_t::s_size_of(const void *ptr) const
 {
@@ -157,6 +197,45 @@ const void *serializer_t::s_skip_field<bool>(const void *ptr) const
    return (u_char*) ptr + sizeof(u_char);
 }
 
+const void *serializer_t::s_skip_varint(const void *ptr) const
+{
+   size_t datasize = 0;
+
+   //
+   // Walk the continuation bits within the buffer. There is no way to tell the
+   // intended integer size at this point, so only the longest possible encoding
+   // of a 64-bit value is enforced.
+   //
+   do {
+      if(buffer_space(ptr) <= datasize)
+         throw std::invalid_argument("Truncated data (varint)");
+
+      if(datasize == (sizeof(uint64_t) * 8 + 6) / 7)
+         throw std::invalid_argument("Bad variable-length integer");
+   } while(((const u_char*) ptr)[datasize++] & 0x80);
+
+   return (const u_char*) ptr + datasize;
+}
+
+const void *serializer_t::s_skip_varint_tstamp(const void *ptr) const
+{
+   u_char flags;
+
+   ptr = deserialize(ptr, flags);
+
+   // null time stamps are stored as flags alone
+   if(flags & 0x01)
+      return ptr;
+
+   ptr = s_skip_varint(ptr);
+
+   // UTC offset is stored only for local time stamps
+   if(!(flags & 0x02))
+      ptr = s_skip_varint(ptr);
+
+   return ptr;
+}
+
 template <typename type_t>
 const void *serializer_t::s_skip_field(const void *ptr) const
 {
@@ -247,6 +326,63 @@ void *serializer_t::serialize(void *ptr, bool value) const
    return serialize<u_char, bool>(ptr, value);
 }
 
+///
+/// The address family is stored first, followed by 4 or 16 address bytes in the
+/// network byte order. Only the family is stored if `ipaddr` is not an address.
+///
+void *serializer_t::serialize(void *ptr, const ipaddr_t& ipaddr) const
+{
+   ptr = serialize<u_char>(ptr, ipaddr.family);
+
+   return serialize(ptr, (const char*) ipaddr.addr, ipaddr.size());
+}
+
+template <typename type_t>
+void *serializer_t::serialize_varint(void *ptr, type_t value) const
+{
+   typedef typename std::make_unsigned<type_t>::type utype_t;
+
+   size_t datasize = s_size_of_varint(value);
+
+   if(buffer_space(ptr) < datasize)
+      throw std::invalid_argument(string_t::_format("Buffer is too small (varint %s)", typeid(value).name()));
+
+   // zigzag-encode signed values, so the sign bit ends up in the lowest bit
+   utype_t uvalue = std::is_signed<type_t>::value ? 
+               (utype_t) (((utype_t) value << 1) ^ (utype_t) (value >> (sizeof(type_t) * 8 - 1))) : 
+               (utype_t) value;
+
+   u_char *cp = (u_char*) ptr;
+
+   for(; uvalue >= 0x80; uvalue >>= 7)
+      *cp++ = (u_char) (uvalue | 0x80);
+
+   *cp++ = (u_char) uvalue;
+
+   return cp;
+}
+
+///
+/// A variable-length time stamp is stored as a flag byte, followed by the internal
+/// serial time and, for local time stamps, by the UTC offset, both of which are stored
+/// as signed variable-length integers. Time components are not stored individually,
+/// which makes a typical time stamp about half the size of a fixed-width one.
+///
+void *serializer_t::serialize_varint(void *ptr, const tstamp_t& tstamp) const
+{
+   ptr = serialize(ptr, (u_char) ((tstamp.null ? 0x01 : 0) | (tstamp.utc ? 0x02 : 0)));
+
+   if(tstamp.null)
+      return ptr;
+
+   ptr = serialize_varint<int64_t>(ptr, tstamp_t::mktime(tstamp.year, tstamp.month, tstamp.day, tstamp.hour, tstamp.min, tstamp.sec));
+
+   if(!tstamp.utc)
+      ptr = serialize_varint<int>(ptr, tstamp.offset);
+
+   return ptr;
+}
+
 const void *serializer_t::deserialize(const void *ptr, char chars[], size_t length) const
 {
    if(buffer_space(ptr) < length)
@@ -356,6 +492,78 @@ const void *serializer_t::deserialize(const void *ptr, bool& value) const
    return deserialize<u_char, bool>(ptr, value);
 }
 
+const void *serializer_t::deserialize(const void *ptr, ipaddr_t& ipaddr) const
+{
+   u_char family;
+
+   ptr = deserialize(ptr, family);
+
+   if(family > ipaddr_t::IPV6)
+      throw std::invalid_argument(string_t::_format("Bad IP address family (%d)", family));
+
+   ipaddr.family = (ipaddr_t::family_t) family;
+
+   memset(ipaddr.addr, 0, sizeof(ipaddr.addr));
+
+   return deserialize(ptr, (char*) ipaddr.addr, ipaddr.size());
+}
+
+template <typename type_t>
+const void *serializer_t::deserialize_varint(const void *ptr, type_t& value) const
+{
+   typedef typename std::make_unsigned<type_t>::type utype_t;
+
+   const u_char *cp = (const u_char*) ptr;
+   utype_t uvalue = 0;
+   u_int shift = 0;
+
+   do {
+      if(!buffer_space(cp))
+         throw std::invalid_argument(string_t::_format("Truncated data (varint %s)", typeid(value).name()));
+
+      // reject encodings that would not fit into the requested type
+      if(shift >= sizeof(type_t) * 8)
+         throw std::invalid_argument(string_t::_format("Bad variable-length integer (%s)", typeid(value).name()));
+
+      uvalue |= (utype_t) (*cp & 0x7F) << shift;
+      shift += 7;
+   } while(*cp++ & 0x80);
+
+   // undo zigzag encoding for signed values
+   value = std::is_signed<type_t>::value ? 
+               (type_t) ((uvalue >> 1) ^ (utype_t) -(type_t) (uvalue & 1)) : 
+               (type_t) uvalue;
+
+   return cp;
+}
+
+const void *serializer_t::deserialize_varint(const void *ptr, tstamp_t& tstamp) const
+{
+   u_char flags;
+   int64_t intime;
+   int offset;
+
+   ptr = deserialize(ptr, flags);
+
+   if(flags & 0x01) {
+      tstamp.reset();
+      return ptr;
+   }
+
+   ptr = deserialize_varint(ptr, intime);
+
+   if(flags & 0x02)
+      tstamp.reset((time_t) intime);
+   else {
+      ptr = deserialize_varint(ptr, offset);
+
+      // the serial time is stored without the offset applied (see serialize_varint)
+      tstamp.reset((time_t) (intime - offset * 60ll), offset);
+   }
+
+   return ptr;
+}
+
 //
 // Instantiate template functinos defined in this file
 //
@@ -380,6 +588,12 @@ template size_t serializer_t::s_size_of(u_int value);
 template size_t serializer_t::s_size_of(uint64_t value);
 template size_t serializer_t::s_size_of(double value);
 
+template size_t serializer_t::s_size_of_varint(u_short value);
+template size_t serializer_t::s_size_of_varint(u_int value);
+template size_t serializer_t::s_size_of_varint(uint64_t value);
+template size_t serializer_t::s_size_of_varint(int value);
+template size_t serializer_t::s_size_of_varint(int64_t value);
+
 template const void *serializer_t::s_skip_field<char(&)[2]>(const void *ptr) const;
 template const void *serializer_t::s_skip_field<u_char>(const void *ptr) const;
 template const void *serializer_t::s_skip_field<u_short>(const void *ptr) const;
@@ -398,6 +612,12 @@ template void *serializer_t::serialize(void *ptr, u_int value) const;
 template void *serializer_t::serialize(void *ptr, uint64_t value) const;
 template void *serializer_t::serialize(void *ptr, double value) const;
 
+template void *serializer_t::serialize_varint(void *ptr, u_short value) const;
+template void *serializer_t::serialize_varint(void *ptr, u_int value) const;
+template void *serializer_t::serialize_varint(void *ptr, uint64_t value) const;
+template void *serializer_t::serialize_varint(void *ptr, int value) const;
+template void *serializer_t::serialize_varint(void *ptr, int64_t value) const;
+
 template const void *serializer_t::deserialize<u_char, nodetype_t>(const void *ptr, nodetype_t& value) const;
 template const void *serializer_t::deserialize<short, int>(const void *ptr, int& value) const;
 template const void *serializer_t::deserialize<u_short, u_int>(const void *ptr, u_int& value) const;
@@ -409,3 +629,8 @@ template const void *serializer_t::deserialize(const void *ptr, u_int& value) co
 template const void *serializer_t::deserialize(const void *ptr, uint64_t& value) const;
 template const void *serializer_t::deserialize(const void *ptr, double& value) const;
 
+template const void *serializer_t::deserialize_varint(const void *ptr, u_short& value) const;
+template const void *serializer_t::deserialize_varint(const void *ptr, u_int& value) const;
+template const void *serializer_t::deserialize_varint(const void *ptr, uint64_t& value) const;
+template const void *serializer_t::deserialize_varint(const void *ptr, int& value) const;
+template const void *serializer_t::deserialize_varint(const void *ptr, int64_t& value) const;
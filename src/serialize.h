@@ -13,6 +13,7 @@
 #include "util_string.h"
 #include "tstring.h"
 #include "tstamp.h"
+#include "util_ipaddr.h"
 #include "types.h"
 
 #include <cstddef>
@@ -85,6 +86,9 @@ class serializer_t {
       /// Returns required storage size for a `bool` value.
       static size_t s_size_of(bool value);
 
+      /// Returns required storage size for an `ipaddr_t` instance.
+      static size_t s_size_of(const ipaddr_t& ipaddr);
+
       /// Cannot serialize arbitrary arrays of bytes. A two-character specialization is provided.
       template <size_t N>
       static size_t s_size_of(const char (&chars)[N]) = delete;
@@ -97,6 +101,24 @@ class serializer_t {
 
       /// @}
 
+      ///
+      /// @name   Variable-length data size methods
+      ///
+      /// Variable-length integers are stored as LEB128 sequences of 7-bit groups, least
+      /// significant group first, with the high bit set in all bytes, but the last one.
+      /// Signed values are zigzag-encoded, so small negative values remain short.
+      ///
+      /// @{
+
+      /// Returns required storage size for a variable-length integer.
+      template <typename type_t>
+      static size_t s_size_of_varint(type_t value);
+
+      /// Returns required storage size for a variable-length `tstamp_t` instance.
+      static size_t s_size_of_varint(const tstamp_t& tstamp);
+
+      /// @}
+
       ///
       /// @name   Serialized data size methods
       ///
@@ -120,6 +142,12 @@ class serializer_t {
       template <typename type_t>
       const void *s_skip_field(const void *ptr) const;
 
+      /// Skips a variable-length integer field and returns the position of the next field.
+      const void *s_skip_varint(const void *ptr) const;
+
+      /// Skips a variable-length `tstamp_t` field and returns the position of the next field.
+      const void *s_skip_varint_tstamp(const void *ptr) const;
+
       /// @}
       ///
       /// @name   Serialization methods
@@ -147,6 +175,16 @@ class serializer_t {
       /// Serializes a `bool` value and returns the position after the serialized field.
       void *serialize(void *ptr, bool value) const;
 
+      /// Serializes an `ipaddr_t` value and returns the position after the serialized field.
+      void *serialize(void *ptr, const ipaddr_t& ipaddr) const;
+
+      /// Serializes an integer as a variable-length value and returns the position after the serialized field.
+      template <typename type_t>
+      void *serialize_varint(void *ptr, type_t value) const;
+
+      /// Serializes a `tstamp_t` value with variable-length components and returns the position after the serialized field.
+      void *serialize_varint(void *ptr, const tstamp_t& tstamp) const;
+
       /// @}
 
       ///
@@ -178,6 +216,16 @@ class serializer_t {
       /// Deserializes a `bool` value and returns the position after the field that was just read.
       const void *deserialize(const void *ptr, bool& value) const;
 
+      /// Deserializes an `ipaddr_t` value and returns the position after the field that was just read.
+      const void *deserialize(const void *ptr, ipaddr_t& ipaddr) const;
+
+      /// Deserializes a variable-length integer and returns the position after the field that was just read.
+      template <typename type_t>
+      const void *deserialize_varint(const void *ptr, type_t& value) const;
+
+      /// Deserializes a variable-length `tstamp_t` value and returns the position after the field that was just read.
+      const void *deserialize_varint(const void *ptr, tstamp_t& tstamp) const;
+
       /// @}
 };
 
@@ -0,0 +1,195 @@
+/*
+    webalizer - a web server log analysis program
+
+    Copyright (c) 2004-2022, Stone Steps Inc. (www.stonesteps.ca)
+
+    See COPYING and Copyright files for additional licensing and copyright information
+
+    snapshot.cpp
+*/
+#include "pch.h"
+
+#include "snapshot.h"
+
+#include <cstring>
+
+snapshot_t::snapshot_t(void) :
+      file(nullptr),
+      offset(0),
+      error(false)
+{
+}
+
+snapshot_t::~snapshot_t(void)
+{
+   close();
+}
+
+///
+/// Any existing temporary file is truncated. The snapshot file itself is not changed
+/// until `commit` is called.
+///
+bool snapshot_t::create(const string_t& path, u_int appver, uint64_t checkpoint)
+{
+   header_t header = {SIGNATURE, FORMAT_VERSION, BYTE_ORDER_VALUE, appver, checkpoint};
+
+   close();
+
+   this->path = path;
+   tmp_path = path + ".tmp";
+
+   if((file = fopen(tmp_path, "wb")) == nullptr) {
+      error = true;
+      return false;
+   }
+
+   if(fwrite(&header, sizeof(header), 1, file) != 1) {
+      error = true;
+      return false;
+   }
+
+   return true;
+}
+
+bool snapshot_t::commit(void)
+{
+   if(!file)
+      return false;
+
+   if(fclose(file))
+      error = true;
+
+   file = nullptr;
+
+   if(error) {
+      ::remove(tmp_path);
+      return false;
+   }
+
+   // rename doesn't replace existing files on Windows
+   ::remove(path);
+
+   if(rename(tmp_path, path)) {
+      ::remove(tmp_path);
+      error = true;
+      return false;
+   }
+
+   return true;
+}
+
+///
+/// Returns `false` if the snapshot file doesn't exist, cannot be read, was created by
+/// a different application version or on a platform with a different byte order, or
+/// if it was not created for the specified checkpoint.
+///
+bool snapshot_t::open(const string_t& path, u_int appver, uint64_t checkpoint)
+{
+   header_t header;
+   FILE *snap_fp;
+   long filesize;
+
+   close();
+
+   if((snap_fp = fopen(path, "rb")) == nullptr)
+      return false;
+
+   // read the entire file in one go
+   if(fseek(snap_fp, 0, SEEK_END) == 0 && (filesize = ftell(snap_fp)) >= (long) sizeof(header_t) && fseek(snap_fp, 0, SEEK_SET) == 0) {
+      buffer.resize((size_t) filesize);
+
+      if(fread(buffer.data(), 1, buffer.size(), snap_fp) != buffer.size())
+         error = true;
+   }
+   else
+      error = true;
+
+   fclose(snap_fp);
+
+   if(error) {
+      close();
+      return false;
+   }
+
+   memcpy(&header, buffer.data(), sizeof(header));
+
+   if(header.signature != SIGNATURE || header.version != FORMAT_VERSION || header.byte_order != BYTE_ORDER_VALUE || header.appver != appver || header.checkpoint != checkpoint) {
+      close();
+      return false;
+   }
+
+   this->path = path;
+   offset = sizeof(header);
+
+   return true;
+}
+
+void snapshot_t::close(void)
+{
+   if(file) {
+      fclose(file);
+      file = nullptr;
+      ::remove(tmp_path);
+   }
+
+   buffer.clear();
+   buffer.shrink_to_fit();
+
+   offset = 0;
+   error = false;
+}
+
+bool snapshot_t::end_section(void)
+{
+   return write_record(nullptr, 0, 0);
+}
+
+bool snapshot_t::write_record(const void *data, uint32_t keysize, uint32_t datasize)
+{
+   record_t record = {keysize, datasize};
+
+   if(!file || error)
+      return false;
+
+   if(fwrite(&record, sizeof(record), 1, file) != 1 || (keysize + datasize && fwrite(data, keysize + datasize, 1, file) != 1)) {
+      error = true;
+      return false;
+   }
+
+   return true;
+}
+
+///
+/// Returns a pointer to the serialized key, followed by the serialized data, or a null
+/// pointer at the end of the section or if the record is out of file bounds.
+///
+const u_char *snapshot_t::read_record(uint32_t& keysize, uint32_t& datasize)
+{
+   record_t record;
+   const u_char *data;
+
+   if(error || buffer.size() - offset < sizeof(record)) {
+      error = true;
+      return nullptr;
+   }
+
+   memcpy(&record, buffer.data() + offset, sizeof(record));
+   offset += sizeof(record);
+
+   // an empty record terminates the section
+   if(!record.keysize && !record.datasize)
+      return nullptr;
+
+   if(!record.keysize || buffer.size() - offset < (size_t) record.keysize + record.datasize) {
+      error = true;
+      return nullptr;
+   }
+
+   data = buffer.data() + offset;
+   offset += (size_t) record.keysize + record.datasize;
+
+   keysize = record.keysize;
+   datasize = record.datasize;
+
+   return data;
+}
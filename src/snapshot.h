@@ -0,0 +1,175 @@
+/*
+    webalizer - a web server log analysis program
+
+    Copyright (c) 2004-2022, Stone Steps Inc. (www.stonesteps.ca)
+
+    See COPYING and Copyright files for additional licensing and copyright information
+
+    snapshot.h
+*/
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include "types.h"
+#include "tstring.h"
+#include "storable.h"
+
+#include <cstdio>
+#include <vector>
+
+///
+/// @brief  A state snapshot file containing the in-memory working set of the
+///         monthly state.
+///
+/// A snapshot file contains nodes serialized in the same format as they are stored
+/// in the state database, so node versions are handled the same way as for database
+/// records. Each record consists of the key size and the data size, followed by the
+/// serialized key and data. Records are grouped into sections, which are terminated
+/// by a record with zero key and data sizes.
+///
+/// A snapshot is tied to the state database by the checkpoint identifier stored in
+/// the snapshot header. A snapshot whose checkpoint doesn't match the checkpoint
+/// stored in the database is considered stale and cannot be opened.
+///
+/// A snapshot is written into a temporary file, which is renamed to the snapshot file
+/// only after all records have been written successfully. Any existing snapshot file
+/// is deleted before the rename, so the replacement is not atomic and a failed rename
+/// leaves no snapshot file behind.
+///
+/// A snapshot is read into memory in a single read and nodes are deserialized directly
+/// from the file buffer.
+///
+class snapshot_t {
+   private:
+      /// Snapshot file signature (`WSNP`).
+      static const u_int SIGNATURE = 0x504E5357u;
+
+      /// Snapshot format version.
+      static const u_int FORMAT_VERSION = 1;
+
+      /// The value used to detect a snapshot created on a platform with a different byte order.
+      static const u_int BYTE_ORDER_VALUE = 0x12345678u;
+
+      ///
+      /// @brief  Snapshot file header
+      ///
+      struct header_t {
+         u_int       signature;        ///< Snapshot file signature.
+         u_int       version;          ///< Snapshot format version.
+         u_int       byte_order;       ///< Byte order value.
+         u_int       appver;           ///< Application version that created this snapshot.
+         uint64_t    checkpoint;       ///< Checkpoint identifier stored in the state database.
+      };
+
+      ///
+      /// @brief  Record size header
+      ///
+      struct record_t {
+         uint32_t    keysize;          ///< Serialized key size, in bytes.
+         uint32_t    datasize;         ///< Serialized data size, in bytes.
+      };
+
+   private:
+      string_t             path;       ///< Snapshot file path.
+      string_t             tmp_path;   ///< Temporary file path while the snapshot is being written.
+
+      FILE                 *file;      ///< Temporary file being written.
+
+      std::vector<u_char>  buffer;     ///< File data being read or a node being serialized.
+      size_t               offset;     ///< Current read position in `buffer`.
+
+      bool                 error;      ///< Has any read or write failed?
+
+   private:
+      bool write_record(const void *data, uint32_t keysize, uint32_t datasize);
+
+      const u_char *read_record(uint32_t& keysize, uint32_t& datasize);
+
+   public:
+      snapshot_t(void);
+
+      ~snapshot_t(void);
+
+      /// Creates a temporary snapshot file for the specified checkpoint.
+      bool create(const string_t& path, u_int appver, uint64_t checkpoint);
+
+      /// Closes the temporary file, deletes the existing snapshot file and renames the temporary file to take its place.
+      bool commit(void);
+
+      /// Reads the snapshot file into memory if it was written for the specified checkpoint.
+      bool open(const string_t& path, u_int appver, uint64_t checkpoint);
+
+      /// Discards a temporary file, if one is being written, and releases file data.
+      void close(void);
+
+      /// Returns `true` if any read or write failed.
+      bool is_error(void) const {return error;}
+
+      /// Serializes a node and writes it into the snapshot.
+      template <typename node_t>
+      bool write_node(const node_t& node);
+
+      /// Writes an empty record that marks the end of the current section.
+      bool end_section(void);
+
+      /// Deserializes the next node in the current section.
+      template <typename node_t, typename ... param_t>
+      bool read_node(storable_t<node_t>& node, typename node_t::template s_unpack_cb_t<param_t ...> upcb = nullptr, param_t ... param);
+};
+
+///
+/// Returns `false` if the node cannot be serialized or written. The snapshot becomes
+/// unusable after any write error and `commit` will fail.
+///
+template <typename node_t>
+bool snapshot_t::write_node(const node_t& node)
+{
+   size_t keysize = node.s_key_size(), datasize = node.s_data_size();
+
+   if(error)
+      return false;
+
+   if(buffer.size() < keysize + datasize)
+      buffer.resize(keysize + datasize);
+
+   if(node.s_pack_key(buffer.data(), keysize) != keysize || node.s_pack_data(buffer.data() + keysize, datasize) != datasize) {
+      error = true;
+      return false;
+   }
+
+   return write_record(buffer.data(), (uint32_t) keysize, (uint32_t) datasize);
+}
+
+///
+/// Returns `false` at the end of the current section or if the node cannot be read.
+/// The caller should call `is_error` to tell one from another. Nodes read from the
+/// snapshot are marked as coming from the storage, same as nodes read from the state
+/// database.
+///
+/// Node deserialization may throw exceptions for malformed node data.
+///
+template <typename node_t, typename ... param_t>
+bool snapshot_t::read_node(storable_t<node_t>& node, typename node_t::template s_unpack_cb_t<param_t ...> upcb, param_t ... param)
+{
+   uint32_t keysize, datasize;
+   const u_char *record;
+
+   if((record = read_record(keysize, datasize)) == nullptr)
+      return false;
+
+   if(node.s_unpack_key(record, keysize) != keysize) {
+      error = true;
+      return false;
+   }
+
+   if(node.template s_unpack_data<param_t...>(record + keysize, datasize, upcb, std::forward<param_t>(param) ...) != datasize) {
+      error = true;
+      return false;
+   }
+
+   node.storage_info.set_from_storage();
+
+   return true;
+}
+
+#endif // SNAPSHOT_H
@@ -0,0 +1,97 @@
+/*
+    webalizer - a web server log analysis program
+
+    Copyright (c) 2004-2022, Stone Steps Inc. (www.stonesteps.ca)
+
+    See COPYING and Copyright files for additional licensing and copyright information
+
+    srch_args.cpp
+*/
+#include "pch.h"
+
+#include "srch_args.h"
+#include "util_string.h"
+
+#include <algorithm>
+
+///
+/// @brief  Compares names of the two search arguments and returns a zero if they 
+///         are equal, a negative value if the `e1` name is less than the `e2` name
+///         or a positive value if the `e1` name is greater than the `e2` name.
+///
+int arginfo_t::name_cmp(const arginfo_t *e1, const arginfo_t *e2)
+{
+   if(!e1 && !e2)
+      return 0;
+
+   if(!e1 || !e2)
+      return e1 ? 1 : -1;
+
+   return strncmp_ex(e1->name(), e1->namelen, e2->name(), e2->namelen);
+}
+
+///
+/// @brief  Compares the two search arguments and returns a zero if they are equal, 
+///         a negative value if `e1` is less than `e2` or a positive value if `e1` 
+///         is greater than `e2`.
+///
+int arginfo_t::arg_cmp(const arginfo_t *e1, const arginfo_t *e2)
+{
+   if(!e1 && !e2)
+      return 0;
+
+   if(!e1 || !e2)
+      return e1 ? 1 : -1;
+
+   if(!e1->arg && !e2->arg)
+      return 0;
+
+   if(!e1->arg || !e2->arg)
+      return e1->arg ? 1 : -1;
+
+   return strncmp_ex(e1->arg, e1->arglen, e2->arg, e2->arglen);
+}
+
+///
+/// @brief  Appends a search argument descriptor to the array.
+///
+void srch_args_t::push_back(const arginfo_t& arginfo)
+{
+   if(args == fixed) {
+      if(count < FIXED_SIZE) {
+         args[count++] = arginfo;
+         return;
+      }
+
+      // move all descriptors into the vector, which may have capacity from previous records
+      spill.assign(fixed, fixed + count);
+   }
+
+   spill.push_back(arginfo);
+
+   args = spill.data();
+   count++;
+}
+
+///
+/// @brief  Sorts search arguments by name, preserving the original order of arguments 
+///         with the same name.
+///
+void srch_args_t::sort_by_name(void)
+{
+   // there are rarely more than a few search arguments, so insertion sort is the fastest
+   if(count > FIXED_SIZE) {
+      std::stable_sort(begin(), end(), [] (const arginfo_t& e1, const arginfo_t& e2) {return arginfo_t::name_cmp(&e1, &e2) < 0;});
+      return;
+   }
+
+   for(size_t i = 1; i < count; i++) {
+      arginfo_t arginfo = args[i];
+      size_t k = i;
+
+      for(; k > 0 && arginfo_t::name_cmp(&args[k-1], &arginfo) > 0; k--)
+         args[k] = args[k-1];
+
+      args[k] = arginfo;
+   }
+}
@@ -0,0 +1,107 @@
+/*
+    webalizer - a web server log analysis program
+
+    Copyright (c) 2004-2022, Stone Steps Inc. (www.stonesteps.ca)
+
+    See COPYING and Copyright files for additional licensing and copyright information
+
+    srch_args.h
+*/
+#ifndef SRCH_ARGS_H
+#define SRCH_ARGS_H
+
+#include <vector>
+#include <cstddef>
+
+///
+/// @brief  A URL search argument descriptor
+///
+/// A search argument descriptor that points to the beginning of a search argument 
+/// within a query string. The descriptor does not own memory contaiing the search 
+/// argument and must have shorter life span than the underlying query string.
+///
+/// Pointers returned from `name` and `value` methods should not be used in pointer
+/// arithmetic because they may return pointer values outside of the query string 
+/// range. Neither method ever returns a nullptr pointer.
+///
+struct arginfo_t {
+   const char  *arg;             ///< Points to a search argument within the query string
+   size_t      namelen;          ///< Search argument name length
+   size_t      arglen;           ///< Entire search argument length, including name and value
+   
+   /// Constructs an empty search argument descriptor.
+   arginfo_t(void) : arg(nullptr), namelen(0), arglen(0) {}
+
+   /// Constructs a complete search argument descriptor
+   arginfo_t(const char *arg, size_t namelen, size_t arglen) : arg(arg), namelen(namelen), arglen(arglen) {}
+
+   /// Returns a pointer to the search argument name or an empty string if there is none.
+   const char *name(void) const
+   {
+      return namelen ? arg : "";
+   }
+
+   /// Returns the length of the search argument value (zero if there is no value).
+   size_t value_length(void) const 
+   {
+      // value is present only if there is an equal sign, even if namelen is zero
+      return namelen == arglen ? 0 : arglen - namelen - 1;
+   }
+
+   /// Return a pointer to the search argument value or an empty string, if there is none.
+   const char *value(void) const
+   {
+      return namelen == arglen ? "" : arg + namelen + 1;
+   }
+
+   static int name_cmp(const arginfo_t *e1, const arginfo_t *e2);
+
+   static int arg_cmp(const arginfo_t *e1, const arginfo_t *e2);
+};
+
+///
+/// @brief  An array of search argument descriptors for one query string
+///
+/// Query strings are tokenized into a fixed-capacity array, which covers practically 
+/// all query strings without any memory allocations. If a query string has more 
+/// arguments, descriptors are moved into a vector, which keeps its capacity when the
+/// array is cleared, so the same array instance should be reused for all log records.
+///
+class srch_args_t {
+   public:
+      static const size_t FIXED_SIZE = 32;   ///< Number of descriptors stored without allocations
+
+   private:
+      arginfo_t               fixed[FIXED_SIZE];
+      std::vector<arginfo_t>  spill;
+      arginfo_t               *args;
+      size_t                  count;
+
+   public:
+      srch_args_t(void) : args(fixed), count(0) {}
+
+      srch_args_t(const srch_args_t& other) = delete;
+
+      srch_args_t& operator = (const srch_args_t& other) = delete;
+
+      void push_back(const arginfo_t& arginfo);
+
+      void clear(void) {args = fixed; count = 0; spill.clear();}
+
+      bool empty(void) const {return count == 0;}
+
+      size_t size(void) const {return count;}
+
+      arginfo_t *begin(void) {return args;}
+      const arginfo_t *begin(void) const {return args;}
+
+      arginfo_t *end(void) {return args + count;}
+      const arginfo_t *end(void) const {return args + count;}
+
+      arginfo_t& operator [] (size_t index) {return args[index];}
+      const arginfo_t& operator [] (size_t index) const {return args[index];}
+
+      void sort_by_name(void);
+};
+
+#endif // SRCH_ARGS_H
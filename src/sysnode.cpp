@@ -34,6 +34,11 @@ sysnode_t::sysnode_t(void) : keynode_t<uint32_t>(1)
 
    utc_time = true;
    utc_offset = 0; 
+   checkpoint = 0;
+
+   compact_table = 0;
+
+   cache_wset = 0;
 }
 
 void sysnode_t::reset(const config_t& config)
@@ -59,6 +64,12 @@ void sysnode_t::reset(const config_t& config)
 
    utc_time = !config.local_time;
    utc_offset = config.utc_offset; 
+   checkpoint = 0;
+
+   compact_table = 0;
+   compact_key.reset();
+
+   cache_wset = 0;
 }
 
 bool sysnode_t::check_size_of(void) const
@@ -109,7 +120,11 @@ size_t sysnode_t::s_data_size(void) const
             sizeof(u_char)       +     // utc_time
             sizeof(short)        +     // utc_offset
             sizeof(u_short)      +     // sizeof_longlong
-            sizeof(uint64_t)     ;     // byte_order_x64
+            sizeof(uint64_t)     +     // byte_order_x64
+            sizeof(uint64_t)     +     // checkpoint
+            sizeof(u_int)        +     // compact_table
+            serializer_t::s_size_of(compact_key) +  // compact_key
+            sizeof(uint64_t)     ;     // cache_wset
 }
 
 size_t sysnode_t::s_pack_data(void *buffer, size_t bufsize) const
@@ -141,6 +156,12 @@ size_t sysnode_t::s_pack_data(void *buffer, size_t bufsize) const
 
    ptr = sr.serialize(ptr, sizeof_longlong);
    ptr = sr.serialize(ptr, byte_order_x64);
+   ptr = sr.serialize(ptr, checkpoint);
+
+   ptr = sr.serialize(ptr, compact_table);
+   ptr = sr.serialize(ptr, compact_key);
+
+   ptr = sr.serialize(ptr, cache_wset);
 
    return sr.data_size(ptr);
 }
@@ -212,6 +233,25 @@ size_t sysnode_t::s_unpack_data(const void *buffer, size_t bufsize, s_unpack_cb_
       byte_order_x64 = 0x1234567890ABCDEFull;
    }
 
+   if(version >= 7)
+      ptr = sr.deserialize(ptr, checkpoint);
+   else
+      checkpoint = 0;
+
+   if(version >= 8) {
+      ptr = sr.deserialize(ptr, compact_table);
+      ptr = sr.deserialize(ptr, compact_key);
+   }
+   else {
+      compact_table = 0;
+      compact_key.reset();
+   }
+
+   if(version >= 9)
+      ptr = sr.deserialize(ptr, cache_wset);
+   else
+      cache_wset = 0;
+
    if(upcb)
       upcb(*this, std::forward<param_t>(param) ...);
 
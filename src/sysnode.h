@@ -46,6 +46,12 @@ struct sysnode_t : public keynode_t<uint32_t>, datanode_t<sysnode_t> {
 
    bool        utc_time;            ///< UTC or local time?
    int         utc_offset;          ///< UTC offset in minutes if local time
+   uint64_t    checkpoint;          ///< State snapshot checkpoint (zero if there is no snapshot)
+
+   u_int       compact_table;       ///< Table where incremental compaction will continue
+   string_t    compact_key;         ///< Serialized primary key where incremental compaction will continue (empty for the first key)
+
+   uint64_t    cache_wset;          ///< Database cache working set measured in the last run, in bytes
 
    public:
       template <typename ... param_t>
@@ -14,6 +14,8 @@
 #include "../hnode.h"
 
 #include <memory>
+#include <cstdio>
+#include <future>
 
 namespace sswtest {
 
@@ -44,6 +46,50 @@ class test_config_t : public berkeleydb_t::config_t {
       uint32_t get_db_seq_cache_size(void) const override {return 0;}
 
       bool get_db_direct(void) const override {return false;}
+
+      bool get_db_txn(void) const override {return false;}
+
+      bool get_db_read_only(void) const override {return false;}
+};
+
+///
+/// @brief  A test database configuration object for a database file in the
+///         temporary directory.
+///
+class test_file_config_t : public berkeleydb_t::config_t {
+   private:
+      const string_t db_dir;
+      const string_t db_name;
+      const string_t db_path;
+
+      bool db_txn;
+      bool db_read_only;
+
+   public:
+      test_file_config_t(const string_t& db_dir, const string_t& db_name, bool db_txn, bool db_read_only) : 
+            db_dir(db_dir), db_name(db_name), db_path(db_dir + db_name), db_txn(db_txn), db_read_only(db_read_only) {}
+
+      const test_file_config_t& clone(void) const override {return *new test_file_config_t(db_dir, db_name, db_txn, db_read_only);}
+
+      void release(void) const override {delete this;}
+
+      const string_t& get_db_path(void) const override {return db_path;}
+
+      const string_t& get_db_dir(void) const override {return db_dir;}
+
+      const string_t& get_db_name(void) const override {return db_name;}
+
+      const string_t& get_tmp_path(void) const override {return db_dir;}
+
+      uint32_t get_db_cache_size(void) const override {return 0;}
+
+      uint32_t get_db_seq_cache_size(void) const override {return 0;}
+
+      bool get_db_direct(void) const override {return false;}
+
+      bool get_db_txn(void) const override {return db_txn;}
+
+      bool get_db_read_only(void) const override {return db_read_only;}
 };
 
 ///
@@ -330,6 +376,346 @@ TEST_F(BerkeleyDBTest, AgentNodeReadCallback)
    }
 }
 
+///
+/// @brief  Incremental compaction stops after the requested number of pages were
+///         freed, continues at the returned key in subsequent calls and moves on
+///         to the next table, wrapping around to the first one, once the end of
+///         a table was reached.
+///
+TEST_F(BerkeleyDBTest, IncrementalCompaction)
+{
+   berkeleydb_t::status_t status;
+   storable_t<anode_t> anode;
+   string_t key;
+   u_int tblidx, bytes;
+   size_t calls = 0;
+
+   PopulateTable<anode_t>("agents", agents, "Agent ", 1, 1000, HitCountValueX10, OBJ_REG, false);
+   PopulateTable<hnode_t>("hosts", hosts, "Host ", 1, 10, HitCountValueX10, OBJ_REG);
+
+   //
+   // Delete most of the agents, so there are pages to free. Node IDs are serialized
+   // in the native byte order, so keys of remaining agents, where compaction stops,
+   // start with a zero byte on little-endian platforms.
+   //
+   for(uint64_t i = 1; i <= 1000; i++) {
+      if(i % 256) {
+         anode.nodeid = i;
+         ASSERT_TRUE(agents.delete_node(anode)) << "Agent nodes should be deleted without an error";
+      }
+   }
+
+   // a position that doesn't match any of the tables should start over at the first table
+   tblidx = 5;
+   key = "stale key";
+
+   ASSERT_TRUE((status = bdb.compact(1, tblidx, key, bytes)).success()) << "Compaction should not fail";
+   ASSERT_EQ(0, tblidx) << "Compaction should start over at the first table for an invalid table index";
+   ASSERT_FALSE(key.isempty()) << "Compaction should stop within the first table after freeing one page";
+
+   // continue where the last call stopped until the end of the last table is reached
+   while(!key.isempty() && ++calls < 1000) {
+      ASSERT_EQ(0, tblidx) << "Compaction should continue in the same table until its end is reached";
+      ASSERT_TRUE((status = bdb.compact(1, tblidx, key, bytes)).success()) << "Compaction should not fail";
+   }
+
+   EXPECT_LT(1, calls) << "Compaction of the first table should take more than one call";
+   EXPECT_EQ(0, tblidx) << "Compaction should wrap around to the first table after the last one";
+
+   for(uint64_t i = 256; i <= 1000; i += 256) {
+      anode.nodeid = i;
+      ASSERT_TRUE(agents.get_node_by_id(anode)) << "Remaining agent nodes should be found after compaction";
+      EXPECT_EQ(i * 10, anode.count) << "Remaining agent nodes should not change after compaction";
+      anode.reset();
+   }
+}
+
+///
+/// @brief  Compaction of empty tables completes in one call and leaves the position
+///         at the table where it started.
+///
+TEST_F(BerkeleyDBTest, IncrementalCompactionEmptyTables)
+{
+   berkeleydb_t::status_t status;
+   string_t key;
+   u_int tblidx = 1, bytes = 1;
+
+   PopulateTable<anode_t>("agents", agents, "Agent ", 1, 0, HitCountValueX10, OBJ_REG, false);
+   PopulateTable<hnode_t>("hosts", hosts, "Host ", 1, 0, HitCountValueX10, OBJ_REG);
+
+   ASSERT_TRUE((status = bdb.compact(1, tblidx, key, bytes)).success()) << "Compaction of empty tables should not fail";
+
+   EXPECT_TRUE(key.isempty()) << "Compaction of empty tables should reach the end of each table";
+   EXPECT_EQ(1, tblidx) << "Compaction should go through all tables and stop at the table where it started";
+   EXPECT_EQ(0, bytes) << "No pages should be freed in empty tables";
+}
+
+///
+/// @brief  A test fixture that opens a Berkeley DB database file in the temporary
+///         directory, so it can be closed and opened again within a test, and
+///         removes the database and transaction log files after each test.
+///
+class BerkeleyDBFileTest : public ::testing::Test {
+   protected:
+      ///
+      /// @brief  A database with a single table that is opened and closed within
+      ///         one test step.
+      ///
+      struct test_db_t {
+         berkeleydb_t            bdb;
+         berkeleydb_t::table_t   agents;
+
+         test_db_t(const string_t& db_dir, const string_t& db_name, bool db_txn, bool db_read_only) :
+               bdb(test_file_config_t(db_dir, db_name, db_txn, db_read_only)),
+               agents(bdb.make_table())
+         {
+         }
+      };
+
+   protected:
+      /// The number of records written before a non-atomic transaction is committed.
+      static constexpr size_t max_writes = berkeleydb_t::TXN_MAX_WRITES;
+
+      const string_t db_dir;
+      const string_t db_name;
+
+   protected:
+      BerkeleyDBFileTest(void) : 
+            db_dir(testing::TempDir().c_str()),
+            db_name("ut_berkeleydb.db")
+      {
+      }
+
+      ~BerkeleyDBFileTest(void)
+      {
+         remove(db_dir + db_name);
+
+         // log files are numbered sequentially, starting from one
+         for(u_int i = 1; remove(db_dir + string_t::_format("log.%010u", i)) == 0; i++);
+      }
+
+      /// Opens the database and the agent table, which is created if it doesn't exist.
+      void OpenDatabase(test_db_t& db)
+      {
+         berkeleydb_t::status_t status;
+
+         ASSERT_NO_THROW((status = db.bdb.open({&db.agents}))) << "A database should open without throwing any exception";
+         ASSERT_EQ(0, status.err_num()) << "A database should open without an error";
+
+         ASSERT_NO_THROW((status = db.agents.open("agents", &bt_compare_cb<anode_t::s_compare_key>))) << "A database table should open without throwing an exception";
+         ASSERT_EQ(0, status.err_num()) << "A database table should open without an error";
+      }
+
+      /// Closes the database and all its tables.
+      void CloseDatabase(test_db_t& db)
+      {
+         berkeleydb_t::status_t status;
+
+         ASSERT_NO_THROW((status = db.bdb.close())) << "A database should close without throwing an exception";
+         ASSERT_EQ(0, status.err_num()) << "A database should close without an error";
+      }
+
+      /// Stores agent nodes with node IDs from `first` to `last` and hit counts of node IDs multiplied by `hits`.
+      bool PutAgents(test_db_t& db, uint64_t first, uint64_t last, uint64_t hits)
+      {
+         for(uint64_t i = first; i <= last; i++) {
+            std::string key = "Agent " + std::to_string(i);
+            storable_t<anode_t> anode(string_t::hold(key.c_str(), key.length()), OBJ_REG, false);
+
+            anode.nodeid = i;
+            anode.count = i * hits;
+
+            if(!db.agents.put_node<anode_t>(anode, anode.storage_info))
+               return false;
+         }
+
+         return true;
+      }
+
+      /// Returns the number of agent nodes with node IDs from `first` to `last` that have hit counts of node IDs multiplied by `hits`.
+      uint64_t CountAgents(test_db_t& db, uint64_t first, uint64_t last, uint64_t hits)
+      {
+         storable_t<anode_t> anode;
+         uint64_t count = 0;
+
+         for(uint64_t i = first; i <= last; i++) {
+            anode.nodeid = i;
+
+            if(db.agents.get_node_by_id(anode) && anode.count == i * hits && ("Agent " + std::to_string(i)) == anode.string.c_str())
+               count++;
+
+            anode.reset();
+         }
+
+         return count;
+      }
+};
+
+///
+/// @brief  Updates committed in an atomic transaction are found after the database
+///         is opened again and updates in a transaction that was not committed are
+///         rolled back, even if there are more of them than would fit into a single
+///         non-atomic transaction.
+///
+TEST_F(BerkeleyDBFileTest, AtomicTransactionCommitAndAbort)
+{
+   berkeleydb_t::status_t status;
+
+   {test_db_t db(db_dir, db_name, true, false);
+
+   OpenDatabase(db);
+
+   ASSERT_TRUE((status = db.bdb.begin_transaction(true)).success()) << "A transaction should begin without an error";
+   ASSERT_TRUE(PutAgents(db, 1, 100, 10)) << "Agent nodes should be stored without an error";
+   ASSERT_TRUE((status = db.bdb.commit_transaction()).success()) << "A transaction should be committed without an error";
+
+   CloseDatabase(db);}
+
+   {test_db_t db(db_dir, db_name, true, false);
+
+   OpenDatabase(db);
+
+   EXPECT_EQ(100, CountAgents(db, 1, 100, 10)) << "Committed agent nodes should be found after the database is opened again";
+
+   //
+   // Update committed nodes and insert more nodes than a single non-atomic transaction
+   // may hold, which must not be committed part way, and close the database before the
+   // transaction is committed, which aborts it.
+   //
+   ASSERT_TRUE((status = db.bdb.begin_transaction(true)).success()) << "A transaction should begin without an error";
+   ASSERT_TRUE(PutAgents(db, 1, 100, 20)) << "Agent nodes should be updated without an error";
+   ASSERT_TRUE(PutAgents(db, 101, 100 + max_writes, 10)) << "Agent nodes should be stored without an error";
+
+   EXPECT_EQ(100, CountAgents(db, 1, 100, 20)) << "Updated agent nodes should be visible within the transaction";
+
+   CloseDatabase(db);}
+
+   {test_db_t db(db_dir, db_name, true, false);
+
+   OpenDatabase(db);
+
+   EXPECT_EQ(100, CountAgents(db, 1, 100, 10)) << "Agent nodes should have values committed before the aborted transaction";
+   EXPECT_EQ(0, CountAgents(db, 101, 100 + max_writes, 10)) << "Agent nodes inserted in the aborted transaction should not be found";
+
+   CloseDatabase(db);}
+}
+
+///
+/// @brief  A non-atomic transaction is committed in parts, so only the updates
+///         written after the last part was committed are rolled back when the
+///         transaction is aborted.
+///
+TEST_F(BerkeleyDBFileTest, NonAtomicTransactionAbort)
+{
+   berkeleydb_t::status_t status;
+
+   {test_db_t db(db_dir, db_name, true, false);
+
+   OpenDatabase(db);
+
+   ASSERT_TRUE((status = db.bdb.begin_transaction(false)).success()) << "A transaction should begin without an error";
+   ASSERT_TRUE(PutAgents(db, 1, max_writes + 100, 10)) << "Agent nodes should be stored without an error";
+
+   CloseDatabase(db);}
+
+   {test_db_t db(db_dir, db_name, true, false);
+
+   OpenDatabase(db);
+
+   EXPECT_EQ(max_writes, CountAgents(db, 1, max_writes + 100, 10)) << "Only agent nodes in the committed part of the transaction should be found";
+
+   CloseDatabase(db);}
+}
+
+///
+/// @brief  A database opened read-only can be read, without opening any sequences,
+///         but nodes cannot be written into it or deleted from it.
+///
+TEST_F(BerkeleyDBFileTest, ReadOnlyDatabase)
+{
+   {test_db_t db(db_dir, db_name, false, false);
+
+   OpenDatabase(db);
+
+   ASSERT_TRUE(PutAgents(db, 1, 100, 10)) << "Agent nodes should be stored without an error";
+
+   CloseDatabase(db);}
+
+   {test_db_t db(db_dir, db_name, false, true);
+
+   OpenDatabase(db);
+
+   EXPECT_EQ(100, CountAgents(db, 1, 100, 10)) << "Agent nodes should be found in a read-only database";
+
+   EXPECT_FALSE(PutAgents(db, 1, 1, 20)) << "Agent nodes should not be updated in a read-only database";
+   EXPECT_FALSE(PutAgents(db, 101, 101, 10)) << "Agent nodes should not be inserted into a read-only database";
+
+   storable_t<anode_t> anode;
+   anode.nodeid = 1;
+
+   EXPECT_FALSE(db.agents.delete_node(anode)) << "Agent nodes should not be deleted from a read-only database";
+
+   CloseDatabase(db);}
+
+   {test_db_t db(db_dir, db_name, false, false);
+
+   OpenDatabase(db);
+
+   EXPECT_EQ(100, CountAgents(db, 1, 100, 10)) << "Agent nodes should not be changed or deleted by failed writes";
+   EXPECT_EQ(0, CountAgents(db, 101, 101, 10)) << "Agent nodes should not be inserted by failed writes";
+
+   CloseDatabase(db);}
+}
+
+///
+/// @brief  A database file renamed after it was closed can be opened without
+///         transactions and read on a separate thread, while a transactional 
+///         database with the original name is written in the same directory.
+///
+TEST_F(BerkeleyDBFileTest, RolledOverDatabaseOnAnotherThread)
+{
+   const string_t rolled_name("ut_berkeleydb_202301.db");
+
+   remove(db_dir + rolled_name);
+
+   {test_db_t db(db_dir, db_name, true, false);
+
+   OpenDatabase(db);
+
+   ASSERT_TRUE(PutAgents(db, 1, 1000, 10)) << "Agent nodes should be stored without an error";
+
+   CloseDatabase(db);}
+
+   ASSERT_EQ(0, rename(db_dir + db_name, db_dir + rolled_name)) << "A closed database file should be renamed without an error";
+
+   {test_db_t db(db_dir, db_name, true, false);
+   test_db_t rolled_db(db_dir, rolled_name, false, false);
+
+   OpenDatabase(db);
+
+   // read the renamed database on another thread
+   std::future<uint64_t> reader = std::async(std::launch::async, [this, &rolled_db] () -> uint64_t
+   {
+      berkeleydb_t::status_t status;
+
+      if(!(status = rolled_db.bdb.open({&rolled_db.agents})).success() || !(status = rolled_db.agents.open("agents", &bt_compare_cb<anode_t::s_compare_key>)).success())
+         return 0;
+
+      uint64_t count = CountAgents(rolled_db, 1, 1000, 10);
+
+      return rolled_db.bdb.close().success() ? count : 0;
+   });
+
+   EXPECT_TRUE(PutAgents(db, 1, 1000, 20)) << "Agent nodes should be stored in the new database while the renamed one is being read";
+
+   EXPECT_EQ(1000, reader.get()) << "All agent nodes should be found in the renamed database";
+   EXPECT_EQ(1000, CountAgents(db, 1, 1000, 20)) << "Agent nodes should be found in the new database";
+
+   CloseDatabase(db);}
+
+   EXPECT_EQ(0, remove(db_dir + rolled_name)) << "The renamed database file should be removed";
+}
+
 }
 
 #include "../database_tmpl.cpp"
@@ -26,6 +26,25 @@ class ConfigTest : public testing::Test {
       config_t    config;
 };
 
+///
+/// @brief  Tests when search engine patterns are matched against referrer host names.
+///
+TEST_F(ConfigTest, SearchEngineHostMatch)
+{
+   config.search_list.add_glist("www.google.\tq=", true);
+   config.search_list.add_glist("excite\tsearch=", true);
+
+   EXPECT_FALSE(config.is_srch_host_match()) << "Search engine patterns should be matched against entire URLs by default";
+
+   config.srch_host_match = true;
+
+   EXPECT_TRUE(config.is_srch_host_match()) << "Host name patterns should be matched against host names if SearchEngineHostMatch is set to 'yes'";
+
+   config.search_list.add_glist("example.com/search\tq=", true);
+
+   EXPECT_FALSE(config.is_srch_host_match()) << "A path in a pattern should require entire URL matching regardless of SearchEngineHostMatch";
+}
+
 ///
 /// @brief  Tests how well HTTP port values map to URL types.
 ///
@@ -163,6 +182,32 @@ TEST_F(ConfigTest, GetInterval)
    errors.clear();
 }
 
+///
+/// @brief  Tests that the automatic database cache size is 25% larger than the
+///         working set and is kept between 1 MB and four times the configured
+///         cache size.
+///
+TEST_F(ConfigTest, AutoDbCacheSize)
+{
+   const uint32_t MB = 1024 * 1024;
+
+   config.db_cache_size = 50 * MB;
+
+   EXPECT_EQ(10 * MB, config.get_auto_db_cache_size(8 * MB)) << "The cache should be 25% larger than the working set";
+   EXPECT_EQ(200 * MB, config.get_auto_db_cache_size(160 * MB)) << "The cache may be as large as four times the configured size";
+
+   // lower limit
+   EXPECT_EQ(1 * MB, config.get_auto_db_cache_size(0)) << "An empty working set should result in the smallest cache";
+   EXPECT_EQ(1 * MB, config.get_auto_db_cache_size(512 * 1024)) << "The cache should not be smaller than 1 MB";
+
+   // upper limit
+   EXPECT_EQ(200 * MB, config.get_auto_db_cache_size(161 * MB)) << "The cache should not be larger than four times the configured size";
+
+   config.db_cache_size = 2000 * MB;
+
+   EXPECT_EQ(UINT32_MAX, config.get_auto_db_cache_size(UINT64_C(10000) * MB)) << "The cache size should not overflow 32 bits";
+}
+
 ///
 /// @brief  Tests UTC/DST offsets for a few DST ranges
 ///
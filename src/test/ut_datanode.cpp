@@ -0,0 +1,592 @@
+/*
+   webalizer - a web server log analysis program
+
+   Copyright (c) 2004-2022, Stone Steps Inc. (www.stonesteps.ca)
+
+   See COPYING and Copyright files for additional licensing and copyright information 
+   
+   ut_datanode.cpp
+*/
+#include "pch.h"
+
+#include "../hnode.h"
+#include "../unode.h"
+#include "../anode.h"
+#include "../sysnode.h"
+#include "../serialize.h"
+#include "../util_url.h"
+#include "../tstring.h"
+
+namespace sswtest {
+
+///
+/// @brief  Tests that a host node packed in the current data version is restored
+///         intact and that secondary database field extractors find indexed fields.
+///
+TEST(DataNode, HostNodePackUnpack)
+{
+   string_t::char_buffer_t buffer(1024);
+
+   hnode_t hnode(string_t::hold("192.168.1.1"), OBJ_REG);
+
+   hnode.count = 12345678901ull;
+   hnode.files = 10;
+   hnode.pages = 300;
+   hnode.xfer = 9876543210ull;
+   hnode.visits = 2;
+   hnode.visits_conv = 1;
+   hnode.visit_avg = 12.5;
+   hnode.visit_max = 3600;
+   hnode.max_v_hits = 150;
+   hnode.max_v_files = 20;
+   hnode.max_v_pages = 15;
+   hnode.max_v_xfer = 123456;
+   hnode.robot = true;
+   hnode.tstamp.reset(2022, 3, 4, 5, 6, 7, -300);
+   hnode.name = "host.example.com";
+   hnode.set_ccode("ca");
+   hnode.city = "Toronto";
+   hnode.latitude = 43.7;
+   hnode.longitude = -79.4;
+   hnode.geoname_id = 6167865;
+   hnode.as_num = 64512;
+   hnode.as_org = "Example";
+
+   size_t datasize = hnode.s_pack_data(buffer, buffer.capacity());
+
+   // computed data size must be exact, so we don't overestimate memory use and buffer sizes
+   ASSERT_EQ(hnode.s_data_size(), datasize);
+
+   hnode_t unpacked;
+
+   ASSERT_EQ(datasize, unpacked.s_unpack_data(buffer, datasize, (hnode_t::s_unpack_cb_t<>) nullptr));
+
+   EXPECT_STREQ(hnode.string.c_str(), unpacked.string.c_str());
+   EXPECT_EQ(hnode.count, unpacked.count);
+   EXPECT_EQ(hnode.files, unpacked.files);
+   EXPECT_EQ(hnode.pages, unpacked.pages);
+   EXPECT_EQ(hnode.xfer, unpacked.xfer);
+   EXPECT_EQ(hnode.visits, unpacked.visits);
+   EXPECT_EQ(hnode.visits_conv, unpacked.visits_conv);
+   EXPECT_EQ(hnode.visit_avg, unpacked.visit_avg);
+   EXPECT_EQ(hnode.visit_max, unpacked.visit_max);
+   EXPECT_EQ(hnode.max_v_hits, unpacked.max_v_hits);
+   EXPECT_EQ(hnode.max_v_files, unpacked.max_v_files);
+   EXPECT_EQ(hnode.max_v_pages, unpacked.max_v_pages);
+   EXPECT_EQ(hnode.max_v_xfer, unpacked.max_v_xfer);
+   EXPECT_EQ(hnode.robot, unpacked.robot);
+   EXPECT_EQ(hnode.tstamp, unpacked.tstamp);
+   EXPECT_EQ(hnode.tstamp.offset, unpacked.tstamp.offset);
+   EXPECT_STREQ(hnode.name.c_str(), unpacked.name.c_str());
+   EXPECT_STREQ(hnode.ccode, unpacked.ccode);
+   EXPECT_STREQ(hnode.city.c_str(), unpacked.city.c_str());
+   EXPECT_EQ(hnode.latitude, unpacked.latitude);
+   EXPECT_EQ(hnode.longitude, unpacked.longitude);
+   EXPECT_EQ(hnode.geoname_id, unpacked.geoname_id);
+   EXPECT_EQ(hnode.as_num, unpacked.as_num);
+   EXPECT_STREQ(hnode.as_org.c_str(), unpacked.as_org.c_str());
+
+   const u_char ipv4[] = {192, 168, 1, 1};
+
+   ASSERT_EQ(ipaddr_t::IPV4, unpacked.ipaddr.family);
+   EXPECT_EQ(0, memcmp(ipv4, unpacked.ipaddr.addr, sizeof(ipv4)));
+
+   serializer_t sr(buffer, datasize);
+   uint64_t value;
+   size_t fsize;
+
+   sr.deserialize(hnode_t::s_field_hits(buffer, datasize, fsize), value);
+   EXPECT_EQ(hnode.count, value);
+
+   sr.deserialize(hnode_t::s_field_xfer(buffer, datasize, fsize), value);
+   EXPECT_EQ(hnode.xfer, value);
+
+   sr.deserialize(hnode_t::s_field_value_hash(buffer, datasize, fsize), value);
+   EXPECT_EQ(hnode.s_hash_value(), value);
+
+   // report filters read these fields without unpacking the node
+   string_t name;
+
+   sr.deserialize(hnode_t::s_field_name(buffer, datasize, fsize), name);
+   EXPECT_STREQ(hnode.name.c_str(), name.c_str());
+   EXPECT_EQ(serializer_t::s_size_of(hnode.name), fsize);
+
+   EXPECT_TRUE(hnode_t::s_is_robot(buffer, datasize));
+   EXPECT_FALSE(hnode_t::s_is_group(buffer, datasize));
+}
+
+///
+/// @brief  Tests that a URL node packed in the current data version is restored
+///         intact and that secondary database field extractors find indexed fields.
+///
+TEST(DataNode, UrlNodePackUnpack)
+{
+   string_t::char_buffer_t buffer(1024);
+
+   unode_t unode(string_t::hold("/index.html"), OBJ_REG, string_t::hold("a=1"));
+
+   unode.count = 1000;
+   unode.files = 900;
+   unode.entry = 100;
+   unode.exit = 90;
+   unode.xfer = 123456789;
+   unode.avgtime = .25;
+   unode.maxtime = 1.5;
+   unode.target = true;
+   unode.update_url_type(URL_TYPE_HTTPS);
+
+   size_t datasize = unode.s_pack_data(buffer, buffer.capacity());
+
+   ASSERT_EQ(unode.s_data_size(), datasize);
+
+   unode_t unpacked;
+
+   ASSERT_EQ(datasize, unpacked.s_unpack_data(buffer, datasize, (unode_t::s_unpack_cb_t<>) nullptr));
+
+   EXPECT_STREQ(unode.string.c_str(), unpacked.string.c_str());
+   EXPECT_EQ(unode.pathlen, unpacked.pathlen);
+   EXPECT_EQ(unode.urltype, unpacked.urltype);
+   EXPECT_EQ(unode.count, unpacked.count);
+   EXPECT_EQ(unode.files, unpacked.files);
+   EXPECT_EQ(unode.entry, unpacked.entry);
+   EXPECT_EQ(unode.exit, unpacked.exit);
+   EXPECT_EQ(unode.xfer, unpacked.xfer);
+   EXPECT_EQ(unode.avgtime, unpacked.avgtime);
+   EXPECT_EQ(unode.maxtime, unpacked.maxtime);
+   EXPECT_EQ(unode.target, unpacked.target);
+
+   serializer_t sr(buffer, datasize);
+   uint64_t value;
+   size_t fsize;
+
+   sr.deserialize(unode_t::s_field_hits(buffer, datasize, fsize), value);
+   EXPECT_EQ(unode.count, value);
+
+   sr.deserialize(unode_t::s_field_entry(buffer, datasize, fsize), value);
+   EXPECT_EQ(unode.entry, value);
+
+   sr.deserialize(unode_t::s_field_exit(buffer, datasize, fsize), value);
+   EXPECT_EQ(unode.exit, value);
+
+   sr.deserialize(unode_t::s_field_xfer(buffer, datasize, fsize), value);
+   EXPECT_EQ(unode.xfer, value);
+
+   sr.deserialize(unode_t::s_field_value_hash(buffer, datasize, fsize), value);
+   EXPECT_EQ(unode.s_hash_value(), value);
+
+   // report filters match hidden URLs against the path without unpacking the node
+   EXPECT_EQ(unode.pathlen, unode_t::s_path_length(buffer, datasize));
+
+   // a path longer than 127 characters takes more than one byte as a variable-length integer
+   std::string path = "/docs/" + std::string(200, 'x') + ".html";
+
+   unode_t lnode(string_t::hold(path.c_str()), OBJ_REG, string_t::hold("a=1"));
+
+   datasize = lnode.s_pack_data(buffer, buffer.capacity());
+
+   EXPECT_EQ(211, unode_t::s_path_length(buffer, datasize));
+}
+
+///
+/// @brief  Packs a host node in the fixed-width layout used by data versions 1-9.
+///
+static size_t PackHostNodeOld(const hnode_t& hnode, u_short version, void *buffer, size_t bufsize)
+{
+   serializer_t sr(buffer, bufsize);
+   char ccode[2] = {hnode.ccode[0], hnode.ccode[1]};
+
+   void *ptr = sr.serialize(buffer, version);
+   ptr = sr.serialize<u_char, nodetype_t>(ptr, hnode.flag);
+   ptr = sr.serialize(ptr, hnode.string);
+
+   ptr = sr.serialize(ptr, (bool) hnode.spammer);
+   ptr = sr.serialize(ptr, hnode.count);
+   ptr = sr.serialize(ptr, hnode.files);
+   ptr = sr.serialize(ptr, hnode.pages);
+   ptr = sr.serialize(ptr, hnode.xfer);
+   ptr = sr.serialize(ptr, hnode.visits);
+   ptr = sr.serialize(ptr, hnode.visit_avg);
+   ptr = sr.serialize(ptr, hnode.visit_max);
+   ptr = sr.serialize(ptr, hnode.max_v_hits);
+   ptr = sr.serialize(ptr, hnode.max_v_files);
+   ptr = sr.serialize(ptr, hnode.max_v_pages);
+   ptr = sr.serialize(ptr, hnode.max_v_xfer);
+   ptr = sr.serialize(ptr, false);                  // active
+   ptr = sr.serialize(ptr, hnode.s_hash_value());
+
+   ptr = sr.serialize(ptr, hnode.name);
+   ptr = sr.serialize(ptr, ccode);
+
+   if(version >= 2)
+      ptr = sr.serialize(ptr, (bool) hnode.robot);
+
+   if(version >= 3)
+      ptr = sr.serialize(ptr, hnode.visits_conv);
+
+   if(version >= 5)
+      ptr = sr.serialize(ptr, hnode.tstamp);
+
+   if(version >= 6)
+      ptr = sr.serialize(ptr, hnode.city);
+
+   if(version >= 7) {
+      ptr = sr.serialize(ptr, hnode.latitude);
+      ptr = sr.serialize(ptr, hnode.longitude);
+   }
+
+   if(version >= 8)
+      ptr = sr.serialize(ptr, hnode.geoname_id);
+
+   if(version >= 9) {
+      ptr = sr.serialize(ptr, hnode.as_num);
+      ptr = sr.serialize(ptr, hnode.as_org);
+   }
+
+   return sr.data_size(ptr);
+}
+
+///
+/// @brief  Tests that host nodes packed in the fixed-width layout of data versions
+///         prior to 10 are restored intact, that fields missing in older versions
+///         are set to their defaults and that field extractors work for them.
+///
+TEST(DataNode, HostNodeUnpackOldVersion)
+{
+   string_t::char_buffer_t buffer(1024);
+
+   hnode_t hnode(string_t::hold("192.168.1.1"), OBJ_REG);
+
+   hnode.count = 12345678901ull;
+   hnode.files = 10;
+   hnode.pages = 300;
+   hnode.xfer = 9876543210ull;
+   hnode.visits = 2;
+   hnode.visits_conv = 1;
+   hnode.visit_avg = 12.5;
+   hnode.visit_max = 3600;
+   hnode.max_v_hits = 150;
+   hnode.max_v_files = 20;
+   hnode.max_v_pages = 15;
+   hnode.max_v_xfer = 123456;
+   hnode.robot = true;
+   hnode.tstamp.reset(2022, 3, 4, 5, 6, 7, -300);
+   hnode.name = "host.example.com";
+   hnode.set_ccode("ca");
+   hnode.city = "Toronto";
+   hnode.latitude = 43.7;
+   hnode.longitude = -79.4;
+   hnode.geoname_id = 6167865;
+   hnode.as_num = 64512;
+   hnode.as_org = "Example";
+
+   // the last version with the fixed-width layout has all fields
+   size_t datasize = PackHostNodeOld(hnode, 9, buffer, buffer.capacity());
+
+   hnode_t unpacked;
+
+   ASSERT_EQ(datasize, unpacked.s_unpack_data(buffer, datasize, (hnode_t::s_unpack_cb_t<>) nullptr));
+
+   EXPECT_STREQ(hnode.string.c_str(), unpacked.string.c_str());
+   EXPECT_EQ(hnode.count, unpacked.count);
+   EXPECT_EQ(hnode.files, unpacked.files);
+   EXPECT_EQ(hnode.pages, unpacked.pages);
+   EXPECT_EQ(hnode.xfer, unpacked.xfer);
+   EXPECT_EQ(hnode.visits, unpacked.visits);
+   EXPECT_EQ(hnode.visits_conv, unpacked.visits_conv);
+   EXPECT_EQ(hnode.visit_avg, unpacked.visit_avg);
+   EXPECT_EQ(hnode.visit_max, unpacked.visit_max);
+   EXPECT_EQ(hnode.max_v_hits, unpacked.max_v_hits);
+   EXPECT_EQ(hnode.max_v_files, unpacked.max_v_files);
+   EXPECT_EQ(hnode.max_v_pages, unpacked.max_v_pages);
+   EXPECT_EQ(hnode.max_v_xfer, unpacked.max_v_xfer);
+   EXPECT_EQ(hnode.robot, unpacked.robot);
+   EXPECT_EQ(hnode.tstamp, unpacked.tstamp);
+   EXPECT_STREQ(hnode.name.c_str(), unpacked.name.c_str());
+   EXPECT_STREQ(hnode.ccode, unpacked.ccode);
+   EXPECT_STREQ(hnode.city.c_str(), unpacked.city.c_str());
+   EXPECT_EQ(hnode.latitude, unpacked.latitude);
+   EXPECT_EQ(hnode.longitude, unpacked.longitude);
+   EXPECT_EQ(hnode.geoname_id, unpacked.geoname_id);
+   EXPECT_EQ(hnode.as_num, unpacked.as_num);
+   EXPECT_STREQ(hnode.as_org.c_str(), unpacked.as_org.c_str());
+
+   // IP addresses are parsed from the host address in versions prior to 11
+   EXPECT_EQ(ipaddr_t::IPV4, unpacked.ipaddr.family);
+
+   serializer_t sr(buffer, datasize);
+   uint64_t value;
+   size_t fsize;
+
+   sr.deserialize(hnode_t::s_field_hits(buffer, datasize, fsize), value);
+   EXPECT_EQ(hnode.count, value);
+
+   sr.deserialize(hnode_t::s_field_xfer(buffer, datasize, fsize), value);
+   EXPECT_EQ(hnode.xfer, value);
+
+   sr.deserialize(hnode_t::s_field_value_hash(buffer, datasize, fsize), value);
+   EXPECT_EQ(hnode.s_hash_value(), value);
+
+   string_t name;
+
+   sr.deserialize(hnode_t::s_field_name(buffer, datasize, fsize), name);
+   EXPECT_STREQ(hnode.name.c_str(), name.c_str());
+
+   EXPECT_TRUE(hnode_t::s_is_robot(buffer, datasize));
+
+   // the first version has none of the fields added later
+   datasize = PackHostNodeOld(hnode, 1, buffer, buffer.capacity());
+
+   hnode_t unpacked_v1;
+
+   ASSERT_EQ(datasize, unpacked_v1.s_unpack_data(buffer, datasize, (hnode_t::s_unpack_cb_t<>) nullptr));
+
+   EXPECT_EQ(hnode.count, unpacked_v1.count);
+   EXPECT_EQ(hnode.xfer, unpacked_v1.xfer);
+   EXPECT_STREQ(hnode.name.c_str(), unpacked_v1.name.c_str());
+   EXPECT_STREQ(hnode.ccode, unpacked_v1.ccode);
+
+   EXPECT_FALSE(unpacked_v1.robot);
+   EXPECT_EQ(0, unpacked_v1.visits_conv);
+   EXPECT_TRUE(unpacked_v1.tstamp.null);
+   EXPECT_TRUE(unpacked_v1.city.isempty());
+   EXPECT_EQ(0, unpacked_v1.geoname_id);
+   EXPECT_EQ(0, unpacked_v1.as_num);
+   EXPECT_TRUE(unpacked_v1.as_org.isempty());
+
+   EXPECT_FALSE(hnode_t::s_is_robot(buffer, datasize));
+}
+
+///
+/// @brief  Tests that binary IP addresses are stored in host nodes starting with
+///         version 11 and are parsed from the host address in version 10.
+///
+TEST(DataNode, HostNodeIpAddress)
+{
+   string_t::char_buffer_t buffer(1024);
+   serializer_t sr(buffer, buffer.capacity());
+
+   const u_char ipv6[] = {0x20, 0x01, 0x0d, 0xb8, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0x01};
+
+   hnode_t hnode(string_t::hold("2001:db8::1"), OBJ_REG);
+
+   ASSERT_EQ(ipaddr_t::IPV6, hnode.ipaddr.family);
+   EXPECT_EQ(0, memcmp(ipv6, hnode.ipaddr.addr, sizeof(ipv6)));
+
+   size_t datasize = hnode.s_pack_data(buffer, buffer.capacity());
+
+   hnode_t unpacked;
+
+   ASSERT_EQ(datasize, unpacked.s_unpack_data(buffer, datasize, (hnode_t::s_unpack_cb_t<>) nullptr));
+
+   ASSERT_EQ(ipaddr_t::IPV6, unpacked.ipaddr.family);
+   EXPECT_EQ(0, memcmp(ipv6, unpacked.ipaddr.addr, sizeof(ipv6)));
+
+   // make the node look like version 10, which ends with the AS organization
+   sr.serialize(buffer, (u_short) 10);
+
+   datasize -= serializer_t::s_size_of(hnode.ipaddr);
+
+   hnode_t unpacked_v10;
+
+   ASSERT_EQ(datasize, unpacked_v10.s_unpack_data(buffer, datasize, (hnode_t::s_unpack_cb_t<>) nullptr));
+
+   ASSERT_EQ(ipaddr_t::IPV6, unpacked_v10.ipaddr.family);
+   EXPECT_EQ(0, memcmp(ipv6, unpacked_v10.ipaddr.addr, sizeof(ipv6)));
+
+   // host names and groups have no IP address
+   hnode_t group(string_t::hold("192.168.1.0/24"), OBJ_GRP);
+
+   EXPECT_EQ(ipaddr_t::NONE, group.ipaddr.family);
+
+   datasize = group.s_pack_data(buffer, buffer.capacity());
+
+   EXPECT_EQ(group.s_data_size(), datasize);
+
+   sr.serialize(buffer, (u_short) 10);
+
+   datasize -= serializer_t::s_size_of(group.ipaddr);
+
+   ASSERT_EQ(datasize, unpacked_v10.s_unpack_data(buffer, datasize, (hnode_t::s_unpack_cb_t<>) nullptr));
+
+   EXPECT_EQ(ipaddr_t::NONE, unpacked_v10.ipaddr.family);
+
+   hnode_t named(string_t::hold("host.example.com"), OBJ_REG);
+
+   EXPECT_EQ(ipaddr_t::NONE, named.ipaddr.family);
+}
+
+///
+/// @brief  Packs a URL node in the fixed-width layout used by data versions 1-3.
+///
+static size_t PackUrlNodeOld(const unode_t& unode, u_short version, void *buffer, size_t bufsize)
+{
+   serializer_t sr(buffer, bufsize);
+
+   void *ptr = sr.serialize(buffer, version);
+   ptr = sr.serialize<u_char, nodetype_t>(ptr, unode.flag);
+   ptr = sr.serialize(ptr, unode.string);
+
+   ptr = sr.serialize(ptr, false);                  // hexenc
+   ptr = sr.serialize(ptr, unode.urltype);
+   ptr = sr.serialize(ptr, unode.pathlen);
+   ptr = sr.serialize(ptr, unode.count);
+   ptr = sr.serialize(ptr, unode.files);
+   ptr = sr.serialize(ptr, unode.entry);
+   ptr = sr.serialize(ptr, unode.exit);
+   ptr = sr.serialize(ptr, unode.xfer);
+   ptr = sr.serialize(ptr, unode.avgtime);
+   ptr = sr.serialize(ptr, unode.s_hash_value());
+
+   if(version >= 2)
+      ptr = sr.serialize(ptr, unode.maxtime);
+
+   if(version >= 3)
+      ptr = sr.serialize(ptr, (bool) unode.target);
+
+   return sr.data_size(ptr);
+}
+
+///
+/// @brief  Tests that URL nodes packed in the fixed-width layout of data versions
+///         prior to 4 are restored intact, that fields missing in older versions
+///         are set to their defaults and that field extractors work for them.
+///
+TEST(DataNode, UrlNodeUnpackOldVersion)
+{
+   string_t::char_buffer_t buffer(1024);
+
+   unode_t unode(string_t::hold("/index.html"), OBJ_REG, string_t::hold("a=1"));
+
+   unode.count = 1000;
+   unode.files = 900;
+   unode.entry = 100;
+   unode.exit = 90;
+   unode.xfer = 123456789;
+   unode.avgtime = .25;
+   unode.maxtime = 1.5;
+   unode.target = true;
+   unode.update_url_type(URL_TYPE_HTTPS);
+
+   // the last version with the fixed-width layout has all fields
+   size_t datasize = PackUrlNodeOld(unode, 3, buffer, buffer.capacity());
+
+   unode_t unpacked;
+
+   ASSERT_EQ(datasize, unpacked.s_unpack_data(buffer, datasize, (unode_t::s_unpack_cb_t<>) nullptr));
+
+   EXPECT_STREQ(unode.string.c_str(), unpacked.string.c_str());
+   EXPECT_EQ(unode.pathlen, unpacked.pathlen);
+   EXPECT_EQ(unode.urltype, unpacked.urltype);
+   EXPECT_EQ(unode.count, unpacked.count);
+   EXPECT_EQ(unode.files, unpacked.files);
+   EXPECT_EQ(unode.entry, unpacked.entry);
+   EXPECT_EQ(unode.exit, unpacked.exit);
+   EXPECT_EQ(unode.xfer, unpacked.xfer);
+   EXPECT_EQ(unode.avgtime, unpacked.avgtime);
+   EXPECT_EQ(unode.maxtime, unpacked.maxtime);
+   EXPECT_EQ(unode.target, unpacked.target);
+
+   serializer_t sr(buffer, datasize);
+   uint64_t value;
+   size_t fsize;
+
+   sr.deserialize(unode_t::s_field_hits(buffer, datasize, fsize), value);
+   EXPECT_EQ(unode.count, value);
+
+   sr.deserialize(unode_t::s_field_entry(buffer, datasize, fsize), value);
+   EXPECT_EQ(unode.entry, value);
+
+   sr.deserialize(unode_t::s_field_exit(buffer, datasize, fsize), value);
+   EXPECT_EQ(unode.exit, value);
+
+   sr.deserialize(unode_t::s_field_xfer(buffer, datasize, fsize), value);
+   EXPECT_EQ(unode.xfer, value);
+
+   sr.deserialize(unode_t::s_field_value_hash(buffer, datasize, fsize), value);
+   EXPECT_EQ(unode.s_hash_value(), value);
+
+   // the first version has neither the maximum processing time nor the target flag
+   datasize = PackUrlNodeOld(unode, 1, buffer, buffer.capacity());
+
+   unode_t unpacked_v1;
+
+   ASSERT_EQ(datasize, unpacked_v1.s_unpack_data(buffer, datasize, (unode_t::s_unpack_cb_t<>) nullptr));
+
+   EXPECT_EQ(unode.count, unpacked_v1.count);
+   EXPECT_EQ(unode.xfer, unpacked_v1.xfer);
+   EXPECT_EQ(unode.avgtime, unpacked_v1.avgtime);
+
+   EXPECT_EQ(0, unpacked_v1.maxtime);
+   EXPECT_FALSE(unpacked_v1.target);
+}
+
+///
+/// @brief  Tests that the robot flag can be read from a serialized user agent node.
+///
+TEST(DataNode, AgentNodeRobotField)
+{
+   string_t::char_buffer_t buffer(1024);
+
+   anode_t anode(string_t::hold("Mozilla/5.0 (compatible; Googlebot/2.1)"), OBJ_REG, true);
+
+   size_t datasize = anode.s_pack_data(buffer, buffer.capacity());
+
+   EXPECT_TRUE(anode_t::s_is_robot(buffer, datasize));
+
+   anode.robot = false;
+
+   datasize = anode.s_pack_data(buffer, buffer.capacity());
+
+   EXPECT_FALSE(anode_t::s_is_robot(buffer, datasize));
+}
+
+///
+/// @brief  Tests that the incremental compaction position is restored from a system
+///         node and is reset when unpacking a system node older than version 8.
+///
+TEST(DataNode, SysNodeCompactPosition)
+{
+   string_t::char_buffer_t buffer(1024);
+   serializer_t sr(buffer, buffer.capacity());
+
+   // serialized primary keys are binary and may contain zero bytes
+   const char compact_key[] = {0, 0, 0, 0, 0, 0, 0x12, 0x34};
+
+   string_t::char_buffer_t key_buffer(sizeof(compact_key) + 1);
+
+   memcpy(key_buffer.get_buffer(), compact_key, sizeof(compact_key));
+   key_buffer[sizeof(compact_key)] = 0;
+
+   sysnode_t sysnode;
+
+   sysnode.checkpoint = 12345;
+   sysnode.compact_table = 3;
+   sysnode.compact_key.attach(std::move(key_buffer), sizeof(compact_key));
+
+   size_t datasize = sysnode.s_pack_data(buffer, buffer.capacity());
+
+   sysnode_t unpacked;
+
+   ASSERT_EQ(datasize, unpacked.s_unpack_data(buffer, datasize, (sysnode_t::s_unpack_cb_t<>) nullptr));
+
+   EXPECT_EQ(12345, unpacked.checkpoint);
+   EXPECT_EQ(3, unpacked.compact_table);
+   ASSERT_EQ(sizeof(compact_key), unpacked.compact_key.length());
+   EXPECT_EQ(0, memcmp(compact_key, unpacked.compact_key.c_str(), sizeof(compact_key)));
+
+   // make the node look like version 7, which ends with the checkpoint
+   sr.serialize(buffer, (u_short) 7);
+
+   sysnode_t unpacked_v7;
+
+   unpacked_v7.compact_table = 1;
+   unpacked_v7.compact_key = "key";
+
+   unpacked_v7.s_unpack_data(buffer, datasize, (sysnode_t::s_unpack_cb_t<>) nullptr);
+
+   EXPECT_EQ(12345, unpacked_v7.checkpoint);
+   EXPECT_EQ(0, unpacked_v7.compact_table);
+   EXPECT_TRUE(unpacked_v7.compact_key.isempty());
+}
+
+}
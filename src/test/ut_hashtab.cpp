@@ -17,6 +17,9 @@
 
 #include <string>
 #include <list>
+#include <unordered_set>
+#include <vector>
+#include <cstring>
 #include <stdexcept>
 
 namespace sswtest {
@@ -247,6 +250,7 @@ TEST(HashTableTest, SwapOut)
 
    // nodes with time stamps from 0 to 38, even values, no groups
    EXPECT_EQ(40, swapcnt) << "40 regular objects should be swapped out";
+   EXPECT_EQ(40, htab.get_swapped()) << "Swapped out nodes should be counted";
 
    // 60 regular objects and 10 groups
    EXPECT_EQ(60 + 10, htab.size()) << "60 regular nodes and 10 group nodes should remain in the hash table";
@@ -278,6 +282,109 @@ TEST(HashTableTest, SwapOut)
    ASSERT_NO_THROW(htab.clear());
 }
 
+///
+/// @brief  Tests that swapped out nodes are passed to the swap-out callback in
+///         the order established by the order callback.
+///
+TEST(HashTableTest, SwapOutOrder)
+{
+   std::vector<uint64_t> nodeids;    // node IDs in the swap-out order
+
+   auto swap_cb = [] (storable_t<anode_t> *node, void *arg)
+   {
+      ((std::vector<uint64_t>*) arg)->push_back(node->nodeid);
+   };
+
+   auto order_cb = [] (const anode_t *node1, const anode_t *node2)
+   {
+      return node1->nodeid < node2->nodeid;
+   };
+
+   hash_table<storable_t<anode_t>> htab(10);
+
+   htab.set_swap_out_cb(swap_cb, &nodeids, nullptr, order_cb);
+
+   // insert nodes with node IDs in the reverse time stamp order
+   for(int i = 100; i < 200; i++) {
+      std::string agent = "Agent " + std::to_string(i);
+      string_t agent_key(string_t::hold(agent.c_str(), agent.length()));
+
+      storable_t<anode_t> *anode = new storable_t<anode_t>(agent_key, OBJ_REG, false);
+      anode->nodeid = 1000 - i;
+
+      ASSERT_NO_THROW(htab.put_node(anode, i));
+   }
+
+   // swap out nodes with time stamps 100-149
+   ASSERT_NO_THROW(htab.swap_out(149));
+
+   ASSERT_EQ(50, nodeids.size()) << "50 nodes should be swapped out";
+
+   // node IDs 851-900 should be swapped out in ascending order
+   for(size_t i = 0; i < nodeids.size(); i++)
+      EXPECT_EQ(851 + i, nodeids[i]) << "Nodes should be swapped out in the ascending node ID order";
+
+   EXPECT_EQ(50, htab.size()) << "50 nodes should remain in the hash table";
+}
+
+///
+/// @brief  Tests that nodes are left in the hash table if the swap-out callback
+///         throws an exception before they are saved.
+///
+TEST(HashTableTest, SwapOutOrderException)
+{
+   std::vector<uint64_t> nodeids;    // node IDs in the swap-out order
+   hash_table_base::memwatch_t memwatch;
+
+   auto swap_cb = [] (storable_t<anode_t> *node, void *arg)
+   {
+      // simulate a database error
+      if(node->nodeid == 875)
+         throw std::runtime_error("Cannot save a node");
+
+      ((std::vector<uint64_t>*) arg)->push_back(node->nodeid);
+   };
+
+   auto order_cb = [] (const anode_t *node1, const anode_t *node2)
+   {
+      return node1->nodeid < node2->nodeid;
+   };
+
+   hash_table<storable_t<anode_t>> htab(10);
+
+   htab.set_swap_out_cb(swap_cb, &nodeids, nullptr, order_cb);
+   htab.set_memwatch(&memwatch);
+
+   // insert nodes with node IDs in the reverse time stamp order
+   for(int i = 100; i < 200; i++) {
+      std::string agent = "Agent " + std::to_string(i);
+      string_t agent_key(string_t::hold(agent.c_str(), agent.length()));
+
+      storable_t<anode_t> *anode = new storable_t<anode_t>(agent_key, OBJ_REG, false);
+      anode->nodeid = 1000 - i;
+
+      ASSERT_NO_THROW(htab.put_node(anode, i));
+   }
+
+   // swap out nodes with time stamps 100-149, which fails at node ID 875
+   ASSERT_THROW(htab.swap_out(149), std::runtime_error);
+
+   ASSERT_EQ(24, nodeids.size()) << "Nodes with node IDs 851-874 should be swapped out";
+
+   EXPECT_EQ(76, htab.size()) << "Nodes that were not saved should remain in the hash table";
+   EXPECT_EQ(htab.get_memsize(), memwatch.get_memsize());
+
+   // node ID 875 has a time stamp 125 and node ID 874 has a time stamp 126
+   const anode_t *anode = htab.find_node(OBJ_REG, string_t::hold("Agent 125"));
+   ASSERT_TRUE(anode != nullptr) << "A node that failed to save should remain in the hash table";
+   EXPECT_EQ(875, anode->nodeid);
+
+   EXPECT_TRUE(htab.find_node(OBJ_REG, string_t::hold("Agent 126")) == nullptr) << "A saved node should be removed from the hash table";
+
+   // make sure removed nodes didn't leave any dangling pointers
+   ASSERT_NO_THROW(htab.clear());
+}
+
 ///
 /// @brief  Tests swapping out oldest nodes from the hash table by memory size.
 ///
@@ -357,6 +464,136 @@ TEST(HashTableTest, SwapOutByMemSizeLessThan)
    EXPECT_EQ(0, htab.size()) << "Zero nodes should remain in the hash table";
 }
 
+///
+/// @brief  Tests that hash tables maintain their combined memory size as nodes
+///         are inserted, swapped out and cleared.
+///
+TEST(HashTableTest, CombinedMemSize)
+{
+   size_t swapcnt = 0;     // number of swapped out nodes
+   hash_table_base::memwatch_t memwatch;
+
+   auto swap_cb = [] (storable_t<anode_t> *node, void *arg)
+   {
+      // increment the swap node count
+      (*(size_t*) arg)++;
+   };
+
+   hash_table<storable_t<anode_t>> htab1(10), htab2(10);
+
+   htab1.set_swap_out_cb(swap_cb, &swapcnt);
+
+   ASSERT_NO_THROW(htab1.put_node(new storable_t<anode_t>(string_t::hold("Agent 1"), OBJ_REG, false), 0));
+
+   // memory size of hash table nodes inserted earlier is moved into the combined size
+   htab1.set_memwatch(&memwatch);
+   htab2.set_memwatch(&memwatch);
+
+   EXPECT_EQ(htab1.get_memsize(), memwatch.get_memsize());
+
+   for(int i = 100; i < 200; i++) {
+      std::string agent = "Agent " + std::to_string(i);
+      string_t agent_key(string_t::hold(agent.c_str(), agent.length()));
+
+      ASSERT_NO_THROW(htab1.put_node(new storable_t<anode_t>(agent_key, OBJ_REG, false), i));
+      ASSERT_NO_THROW(htab2.put_node(new storable_t<anode_t>(agent_key, OBJ_REG, false), i));
+   }
+
+   EXPECT_EQ(htab1.get_memsize() + htab2.get_memsize(), memwatch.get_memsize());
+
+   // swapping out just over a half of the first hash table should be enough
+   memwatch.set_watermark(htab1.get_memsize() / 2 + htab2.get_memsize());
+   EXPECT_TRUE(memwatch.over_watermark());
+
+   ASSERT_NO_THROW(htab1.swap_out(149));
+   EXPECT_EQ(51, swapcnt);
+
+   EXPECT_EQ(htab1.get_memsize() + htab2.get_memsize(), memwatch.get_memsize());
+   EXPECT_FALSE(memwatch.over_watermark());
+
+   htab2.clear();
+   EXPECT_EQ(htab1.get_memsize(), memwatch.get_memsize());
+
+   htab1.set_memwatch(nullptr);
+   EXPECT_EQ(0, memwatch.get_memsize());
+}
+
+///
+/// @brief  Tests that a swap-out that could not free enough memory because nodes
+///         were in use is retried once the time stamp advances, even if the hash
+///         table doesn't grow, and that the watermark is set back to the maximum
+///         memory size after a successful retry.
+///
+TEST(HashTableTest, SwapOutRetry)
+{
+   struct swap_state_t {
+      size_t swapcnt = 0;  // number of swapped out nodes
+      bool inuse = true;   // whether nodes may be swapped out
+   } swap_state;
+
+   hash_table_base::memwatch_t memwatch;
+
+   auto swap_cb = [] (storable_t<anode_t> *node, void *arg)
+   {
+      ((swap_state_t*) arg)->swapcnt++;
+   };
+
+   auto eval_cb = [] (const anode_t *node, void *arg) -> bool
+   {
+      return !((swap_state_t*) arg)->inuse;
+   };
+
+   hash_table<storable_t<anode_t>> htab(10);
+
+   htab.set_swap_out_cb(swap_cb, &swap_state, eval_cb);
+   htab.set_memwatch(&memwatch);
+
+   for(int i = 100; i < 200; i++) {
+      std::string agent = "Agent " + std::to_string(i);
+      string_t agent_key(string_t::hold(agent.c_str(), agent.length()));
+
+      ASSERT_NO_THROW(htab.put_node(new storable_t<anode_t>(agent_key, OBJ_REG, false), i));
+   }
+
+   size_t maxmem = memwatch.get_memsize() / 2;
+   size_t stepmem = maxmem / 20;
+
+   memwatch.set_watermark(maxmem);
+   EXPECT_TRUE(memwatch.is_swap_out_due(0));
+
+   // all nodes are in use and none can be swapped out
+   ASSERT_NO_THROW(htab.swap_out(149, maxmem));
+   EXPECT_EQ(0, swap_state.swapcnt);
+
+   memwatch.update_watermark(maxmem, stepmem, 149 + 60);
+
+   EXPECT_FALSE(memwatch.is_swap_out_due(149)) << "A failed swap-out should not be retried right away";
+   EXPECT_FALSE(memwatch.is_swap_out_due(208)) << "A failed swap-out should not be retried before the retry time stamp";
+   EXPECT_TRUE(memwatch.is_swap_out_due(209)) << "A failed swap-out should be retried at the retry time stamp without memory growth";
+
+   // nodes are no longer in use and a half of them can be swapped out
+   swap_state.inuse = false;
+
+   ASSERT_NO_THROW(htab.swap_out(209, maxmem));
+   EXPECT_LT(0, swap_state.swapcnt);
+   EXPECT_GE(maxmem, memwatch.get_memsize());
+
+   memwatch.update_watermark(maxmem, stepmem, 209 + 60);
+
+   EXPECT_FALSE(memwatch.is_swap_out_due(1000)) << "A successful swap-out should cancel the retry";
+   EXPECT_FALSE(memwatch.over_watermark());
+
+   // the watermark raised by the failed swap-out was twice as high, so growing just over the maximum size should be enough
+   for(int i = 200; memwatch.get_memsize() <= maxmem; i++) {
+      std::string agent = "Agent " + std::to_string(i);
+      string_t agent_key(string_t::hold(agent.c_str(), agent.length()));
+
+      ASSERT_NO_THROW(htab.put_node(new storable_t<anode_t>(agent_key, OBJ_REG, false), i));
+   }
+
+   EXPECT_TRUE(memwatch.over_watermark()) << "The watermark should be set back to the maximum memory size";
+}
+
 ///
 /// @brief  Tests multiple hash table look-ups.
 ///
@@ -399,6 +636,11 @@ TEST(HashTableTest, MultipleLookUps)
 
       ASSERT_STREQ(agent_key.c_str(), anode->string.c_str()) << "Every node must be found in the hash table";
    }
+
+   EXPECT_EQ(nullptr, htab.find_node(OBJ_REG, (int64_t) 0, string_t::hold("Agent 100"))) << "A missing key should not be found";
+
+   EXPECT_EQ(200, htab.get_hits()) << "Every successful look-up should be counted as a hit";
+   EXPECT_EQ(1, htab.get_misses()) << "Every failed look-up should be counted as a miss";
 }
 
 ///
@@ -578,6 +820,40 @@ TEST(HashTableTest, URLMultiKey)
    ASSERT_EQ(unode_t::hash_key(url_p), unode_t::hash_key(urlpath, string_t()));
 }
 
+///
+/// @brief  Tests that download keys hashed with a precomputed IP address hash
+///         yield the same hash as those hashed from strings.
+///
+TEST(HashTableTest, DownloadHostHashKey)
+{
+   string_t ipaddr("192.168.1.1");
+   string_t dlname("Download");
+
+   ASSERT_EQ(dlnode_t::hash_key(ipaddr, dlname), dlnode_t::hash_key(hnode_t::hash_key(ipaddr), dlname));
+}
+
+///
+/// @brief  Tests that strings with precomputed hash values can be found in a set
+///         via lookup keys holding strings they do not own.
+///
+TEST(HashTableTest, HashedStringLookup)
+{
+   std::unordered_set<hashed_string_t, hash_hashed_string> hset;
+
+   string_t host1("192.168.1.1");
+   string_t host2("192.168.1.2");
+
+   hset.emplace(hash_ex(0, host1), host1);
+
+   const char *host = "192.168.1.1";
+
+   EXPECT_TRUE(hset.find(hashed_string_t(hash_ex(0, host1), string_t::hold(host, strlen(host)))) != hset.end());
+   EXPECT_TRUE(hset.find(hashed_string_t(hash_ex(0, host2), string_t::hold(host2.c_str(), host2.length()))) == hset.end());
+
+   // same hash value, but a different string must not match
+   EXPECT_TRUE(hset.find(hashed_string_t(hash_ex(0, host1), string_t::hold(host2.c_str(), host2.length()))) == hset.end());
+}
+
 }
 
 #include "../hashtab_tmpl.cpp"
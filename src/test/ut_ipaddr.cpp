@@ -77,4 +77,65 @@ TEST(IPAddressTest, BadIPv6Addresses)
    EXPECT_FALSE(is_ipv6_address("::ffff:1234.0.2.128")) << "Four digits in a group in the IPv4 part of the address (1st group)";
    EXPECT_FALSE(is_ipv6_address("::ffff:192.0.1234.128")) << "Four digits in a group in the IPv4 part of the address (3rd group)";
 }
+
+///
+/// @brief  Parse IPv4 addresses into their binary form
+///
+TEST(IPAddressTest, ParseIPv4Addresses)
+{
+   ipaddr_t ipaddr;
+
+   ASSERT_TRUE(parse_ip_address("192.168.0.255", ipaddr)) << "192.168.0.255";
+   EXPECT_EQ(ipaddr_t::IPV4, ipaddr.family);
+   EXPECT_EQ(4, ipaddr.size());
+   EXPECT_EQ(0, memcmp("\xC0\xA8\x00\xFF", ipaddr.addr, 4));
+
+   EXPECT_TRUE(parse_ip_address("0.0.0.0", ipaddr)) << "0.0.0.0";
+
+   EXPECT_FALSE(parse_ip_address("192.168.0.256", ipaddr)) << "A group value over 255";
+   EXPECT_EQ(ipaddr_t::NONE, ipaddr.family);
+   EXPECT_EQ(0, ipaddr.size());
+
+   EXPECT_FALSE(parse_ip_address("192.168.00.1", ipaddr)) << "A group with a leading zero";
+   EXPECT_FALSE(parse_ip_address("192.168.0", ipaddr)) << "Three groups of digits";
+   EXPECT_FALSE(parse_ip_address("192.168.0.1.", ipaddr)) << "A trailing dot";
+   EXPECT_FALSE(parse_ip_address("192..0.1", ipaddr)) << "An empty group";
+   EXPECT_FALSE(parse_ip_address("", ipaddr)) << "An empty string";
+}
+
+///
+/// @brief  Parse IPv6 addresses into their binary form
+///
+TEST(IPAddressTest, ParseIPv6Addresses)
+{
+   ipaddr_t ipaddr;
+
+   ASSERT_TRUE(parse_ip_address("2017:0db8:85a3:0000:0000:8a2e:0370:7334", ipaddr)) << "2017:0db8:85a3:0000:0000:8a2e:0370:7334";
+   EXPECT_EQ(ipaddr_t::IPV6, ipaddr.family);
+   EXPECT_EQ(16, ipaddr.size());
+   EXPECT_EQ(0, memcmp("\x20\x17\x0D\xB8\x85\xA3\x00\x00\x00\x00\x8A\x2E\x03\x70\x73\x34", ipaddr.addr, 16));
+
+   ASSERT_TRUE(parse_ip_address("2017:DB8::8A2E:370:7334", ipaddr)) << "2017:DB8::8A2E:370:7334";
+   EXPECT_EQ(0, memcmp("\x20\x17\x0D\xB8\x00\x00\x00\x00\x00\x00\x8A\x2E\x03\x70\x73\x34", ipaddr.addr, 16));
+
+   ASSERT_TRUE(parse_ip_address("::ffff:192.0.2.128", ipaddr)) << "::ffff:192.0.2.128";
+   EXPECT_EQ(0, memcmp("\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\xFF\xFF\xC0\x00\x02\x80", ipaddr.addr, 16));
+
+   ASSERT_TRUE(parse_ip_address("::", ipaddr)) << "::";
+   EXPECT_EQ(0, memcmp("\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00", ipaddr.addr, 16));
+
+   ASSERT_TRUE(parse_ip_address("1::", ipaddr)) << "1::";
+   EXPECT_EQ(0, memcmp("\x00\x01\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00\x00", ipaddr.addr, 16));
+
+   EXPECT_TRUE(parse_ip_address("1:2:3:4:5:6:7::", ipaddr)) << "Compressed zeros in place of one group";
+
+   EXPECT_FALSE(parse_ip_address("1:2:3:4:5:6:7::8", ipaddr)) << "Compressed zeros in an address with eight groups";
+   EXPECT_FALSE(parse_ip_address("2017:0db8::0000:8a2e::7334", ipaddr)) << "Two double-colon sequences";
+   EXPECT_FALSE(parse_ip_address(":1::", ipaddr)) << "A single leading colon";
+   EXPECT_FALSE(parse_ip_address("1::2:", ipaddr)) << "A single trailing colon";
+   EXPECT_FALSE(parse_ip_address("2017:00db8::", ipaddr)) << "More than four characters in a hex group";
+   EXPECT_FALSE(parse_ip_address("1:2:3:4:5:6:7:192.0.2.128", ipaddr)) << "An IPv4 part in place of one group";
+   EXPECT_FALSE(parse_ip_address("::ffff:192.0.2", ipaddr)) << "Three groups of the IPv4 part of the address";
+   EXPECT_FALSE(parse_ip_address("example.com", ipaddr)) << "A host name";
+}
 }
\ No newline at end of file
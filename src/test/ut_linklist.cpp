@@ -258,6 +258,134 @@ TEST(GListTest, GListDuplicateSearchValues)
    EXPECT_EQ(3, nameidx) << "The number of iterations should match the number of entries in the names array";
 }
 
+///
+/// @brief  glist Search Engine Runs
+///
+TEST(GListTest, GListSearchNodeRun)
+{
+   glist list;
+   glist::const_iterator first, last;
+
+   list.add_glist("www.google.\tq=", true);
+   list.add_glist("www.google.\tas_q=All Words", true);
+   list.add_glist("bing.com\tq=", true);
+   list.add_glist("google.com\tquery=", true);
+
+   // only consecutive matching entries after the first match should be in the run
+   ASSERT_TRUE(list.find_node_run(string_t("www.google.ca"), first, last));
+   EXPECT_STREQ("q=", first->name.c_str());
+   EXPECT_STREQ("as_q=", std::next(first)->name.c_str());
+   EXPECT_TRUE(std::next(first, 2) == last);
+
+   // the last entry matches, but it is separated from the first run by bing.com
+   ASSERT_TRUE(list.find_node_run(string_t("www.google.com"), first, last));
+   EXPECT_EQ(2, std::distance(first, last));
+
+   ASSERT_TRUE(list.find_node_run(string_t("www.bing.com"), first, last));
+   EXPECT_STREQ("q=", first->name.c_str());
+   EXPECT_EQ(1, std::distance(first, last));
+
+   EXPECT_FALSE(list.find_node_run(string_t("duckduckgo.com"), first, last));
+   EXPECT_TRUE(first == last);
+}
+
+///
+/// @brief  glist Host Name Patterns
+///
+TEST(GListTest, GListHostPatterns)
+{
+   glist list;
+
+   list.add_glist("www.google.\tq=", true);
+   list.add_glist("search-engine_1.com\tq=", true);
+
+   EXPECT_TRUE(list.is_host_list()) << "Host name characters should not require full URL matching";
+
+   list.add_glist("example.com/search\tq=", true);
+
+   EXPECT_FALSE(list.is_host_list()) << "A path in a pattern should require full URL matching";
+
+   glist wclist;
+
+   wclist.add_glist("*.google.com\tq=", true);
+
+   EXPECT_FALSE(wclist.is_host_list()) << "A wildcard in a pattern should require full URL matching";
+}
+
+///
+/// @brief  glist Path-Only Search Engine Patterns
+///
+TEST(GListTest, GListSearchPathPattern)
+{
+   glist list;
+   glist::const_iterator first, last;
+
+   // a pattern of host name characters may be intended to match a URL path
+   list.add_glist("excite\tsearch=", true);
+
+   EXPECT_TRUE(list.is_host_list()) << "A pattern without path characters cannot be told apart from a host name";
+
+   ASSERT_TRUE(list.find_node_run(string_t("http://search.example.com/excite/results?search=webalizer"), first, last)) << "A path-only pattern should match the entire referrer URL";
+   EXPECT_STREQ("search=", first->name.c_str());
+
+   EXPECT_FALSE(list.find_node_run(string_t("search.example.com"), first, last)) << "A path-only pattern should not match the referrer host name";
+}
+
+///
+/// @brief  Tests that an indexed list returns the name of the first pattern in
+///         the list order that matches the entire string.
+///
+TEST(GListTest, GListIndexWholeStrings)
+{
+   glist list;
+   glist_index_t index;
+
+   list.set_enable_phrase_values(true);
+
+   list.add_glist("/post/18*\tAction Photography");
+   list.add_glist("/post/1*\tWild Life Photography");
+   list.add_glist("/post/12\tCats");
+   list.add_glist("*/about\tAbout");
+   list.add_glist("/post/12\tDogs");
+   list.add_glist("/p*t/3\tMiddle Wildcard");
+   list.add_glist("/about\tAbout Us");
+   list.add_glist("*\tAnything");
+
+   index.build(list);
+
+   EXPECT_STREQ("Action Photography", index.find_name("/post/18", 8)->c_str()) << "A prefix pattern should match the prefix itself";
+   EXPECT_STREQ("Action Photography", index.find_name("/post/189", 9)->c_str()) << "A longer prefix listed first should match";
+   EXPECT_STREQ("Wild Life Photography", index.find_name("/post/12", 8)->c_str()) << "A prefix pattern listed first should mask an exact pattern";
+   EXPECT_STREQ("About", index.find_name("/about", 6)->c_str()) << "A suffix pattern listed first should mask an exact pattern";
+   EXPECT_STREQ("Middle Wildcard", index.find_name("/past/3", 7)->c_str()) << "Patterns with other wildcards should be evaluated in the list order";
+   EXPECT_STREQ("Anything", index.find_name("/post", 5)->c_str()) << "A single asterisk should match any string";
+
+   EXPECT_EQ(nullptr, index.find_name("", 0)) << "An empty string should not match any patterns";
+
+   // the index must agree with the list for all inputs
+   const char *urls[] = {"/post/1", "/post/12", "/post/123", "/post/18", "/post/", "/pxt/3", "/x/about", "/about", "/abou", "/"};
+
+   for(const char *url : urls) {
+      const string_t *name = list.isinglist(url, strlen(url), false);
+
+      ASSERT_NE(nullptr, name);
+      EXPECT_EQ(name, index.find_name(url, strlen(url))) << "Indexed list should match " << url << " as " << name->c_str();
+   }
+
+   // rebuild the index for a different list
+   list.clear();
+   list.add_glist("/post/12\tCats");
+   list.add_glist("/post/*\tPosts");
+   list.add_glist("/post/12\tDogs");
+
+   index.build(list);
+
+   EXPECT_STREQ("Cats", index.find_name("/post/12", 8)->c_str()) << "The first of duplicate patterns should match";
+   EXPECT_STREQ("Posts", index.find_name("/post/123", 9)->c_str()) << "A prefix pattern should match a longer string";
+   EXPECT_EQ(nullptr, index.find_name("/post", 5)) << "A prefix pattern should not match a shorter string";
+   EXPECT_EQ(nullptr, index.find_name("/about", 6)) << "Patterns from the previous list should be gone";
+}
+
 ///
 /// @brief  Tests how `gnode_t` is constructed with a name argument.
 ///
@@ -0,0 +1,110 @@
+/*
+   webalizer - a web server log analysis program
+
+   Copyright (c) 2004-2022, Stone Steps Inc. (www.stonesteps.ca)
+
+   See COPYING and Copyright files for additional licensing and copyright information
+
+   ut_logrec_queue.cpp
+*/
+#include "pch.h"
+
+#include "../logrec_queue.h"
+
+#include <stdexcept>
+
+namespace sswtest {
+
+///
+/// @brief  Log records are returned in the order they were pushed, across
+///         multiple full and partial batches.
+///
+TEST(LogRecQueueTest, LogRecordOrder)
+{
+   logrec_queue_t logrec_queue(3, 4);
+   log_struct *logrec;
+   uint64_t count = 0;
+
+   logrec_queue.start([] (logrec_queue_t& queue) {
+      log_struct logrec;
+
+      for(uint64_t i = 0; i < 25; i++) {
+         logrec.reset();
+         logrec.url = string_t::_format("/page-%" PRIu64, i);
+         logrec.xfer_size = i;
+
+         ASSERT_TRUE(queue.push_logrec(logrec));
+      }
+   });
+
+   while((logrec = logrec_queue.next_logrec()) != nullptr) {
+      EXPECT_EQ(count, logrec->xfer_size);
+      EXPECT_STREQ(string_t::_format("/page-%" PRIu64, count).c_str(), logrec->url.c_str());
+      count++;
+   }
+
+   EXPECT_EQ(25, count);
+
+   // the end of data is sticky
+   EXPECT_EQ(nullptr, logrec_queue.next_logrec());
+}
+
+///
+/// @brief  A producer exception is thrown after all queued log records have
+///         been returned.
+///
+TEST(LogRecQueueTest, ProducerError)
+{
+   logrec_queue_t logrec_queue(2, 10);
+   uint64_t count = 0;
+
+   logrec_queue.start([] (logrec_queue_t& queue) {
+      log_struct logrec;
+
+      for(uint64_t i = 0; i < 15; i++) {
+         logrec.xfer_size = i;
+         queue.push_logrec(logrec);
+      }
+
+      throw std::runtime_error("Bad log file");
+   });
+
+   try {
+      while(logrec_queue.next_logrec() != nullptr)
+         count++;
+
+      FAIL() << "Producer exception should be thrown";
+   }
+   catch (const std::runtime_error& err) {
+      EXPECT_STREQ("Bad log file", err.what());
+   }
+
+   EXPECT_EQ(15, count);
+}
+
+///
+/// @brief  A producer waiting for a free batch is released when the consumer
+///         stops or the queue is destroyed.
+///
+TEST(LogRecQueueTest, StopProducer)
+{
+   bool stopped = false;
+
+   {
+      logrec_queue_t logrec_queue(2, 2);
+
+      logrec_queue.start([&stopped] (logrec_queue_t& queue) {
+         log_struct logrec;
+
+         while(queue.push_logrec(logrec));
+
+         stopped = true;
+      });
+
+      ASSERT_NE(nullptr, logrec_queue.next_logrec());
+   }
+
+   EXPECT_TRUE(stopped);
+}
+
+}
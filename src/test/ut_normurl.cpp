@@ -189,6 +189,27 @@ TEST(URLNormalizerTest, NormalizeCharacterOrder)
    EXPECT_STREQ("x\xC2\xA3%25%01y", str) << "Normalize a string with Latin, encoded, control";
 }
 
+///
+/// @brief  Normalize strings longer than the block of characters examined at once
+///
+TEST(URLNormalizerTest, NormalizeLongString)
+{
+   string_t str;
+   string_t::char_buffer_t strbuf;
+
+   str = "/0123456789abcdef/0123456789abcdef/0123456789abcdef/x";
+   norm_url_str(str, strbuf);
+   EXPECT_STREQ("/0123456789abcdef/0123456789abcdef/0123456789abcdef/x", str) << "Normalize a long ASCII string";
+
+   str = "/0123456789abcde%41/0123456789abcdef\xA3/0123456789abcdef%x";
+   norm_url_str(str, strbuf);
+   EXPECT_STREQ("/0123456789abcdeA/0123456789abcdef\xC2\xA3/0123456789abcdef%25x", str) << "Normalize a long string with characters to encode at block boundaries";
+
+   str = "/search?q=%E8%A8%98%E8%A8%98+%E8%A8%98%E8%A8%98&lang=ja&page=1&sort=date";
+   norm_url_str(str, strbuf);
+   EXPECT_STREQ(u8"/search?q=\u8A18\u8A18+\u8A18\u8A18&lang=ja&page=1&sort=date", str) << "Normalize a long string with many URL-encoded characters";
+}
+
 ///
 /// @brief  URL-encode a normalized URL string
 ///
@@ -0,0 +1,95 @@
+/*
+   webalizer - a web server log analysis program
+
+   Copyright (c) 2004-2022, Stone Steps Inc. (www.stonesteps.ca)
+
+   See COPYING and Copyright files for additional licensing and copyright information
+
+   ut_parser.cpp
+*/
+#include "pch.h"
+
+#include "../parser.h"
+#include "../logrec.h"
+
+#include <string>
+
+namespace sswtest {
+
+///
+/// @brief  A test fixture that sets up a parser for Nginx log records with an
+///         ISO-8601 time stamp.
+///
+class ParserNginxTest : public testing::Test {
+   protected:
+      config_t    config;
+      parser_t    parser;
+
+   protected:
+      ParserNginxTest(void) : parser(config)
+      {
+         config.log_type = LOG_NGINX;
+         config.nginx_log_format = "$time_iso8601 $remote_addr \"$request\" $status $bytes_sent \"$http_user_agent\"";
+      }
+
+      void SetUp(void) override
+      {
+         ASSERT_TRUE(parser.init_parser(LOG_NGINX)) << "Nginx log format should be accepted";
+      }
+
+      void TearDown(void) override
+      {
+         parser.cleanup_parser();
+      }
+
+      /// Parses a log record with the specified time stamp, which is terminated with a new line character, as if read from a log file.
+      int ParseRecord(const char *tstamp, log_struct& log_rec)
+      {
+         std::string record = std::string(tstamp) + " 127.0.0.1 \"GET /index.html HTTP/1.1\" 200 1234 \"Mozilla/5.0\"\n";
+
+         log_rec.reset();
+
+         return parser.parse_record(&record[0], record.length(), log_rec);
+      }
+};
+
+///
+/// @brief  Time stamps with the same date and UTC offset as the previous one
+///         are parsed correctly and malformed time parts are rejected, whether
+///         the cached date and UTC offset are reused or not.
+///
+TEST_F(ParserNginxTest, ISOTimeStampCache)
+{
+   log_struct log_rec;
+
+   ASSERT_EQ(PARSE_CODE_OK, ParseRecord("2022-06-25T21:13:03-04:00", log_rec));
+   EXPECT_EQ(21, log_rec.tstamp.hour);
+   EXPECT_EQ(13, log_rec.tstamp.min);
+   EXPECT_EQ(3, log_rec.tstamp.sec);
+
+   // same date and UTC offset
+   ASSERT_EQ(PARSE_CODE_OK, ParseRecord("2022-06-25T12:34:56-04:00", log_rec));
+   EXPECT_EQ(2022, log_rec.tstamp.year);
+   EXPECT_EQ(6, log_rec.tstamp.month);
+   EXPECT_EQ(25, log_rec.tstamp.day);
+   EXPECT_EQ(12, log_rec.tstamp.hour);
+   EXPECT_EQ(34, log_rec.tstamp.min);
+   EXPECT_EQ(56, log_rec.tstamp.sec);
+
+   // same date and UTC offset, with a non-digit in seconds
+   EXPECT_EQ(PARSE_CODE_ERROR, ParseRecord("2022-06-25T12:34:5x-04:00", log_rec));
+
+   // same date and UTC offset, with seconds missing
+   EXPECT_EQ(PARSE_CODE_ERROR, ParseRecord("2022-06-25T12:3456:-04:00", log_rec));
+
+   // seconds missing in a time stamp of a different length
+   EXPECT_EQ(PARSE_CODE_ERROR, ParseRecord("2022-06-25T12:34:-04:00", log_rec));
+
+   // a rejected time stamp should not replace the cached one
+   ASSERT_EQ(PARSE_CODE_OK, ParseRecord("2022-06-25T12:34:56-04:00", log_rec));
+   EXPECT_EQ(12, log_rec.tstamp.hour);
+   EXPECT_EQ(34, log_rec.tstamp.min);
+   EXPECT_EQ(56, log_rec.tstamp.sec);
+}
+
+}
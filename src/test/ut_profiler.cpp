@@ -0,0 +1,111 @@
+/*
+   webalizer - a web server log analysis program
+
+   Copyright (c) 2004-2022, Stone Steps Inc. (www.stonesteps.ca)
+
+   See COPYING and Copyright files for additional licensing and copyright information
+
+   ut_profiler.cpp
+*/
+#include "pch.h"
+
+#include "../profiler.h"
+
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <thread>
+
+namespace sswtest {
+
+///
+/// @brief  A disabled profiler doesn't collect any times or counters.
+///
+TEST(ProfilerTest, Disabled)
+{
+   profiler_t profiler;
+
+   {
+      profiler_t::timer_t timer(profiler, profiler_t::STAGE_PARSE);
+      profiler.add_counts(profiler_t::STAGE_PARSE, 1, 100);
+   }
+
+   EXPECT_EQ(0, profiler.get_stage_stats(profiler_t::STAGE_PARSE).nsecs);
+   EXPECT_EQ(0, profiler.get_stage_stats(profiler_t::STAGE_PARSE).calls);
+   EXPECT_EQ(0, profiler.get_stage_stats(profiler_t::STAGE_PARSE).records);
+   EXPECT_EQ(0, profiler.get_stage_stats(profiler_t::STAGE_PARSE).bytes);
+}
+
+///
+/// @brief  Time spent in a nested timer is excluded from the outer timer and
+///         the outer timer resumes when the nested one goes out of scope.
+///
+TEST(ProfilerTest, NestedTimers)
+{
+   profiler_t profiler;
+
+   profiler.set_enabled(true);
+
+   {
+      profiler_t::timer_t process_timer(profiler, profiler_t::STAGE_PROCESS);
+
+      profiler.add_counts(profiler_t::STAGE_PROCESS, 1, 200);
+
+      {
+         profiler_t::timer_t swap_timer(profiler, profiler_t::STAGE_SWAP_OUT);
+         std::this_thread::sleep_for(std::chrono::milliseconds(50));
+      }
+
+      std::this_thread::sleep_for(std::chrono::milliseconds(5));
+
+      profiler.add_counts(profiler_t::STAGE_PROCESS, 1, 300);
+   }
+
+   const profiler_t::stage_stats_t& process = profiler.get_stage_stats(profiler_t::STAGE_PROCESS);
+   const profiler_t::stage_stats_t& swap_out = profiler.get_stage_stats(profiler_t::STAGE_SWAP_OUT);
+
+   EXPECT_EQ(1, process.calls);
+   EXPECT_EQ(2, process.records);
+   EXPECT_EQ(500, process.bytes);
+   EXPECT_GE(process.nsecs, 5000000);
+
+   EXPECT_EQ(1, swap_out.calls);
+   EXPECT_GE(swap_out.nsecs, 50000000);
+
+   EXPECT_LT(process.nsecs, swap_out.nsecs) << "Swap-out time should not be included in the processing time";
+}
+
+///
+/// @brief  Stage and hash table counters are written as a JSON object.
+///
+TEST(ProfilerTest, WriteJson)
+{
+   profiler_t profiler;
+   string_t path(string_t(testing::TempDir().c_str()) + "ut_profiler.json");
+   std::string json;
+   char buffer[256];
+   size_t count;
+   FILE *file;
+
+   profiler.set_enabled(true);
+
+   profiler.add_counts(profiler_t::STAGE_READ, 3, 1024);
+   profiler.add_htab_stats("hosts", 10, 2, 1);
+
+   ASSERT_TRUE(profiler.write_json(path));
+
+   ASSERT_NE(nullptr, (file = fopen(path, "r")));
+
+   while((count = fread(buffer, 1, sizeof(buffer), file)) != 0)
+      json.append(buffer, count);
+
+   fclose(file);
+   remove(path);
+
+   EXPECT_NE(std::string::npos, json.find("\"read\": {\"nsecs\": 0, \"calls\": 0, \"records\": 3, \"bytes\": 1024}"));
+   EXPECT_NE(std::string::npos, json.find("\"hosts\": {\"hits\": 10, \"misses\": 2, \"swapped\": 1}"));
+   EXPECT_EQ('{', json.front());
+   EXPECT_EQ("}\n", json.substr(json.length() - 2));
+}
+
+}
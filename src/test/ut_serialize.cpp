@@ -15,6 +15,8 @@
 #include "..//types.h"
 
 #include <ctime>
+#include <climits>
+#include <cstdint>
 
 ///
 /// @brief  Tests sizes of fields stored in the buffer.
@@ -349,3 +351,233 @@ TEST(Serialization, BufferBoundstest)
    // a local time stamp is 11 bytes long and will not fit in the 10-byte buffer
    ASSERT_THROW(sr.serialize(buffer.get_buffer() + 10, lcl_ts), std::invalid_argument);
 }
+
+///
+/// @brief  Tests sizes of variable-length integers and time stamps.
+///
+TEST(Serialization, VarIntSizeTest)
+{
+   // 7 bits per byte for unsigned values
+   EXPECT_EQ(1, serializer_t::s_size_of_varint((uint64_t) 0));
+   EXPECT_EQ(1, serializer_t::s_size_of_varint((uint64_t) 127));
+   EXPECT_EQ(2, serializer_t::s_size_of_varint((uint64_t) 128));
+   EXPECT_EQ(2, serializer_t::s_size_of_varint((uint64_t) 16383));
+   EXPECT_EQ(3, serializer_t::s_size_of_varint((uint64_t) 16384));
+   EXPECT_EQ(3, serializer_t::s_size_of_varint((u_short) 65535));
+   EXPECT_EQ(5, serializer_t::s_size_of_varint((u_int) UINT_MAX));
+   EXPECT_EQ(10, serializer_t::s_size_of_varint((uint64_t) UINT64_MAX));
+
+   // zigzag-encoded signed values
+   EXPECT_EQ(1, serializer_t::s_size_of_varint(0));
+   EXPECT_EQ(1, serializer_t::s_size_of_varint(-1));
+   EXPECT_EQ(1, serializer_t::s_size_of_varint(63));
+   EXPECT_EQ(2, serializer_t::s_size_of_varint(64));
+   EXPECT_EQ(1, serializer_t::s_size_of_varint(-64));
+   EXPECT_EQ(2, serializer_t::s_size_of_varint(-65));
+   EXPECT_EQ(10, serializer_t::s_size_of_varint((int64_t) INT64_MIN));
+
+   // null time stamps are stored as a single flag byte
+   tstamp_t null_ts;
+   EXPECT_EQ(sizeof(u_char), serializer_t::s_size_of_varint(null_ts));
+
+   // 2019-10-12 15:29:01 fits into 5 bytes and the offset -300 into 2 more bytes
+   tstamp_t utc_ts(2019, 10, 12, 15, 29, 1);
+   tstamp_t lcl_ts(2019, 10, 12, 15, 29, 1, -300);
+
+   EXPECT_EQ(sizeof(u_char) + 5, serializer_t::s_size_of_varint(utc_ts));
+   EXPECT_EQ(sizeof(u_char) + 5 + 2, serializer_t::s_size_of_varint(lcl_ts));
+
+   // variable-length time stamps should always be shorter than fixed-width ones
+   EXPECT_LT(serializer_t::s_size_of_varint(utc_ts), serializer_t::s_size_of(utc_ts));
+   EXPECT_LT(serializer_t::s_size_of_varint(lcl_ts), serializer_t::s_size_of(lcl_ts));
+}
+
+///
+/// @brief  Tests variable-length fields written to and read from the buffer.
+///
+TEST(Serialization, VarIntWriteReadTest)
+{
+   // large enough to detect overflows for data less than 64 bytes
+   string_t::char_buffer_t buffer(128);
+
+   // set to 0x5A to detect overflows
+   memset(buffer.get_buffer(), 0x5A, buffer.memsize());
+
+   uint64_t ui64v_s = 100, ui64v_l = 1234567890123ull, ui64v_m = UINT64_MAX;
+   u_short ushv = 300;
+   int iv_n = -300;
+   int64_t i64v_n = INT64_MIN;
+
+   tstamp_t utc_ts(time(nullptr));
+   tstamp_t lcl_ts(time(nullptr), -300);
+   tstamp_t null_ts;
+
+   serializer_t sr(buffer, 64);
+   void *wptr = buffer.get_buffer();
+
+   wptr = sr.serialize_varint(wptr, ui64v_s);
+   ASSERT_EQ(1, sr.data_size(wptr));
+
+   wptr = sr.serialize_varint(wptr, ushv);
+   wptr = sr.serialize_varint(wptr, utc_ts);
+   wptr = sr.serialize_varint(wptr, ui64v_l);
+   wptr = sr.serialize_varint(wptr, iv_n);
+   wptr = sr.serialize_varint(wptr, null_ts);
+   wptr = sr.serialize_varint(wptr, ui64v_m);
+   wptr = sr.serialize_varint(wptr, lcl_ts);
+   wptr = sr.serialize_varint(wptr, i64v_n);
+
+   ASSERT_LE(sr.data_size(wptr), buffer.memsize()) << "Write pointer must be within the buffer when we finish serialization";
+   ASSERT_EQ('\x5A', *(char*) wptr);
+
+   const void *rptr = buffer.get_buffer();
+
+   uint64_t v_ui64v_s, v_ui64v_l, v_ui64v_m;
+   u_short v_ushv;
+   int v_iv_n;
+   int64_t v_i64v_n;
+   tstamp_t v_utc_ts, v_lcl_ts, v_null_ts;
+
+   rptr = sr.deserialize_varint(rptr, v_ui64v_s);
+   ASSERT_EQ(ui64v_s, v_ui64v_s);
+
+   rptr = sr.deserialize_varint(rptr, v_ushv);
+   ASSERT_EQ(ushv, v_ushv);
+
+   rptr = sr.deserialize_varint(rptr, v_utc_ts);
+   ASSERT_EQ(utc_ts, v_utc_ts);
+   ASSERT_TRUE(v_utc_ts.utc);
+
+   rptr = sr.deserialize_varint(rptr, v_ui64v_l);
+   ASSERT_EQ(ui64v_l, v_ui64v_l);
+
+   rptr = sr.deserialize_varint(rptr, v_iv_n);
+   ASSERT_EQ(iv_n, v_iv_n);
+
+   rptr = sr.deserialize_varint(rptr, v_null_ts);
+   ASSERT_TRUE(v_null_ts.null);
+
+   rptr = sr.deserialize_varint(rptr, v_ui64v_m);
+   ASSERT_EQ(ui64v_m, v_ui64v_m);
+
+   rptr = sr.deserialize_varint(rptr, v_lcl_ts);
+   ASSERT_EQ(lcl_ts, v_lcl_ts);
+   ASSERT_FALSE(v_lcl_ts.utc);
+   ASSERT_EQ(lcl_ts.offset, v_lcl_ts.offset);
+   ASSERT_EQ(lcl_ts.hour, v_lcl_ts.hour);
+
+   rptr = sr.deserialize_varint(rptr, v_i64v_n);
+   ASSERT_EQ(i64v_n, v_i64v_n);
+
+   ASSERT_EQ(wptr, rptr) << "Serialization write and read pointers should compare equal for same data";
+
+   // skip the same fields without reading them
+   rptr = buffer.get_buffer();
+
+   rptr = sr.s_skip_varint(rptr);
+   rptr = sr.s_skip_varint(rptr);
+   rptr = sr.s_skip_varint_tstamp(rptr);
+   rptr = sr.s_skip_varint(rptr);
+   rptr = sr.s_skip_varint(rptr);
+   rptr = sr.s_skip_varint_tstamp(rptr);
+   rptr = sr.s_skip_varint(rptr);
+   rptr = sr.s_skip_varint_tstamp(rptr);
+   rptr = sr.s_skip_varint(rptr);
+
+   ASSERT_EQ(wptr, rptr) << "Skipping fields should yield the same read pointer";
+}
+
+///
+/// @brief  Tests variable-length fields crossing buffer boundaries.
+///
+TEST(Serialization, VarIntBufferBoundsTest)
+{
+   string_t::char_buffer_t buffer(30);
+
+   // set to 0x5A to detect overflows
+   memset(buffer.get_buffer(), 0x5A, buffer.memsize());
+
+   serializer_t sr(buffer.get_buffer() + 10, 10);
+
+   uint64_t ui64v = 0;
+   u_short ushv = 0;
+
+   // 10 bytes of UINT64_MAX fit exactly into the buffer
+   ASSERT_NO_THROW(sr.serialize_varint(buffer.get_buffer() + 10, (uint64_t) UINT64_MAX));
+   ASSERT_EQ('\x5A', *(buffer.get_buffer() + 20));
+
+   // one byte less of buffer space is not enough
+   ASSERT_THROW(sr.serialize_varint(buffer.get_buffer() + 11, (uint64_t) UINT64_MAX), std::invalid_argument);
+
+   // the entire value can be read back
+   ASSERT_NO_THROW(sr.deserialize_varint(buffer.get_buffer() + 10, ui64v));
+   ASSERT_EQ(UINT64_MAX, ui64v);
+
+   // a 64-bit value cannot be read into a 16-bit variable
+   ASSERT_THROW(sr.deserialize_varint(buffer.get_buffer() + 10, ushv), std::invalid_argument);
+
+   // set the continuation bit in the last byte, so reading runs past the end of the buffer
+   *(buffer.get_buffer() + 19) = '\xFF';
+
+   ASSERT_THROW(sr.deserialize_varint(buffer.get_buffer() + 10, ui64v), std::invalid_argument);
+   ASSERT_THROW(sr.s_skip_varint(buffer.get_buffer() + 10), std::invalid_argument);
+   ASSERT_EQ('\x5A', *(buffer.get_buffer() + 20));
+}
+
+///
+/// @brief  Tests that IP addresses are stored with their address family and only as
+///         many address bytes as the family requires.
+///
+TEST(Serialization, IpAddrWriteReadTest)
+{
+   string_t::char_buffer_t buffer(64);
+
+   // set to 0x5A to detect overflows
+   memset(buffer.get_buffer(), 0x5A, buffer.memsize());
+
+   serializer_t sr(buffer, 32);
+
+   ipaddr_t ipv4, ipv6, none;
+   ipaddr_t v_ipv4, v_ipv6, v_none;
+
+   ASSERT_TRUE(parse_ip_address("10.1.2.3", ipv4));
+   ASSERT_TRUE(parse_ip_address("2001:db8::ff00:42:8329", ipv6));
+
+   EXPECT_EQ(5, serializer_t::s_size_of(ipv4));
+   EXPECT_EQ(17, serializer_t::s_size_of(ipv6));
+   EXPECT_EQ(1, serializer_t::s_size_of(none));
+
+   void *wptr = buffer.get_buffer();
+
+   wptr = sr.serialize(wptr, ipv4);
+   wptr = sr.serialize(wptr, none);
+   wptr = sr.serialize(wptr, ipv6);
+
+   ASSERT_EQ(23, sr.data_size(wptr));
+   ASSERT_EQ('\x5A', *(char*) wptr);
+
+   const void *rptr = buffer.get_buffer();
+
+   // make sure unused address bytes are cleared
+   memset(v_none.addr, 0xFF, sizeof(v_none.addr));
+
+   rptr = sr.deserialize(rptr, v_ipv4);
+   rptr = sr.deserialize(rptr, v_none);
+   rptr = sr.deserialize(rptr, v_ipv6);
+
+   ASSERT_EQ(wptr, rptr);
+
+   EXPECT_EQ(ipaddr_t::IPV4, v_ipv4.family);
+   EXPECT_EQ(0, memcmp(ipv4.addr, v_ipv4.addr, sizeof(ipv4.addr)));
+
+   EXPECT_EQ(ipaddr_t::NONE, v_none.family);
+   EXPECT_EQ(0, memcmp(none.addr, v_none.addr, sizeof(none.addr)));
+
+   EXPECT_EQ(ipaddr_t::IPV6, v_ipv6.family);
+   EXPECT_EQ(0, memcmp(ipv6.addr, v_ipv6.addr, sizeof(ipv6.addr)));
+
+   // an unknown address family indicates a bad read position
+   *buffer.get_buffer() = 3;
+
+   ASSERT_THROW(sr.deserialize(buffer.get_buffer(), v_ipv4), std::invalid_argument);
+}
@@ -0,0 +1,153 @@
+/*
+   webalizer - a web server log analysis program
+
+   Copyright (c) 2004-2022, Stone Steps Inc. (www.stonesteps.ca)
+
+   See COPYING and Copyright files for additional licensing and copyright information
+
+   ut_snapshot.cpp
+*/
+#include "pch.h"
+
+#include "../snapshot.h"
+#include "../asnode.h"
+#include "../tstring.h"
+
+#include <cstdio>
+
+namespace sswtest {
+
+///
+/// @brief  A test fixture that removes the snapshot file after each test.
+///
+class SnapshotTest : public testing::Test {
+   protected:
+      string_t path;
+
+   protected:
+      SnapshotTest(void) : path(string_t(testing::TempDir().c_str()) + "ut_snapshot.snapshot")
+      {
+      }
+
+      ~SnapshotTest(void)
+      {
+         remove(path);
+      }
+
+      /// Writes a snapshot with two sections of ASN nodes for the specified checkpoint.
+      void write_snapshot(uint64_t checkpoint)
+      {
+         snapshot_t snapshot;
+
+         ASSERT_TRUE(snapshot.create(path, 1, checkpoint));
+
+         storable_t<asnode_t> asnode1(123, string_t::hold("AS 123"));
+         asnode1.hits = 10;
+         asnode1.xfer = 12345;
+
+         storable_t<asnode_t> asnode2(456, string_t::hold("AS 456"));
+         asnode2.visits = 5;
+
+         EXPECT_TRUE(snapshot.write_node(asnode1));
+         EXPECT_TRUE(snapshot.write_node(asnode2));
+         EXPECT_TRUE(snapshot.end_section());
+
+         // an empty section
+         EXPECT_TRUE(snapshot.end_section());
+
+         ASSERT_TRUE(snapshot.commit());
+      }
+};
+
+///
+/// @brief  Writes a few nodes into a snapshot and reads them back.
+///
+TEST_F(SnapshotTest, WriteReadNodes)
+{
+   snapshot_t snapshot;
+   storable_t<asnode_t> asnode;
+
+   write_snapshot(0x123456789ABCDEFull);
+
+   ASSERT_TRUE(snapshot.open(path, 1, 0x123456789ABCDEFull));
+
+   ASSERT_TRUE(snapshot.read_node(asnode));
+   EXPECT_EQ(123, asnode.nodeid);
+   EXPECT_STREQ("AS 123", asnode.as_org.c_str());
+   EXPECT_EQ(10, asnode.hits);
+   EXPECT_EQ(12345, asnode.xfer);
+   EXPECT_FALSE(asnode.storage_info.dirty);
+
+   ASSERT_TRUE(snapshot.read_node(asnode));
+   EXPECT_EQ(456, asnode.nodeid);
+   EXPECT_STREQ("AS 456", asnode.as_org.c_str());
+   EXPECT_EQ(5, asnode.visits);
+
+   // end of the first section
+   EXPECT_FALSE(snapshot.read_node(asnode));
+   EXPECT_FALSE(snapshot.is_error());
+
+   // the second section is empty
+   EXPECT_FALSE(snapshot.read_node(asnode));
+   EXPECT_FALSE(snapshot.is_error());
+
+   // reading past the last section is an error
+   EXPECT_FALSE(snapshot.read_node(asnode));
+   EXPECT_TRUE(snapshot.is_error());
+}
+
+///
+/// @brief  Snapshots may only be opened for the checkpoint and the application
+///         version they were created for.
+///
+TEST_F(SnapshotTest, StaleSnapshot)
+{
+   snapshot_t snapshot;
+
+   write_snapshot(100);
+
+   EXPECT_FALSE(snapshot.open(path, 1, 101)) << "Checkpoint mismatch";
+   EXPECT_FALSE(snapshot.open(path, 2, 100)) << "Application version mismatch";
+   EXPECT_FALSE(snapshot.open(path + ".missing", 1, 100)) << "Missing snapshot file";
+
+   EXPECT_TRUE(snapshot.open(path, 1, 100));
+}
+
+///
+/// @brief  A truncated snapshot is reported as an error when the missing record
+///         is being read.
+///
+TEST_F(SnapshotTest, TruncatedSnapshot)
+{
+   snapshot_t snapshot;
+   storable_t<asnode_t> asnode;
+   FILE *file;
+   long size;
+
+   write_snapshot(100);
+
+   // read the snapshot and write it back without the last few bytes
+   ASSERT_NE(nullptr, (file = fopen(path, "rb")));
+   fseek(file, 0, SEEK_END);
+   size = ftell(file);
+   fseek(file, 0, SEEK_SET);
+
+   std::vector<char> data((size_t) size);
+   ASSERT_EQ(data.size(), fread(data.data(), 1, data.size(), file));
+   fclose(file);
+
+   ASSERT_NE(nullptr, (file = fopen(path, "wb")));
+   ASSERT_EQ(data.size() - 20, fwrite(data.data(), 1, data.size() - 20, file));
+   fclose(file);
+
+   ASSERT_TRUE(snapshot.open(path, 1, 100));
+
+   ASSERT_TRUE(snapshot.read_node(asnode));
+   EXPECT_EQ(123, asnode.nodeid);
+
+   // the second node is truncated
+   EXPECT_FALSE(snapshot.read_node(asnode));
+   EXPECT_TRUE(snapshot.is_error());
+}
+
+}
@@ -0,0 +1,134 @@
+/*
+   webalizer - a web server log analysis program
+
+   Copyright (c) 2004-2022, Stone Steps Inc. (www.stonesteps.ca)
+
+   See COPYING and Copyright files for additional licensing and copyright information
+
+   ut_srchargs.cpp
+*/
+#include "pch.h"
+
+#include "../srch_args.h"
+
+#include <string>
+
+namespace sswtest {
+
+///
+/// @brief  Appends descriptors for all search arguments in the query string, same
+///         as they are tokenized when search arguments are filtered.
+///
+static void TokenizeArgs(const std::string& srchargs, srch_args_t& sr_args)
+{
+   const char *cptr = srchargs.c_str();
+   arginfo_t arginfo;
+
+   while(*cptr) {
+      while(*cptr == '&') cptr++;
+      arginfo.arg = cptr;
+      while(*cptr && *cptr != '=' && *cptr != '&') cptr++;
+      arginfo.namelen = cptr - arginfo.arg;
+      while(*cptr && *cptr != '&') cptr++;
+      arginfo.arglen = cptr - arginfo.arg;
+
+      sr_args.push_back(arginfo);
+   }
+}
+
+///
+/// @brief  Builds a query string with the specified number of arguments, with names
+///         in the descending order (e.g. `n02=0&n01=1&n00=2`).
+///
+static std::string MakeQueryString(size_t count)
+{
+   std::string srchargs;
+   char buffer[32];
+
+   for(size_t i = 0; i < count; i++) {
+      snprintf(buffer, sizeof(buffer), "%sn%03zu=%zu", i ? "&" : "", count - i - 1, i);
+      srchargs += buffer;
+   }
+
+   return srchargs;
+}
+
+///
+/// @brief  Descriptors beyond the fixed capacity are moved into the spill vector
+///         without changing their order and the array returns to the fixed storage
+///         when it is cleared.
+///
+TEST(SearchArgsTest, SpillBeyondFixedSize)
+{
+   std::string srchargs = MakeQueryString(srch_args_t::FIXED_SIZE + 5);
+   std::string fixedargs = MakeQueryString(3);
+   srch_args_t sr_args;
+
+   TokenizeArgs(srchargs, sr_args);
+
+   ASSERT_EQ(srch_args_t::FIXED_SIZE + 5, sr_args.size());
+   EXPECT_EQ(sr_args.size(), (size_t) (sr_args.end() - sr_args.begin()));
+
+   // all descriptors should point to consecutive arguments in the query string
+   for(size_t i = 0; i < sr_args.size(); i++) {
+      char name[16];
+
+      snprintf(name, sizeof(name), "n%03zu", sr_args.size() - i - 1);
+
+      EXPECT_EQ(std::string(name), std::string(sr_args[i].name(), sr_args[i].namelen)) << "Argument " << i;
+      EXPECT_EQ(std::to_string(i), std::string(sr_args[i].value(), sr_args[i].value_length())) << "Argument " << i;
+   }
+
+   // an array that was spilled should be reusable for a short query string
+   sr_args.clear();
+   EXPECT_TRUE(sr_args.empty());
+
+   TokenizeArgs(fixedargs, sr_args);
+
+   ASSERT_EQ(3, sr_args.size());
+   EXPECT_EQ(0, strncmp(sr_args[0].arg, "n002=0", sr_args[0].arglen));
+   EXPECT_EQ(0, strncmp(sr_args[2].arg, "n000=2", sr_args[2].arglen));
+}
+
+///
+/// @brief  Search arguments are sorted by name and arguments with the same name
+///         remain in their original order, whether they are stored in the fixed
+///         array or in the spill vector.
+///
+TEST(SearchArgsTest, SortByName)
+{
+   for(size_t count : {(size_t) 5, srch_args_t::FIXED_SIZE, srch_args_t::FIXED_SIZE + 10}) {
+      std::string srchargs = MakeQueryString(count);
+      srch_args_t sr_args;
+
+      // duplicate names with values in the descending order and a nameless argument
+      srchargs += "&n001=z&n001=a&=x&n000";
+
+      TokenizeArgs(srchargs, sr_args);
+
+      ASSERT_EQ(count + 4, sr_args.size());
+
+      sr_args.sort_by_name();
+
+      ASSERT_EQ(count + 4, sr_args.size());
+
+      // nameless arguments sort before any named ones
+      EXPECT_EQ(0, sr_args[0].namelen) << "Count " << count;
+      EXPECT_EQ(0, strncmp(sr_args[0].arg, "=x", sr_args[0].arglen)) << "Count " << count;
+
+      for(size_t i = 2; i < sr_args.size(); i++)
+         EXPECT_LE(arginfo_t::name_cmp(&sr_args[i-1], &sr_args[i]), 0) << "Count " << count << ", argument " << i;
+
+      // n000 from the generated query string, followed by the bare n000
+      EXPECT_EQ(0, strncmp(sr_args[1].arg, "n000=", 5)) << "Count " << count;
+      EXPECT_EQ(0, strncmp(sr_args[2].arg, "n000", sr_args[2].arglen)) << "Count " << count;
+      EXPECT_EQ(4, sr_args[2].arglen) << "Count " << count;
+
+      // n001 from the generated query string, followed by z and a in the original order
+      EXPECT_EQ(0, strncmp(sr_args[3].arg, "n001=", 5)) << "Count " << count;
+      EXPECT_EQ(0, strncmp(sr_args[4].arg, "n001=z", sr_args[4].arglen)) << "Count " << count;
+      EXPECT_EQ(0, strncmp(sr_args[5].arg, "n001=a", sr_args[5].arglen)) << "Count " << count;
+   }
+}
+
+}
@@ -0,0 +1,186 @@
+/*
+   webalizer - a web server log analysis program
+
+   Copyright (c) 2004-2022, Stone Steps Inc. (www.stonesteps.ca)
+
+   See COPYING and Copyright files for additional licensing and copyright information
+
+   ut_timer_wheel.cpp
+*/
+#include "pch.h"
+
+#include "../timer_wheel.h"
+
+#include <vector>
+
+namespace sswtest {
+
+///
+/// @brief  A timer node with an identifier to track which nodes expired.
+///
+struct test_node_t : public timer_node_t {
+   int id;
+
+   test_node_t(int id = 0) : id(id) {}
+};
+
+///
+/// @brief  Collects identifiers of expired nodes.
+///
+struct expired_t {
+   std::vector<int> ids;
+
+   void operator () (timer_node_t& node) {ids.push_back(static_cast<test_node_t&>(node).id);}
+};
+
+///
+/// @brief  Only nodes expiring at or before the specified time are expired and
+///         they are expired in the order of their expiry slots.
+///
+TEST(TimerWheelTest, ExpireOrder)
+{
+   timer_wheel_t wheel(256);
+   test_node_t nodes[] = {1, 2, 3, 4};
+   expired_t expired;
+
+   // each slot is 2 seconds wide for this timeout
+   wheel.schedule(nodes[0], 1000);
+   wheel.schedule(nodes[2], 1030);
+   wheel.schedule(nodes[3], 1200);
+   wheel.schedule(nodes[1], 1010);
+
+   wheel.expire(999, [&expired](timer_node_t& node) {expired(node);});
+   EXPECT_TRUE(expired.ids.empty());
+
+   wheel.expire(1030, [&expired](timer_node_t& node) {expired(node);});
+   ASSERT_EQ(3, expired.ids.size());
+   EXPECT_EQ(1, expired.ids[0]);
+   EXPECT_EQ(2, expired.ids[1]);
+   EXPECT_EQ(3, expired.ids[2]);
+
+   EXPECT_FALSE(nodes[0].is_scheduled());
+   EXPECT_TRUE(nodes[3].is_scheduled());
+   EXPECT_FALSE(wheel.is_empty());
+
+   expired.ids.clear();
+   wheel.expire(1200, [&expired](timer_node_t& node) {expired(node);});
+   ASSERT_EQ(1, expired.ids.size());
+   EXPECT_EQ(4, expired.ids[0]);
+
+   EXPECT_TRUE(wheel.is_empty());
+}
+
+///
+/// @brief  Nodes sharing a slot with an expired node remain scheduled if they
+///         are not due yet and nodes rescheduled by the callback are expired
+///         in a later call.
+///
+TEST(TimerWheelTest, Reschedule)
+{
+   timer_wheel_t wheel(256);
+   test_node_t node1(1), node2(2);
+   expired_t expired;
+
+   wheel.schedule(node1, 1000);
+   wheel.schedule(node2, 1001);
+
+   wheel.expire(1000, [&expired](timer_node_t& node) {expired(node);});
+   ASSERT_EQ(1, expired.ids.size());
+   EXPECT_EQ(1, expired.ids[0]);
+   EXPECT_TRUE(node2.is_scheduled());
+   EXPECT_EQ(1001, node2.get_expiry());
+
+   // a lower bound expiry time is pushed out when the node expires
+   wheel.expire(1001, [&wheel](timer_node_t& node) {wheel.schedule(node, 1100);});
+   EXPECT_TRUE(node2.is_scheduled());
+   EXPECT_EQ(1100, node2.get_expiry());
+
+   expired.ids.clear();
+   wheel.expire(1099, [&expired](timer_node_t& node) {expired(node);});
+   EXPECT_TRUE(expired.ids.empty());
+
+   wheel.expire(1100, [&expired](timer_node_t& node) {expired(node);});
+   ASSERT_EQ(1, expired.ids.size());
+   EXPECT_EQ(2, expired.ids[0]);
+
+   // nodes scheduled in the past expire at the next call
+   wheel.schedule(node1, 500);
+
+   expired.ids.clear();
+   wheel.expire(1100, [&expired](timer_node_t& node) {expired(node);});
+   ASSERT_EQ(1, expired.ids.size());
+   EXPECT_EQ(1, expired.ids[0]);
+}
+
+///
+/// @brief  Nodes expiring past the last slot are kept in the overflow list and
+///         expire at the right time after a few wheel rotations, whether time
+///         advances in small steps or jumps past the entire wheel.
+///
+TEST(TimerWheelTest, Overflow)
+{
+   timer_wheel_t wheel(128);
+   test_node_t node1(1), node2(2), node3(3);
+   expired_t expired;
+
+   // each slot is 1 second wide for this timeout and the wheel spans 256 seconds
+   wheel.schedule(node1, 1000);
+   wheel.schedule(node2, 1000 + 1000);
+   wheel.schedule(node3, 1000 + 100000);
+
+   for(int64_t now = 1000; now < 2000; now += 10) {
+      wheel.expire(now, [&expired](timer_node_t& node) {expired(node);});
+      ASSERT_EQ(1, expired.ids.size());
+   }
+
+   wheel.expire(2000, [&expired](timer_node_t& node) {expired(node);});
+   ASSERT_EQ(2, expired.ids.size());
+   EXPECT_EQ(2, expired.ids[1]);
+
+   wheel.expire(100999, [&expired](timer_node_t& node) {expired(node);});
+   ASSERT_EQ(2, expired.ids.size());
+   EXPECT_TRUE(node3.is_scheduled());
+
+   wheel.expire(101000, [&expired](timer_node_t& node) {expired(node);});
+   ASSERT_EQ(3, expired.ids.size());
+   EXPECT_EQ(3, expired.ids[2]);
+
+   EXPECT_TRUE(wheel.is_empty());
+}
+
+///
+/// @brief  Destroyed nodes remove themselves from the wheel and all remaining
+///         nodes are expired regardless of time or removed without callbacks.
+///
+TEST(TimerWheelTest, ExpireAllAndClear)
+{
+   timer_wheel_t wheel(60);
+   test_node_t node1(1), node3(3);
+   expired_t expired;
+
+   {
+      test_node_t node2(2);
+
+      wheel.schedule(node1, 1000);
+      wheel.schedule(node2, 2000);
+      wheel.schedule(node3, 900000);
+   }
+
+   wheel.expire_all([&expired](timer_node_t& node) {expired(node);});
+   ASSERT_EQ(2, expired.ids.size());
+   EXPECT_EQ(1, expired.ids[0]);
+   EXPECT_EQ(3, expired.ids[1]);
+
+   EXPECT_TRUE(wheel.is_empty());
+
+   wheel.schedule(node1, 1000);
+   wheel.schedule(node3, 900000);
+
+   wheel.clear();
+
+   EXPECT_TRUE(wheel.is_empty());
+   EXPECT_FALSE(node1.is_scheduled());
+   EXPECT_FALSE(node3.is_scheduled());
+}
+
+}
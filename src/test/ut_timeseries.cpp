@@ -0,0 +1,152 @@
+/*
+   webalizer - a web server log analysis program
+
+   Copyright (c) 2004-2022, Stone Steps Inc. (www.stonesteps.ca)
+
+   See COPYING and Copyright files for additional licensing and copyright information
+
+   ut_timeseries.cpp
+*/
+#include "pch.h"
+
+#include "../timeseries.h"
+#include "../tstring.h"
+
+#include <cstdio>
+#include <vector>
+
+namespace sswtest {
+
+///
+/// @brief  Tests that hourly records are appended in the time order and may be read
+///         back for any time range, including ranges spanning months.
+///
+TEST(TimeSeries, AppendReadHours)
+{
+   string_t path(string_t(testing::TempDir().c_str()) + "ut_timeseries_read.tsh");
+   timeseries_t timeseries(path);
+   std::vector<timeseries_t::hour_t> hours;
+
+   remove(path);
+
+   // the last 3 hours of December and the first 2 hours of January
+   for(u_int hour = 21; hour < 24; hour++)
+      hours.emplace_back(2022, 12, 31, hour, hour, 2, 3, 4, 5, 6000);
+
+   ASSERT_TRUE(timeseries.append_hours(hours));
+
+   hours.clear();
+
+   for(u_int hour = 0; hour < 2; hour++)
+      hours.emplace_back(2023, 1, 1, hour, 100 + hour, 2, 3, 4, 5, 6000);
+
+   ASSERT_TRUE(timeseries.append_hours(hours));
+
+   ASSERT_TRUE(timeseries.read_hours(timeseries_t::make_time(2022, 12, 31, 23), timeseries_t::make_time(2023, 1, 1, 0), hours));
+   ASSERT_EQ(2, hours.size());
+
+   EXPECT_EQ(2022123123, hours[0].time);
+   EXPECT_EQ(23, hours[0].hits);
+   EXPECT_EQ(2023010100, hours[1].time);
+   EXPECT_EQ(100, hours[1].hits);
+   EXPECT_EQ(2, hours[1].files);
+   EXPECT_EQ(3, hours[1].pages);
+   EXPECT_EQ(4, hours[1].visits);
+   EXPECT_EQ(5, hours[1].hosts);
+   EXPECT_EQ(6000, hours[1].xfer);
+
+   // the range may start and end between records
+   ASSERT_TRUE(timeseries.read_hours(timeseries_t::make_time(2022, 12, 1, 0), timeseries_t::make_time(2022, 12, 31, 22), hours));
+   ASSERT_EQ(2, hours.size());
+   EXPECT_EQ(2022123121, hours[0].time);
+   EXPECT_EQ(2022123122, hours[1].time);
+
+   ASSERT_TRUE(timeseries.read_hours(timeseries_t::make_time(2023, 2, 1, 0), timeseries_t::make_time(2023, 2, 28, 23), hours));
+   EXPECT_TRUE(hours.empty());
+
+   ASSERT_TRUE(timeseries.read_hours(0, UINT32_MAX, hours));
+   EXPECT_EQ(5, hours.size());
+
+   remove(path);
+}
+
+///
+/// @brief  Tests that hours already in the file are not appended again and that an
+///         incomplete record left by a failed write is overwritten.
+///
+TEST(TimeSeries, AppendExistingHours)
+{
+   string_t path(string_t(testing::TempDir().c_str()) + "ut_timeseries_append.tsh");
+   timeseries_t timeseries(path);
+   std::vector<timeseries_t::hour_t> hours;
+   FILE *file;
+
+   remove(path);
+
+   hours.emplace_back(2022, 12, 1, 10, 1, 0, 0, 0, 0, 0);
+   hours.emplace_back(2022, 12, 1, 11, 2, 0, 0, 0, 0, 0);
+
+   ASSERT_TRUE(timeseries.append_hours(hours));
+
+   // the hour in progress is kept in the state, so the same logs processed again produce the same hours
+   hours.emplace_back(2022, 12, 1, 12, 3, 0, 0, 0, 0, 0);
+   hours[0].hits = 100;
+
+   ASSERT_TRUE(timeseries.append_hours(hours));
+
+   ASSERT_TRUE(timeseries.read_hours(0, UINT32_MAX, hours));
+   ASSERT_EQ(3, hours.size());
+   EXPECT_EQ(1, hours[0].hits);
+   EXPECT_EQ(2022120112, hours[2].time);
+   EXPECT_EQ(3, hours[2].hits);
+
+   // simulate a write that failed in the middle of a record
+   ASSERT_NE(nullptr, (file = fopen(path, "ab")));
+   ASSERT_EQ(1, fwrite("partial", 7, 1, file));
+   fclose(file);
+
+   ASSERT_TRUE(timeseries.read_hours(0, UINT32_MAX, hours));
+   EXPECT_EQ(3, hours.size());
+
+   hours.assign(1, timeseries_t::hour_t(2022, 12, 1, 13, 4, 0, 0, 0, 0, 0));
+
+   ASSERT_TRUE(timeseries.append_hours(hours));
+
+   ASSERT_TRUE(timeseries.read_hours(timeseries_t::make_time(2022, 12, 1, 12), UINT32_MAX, hours));
+   ASSERT_EQ(2, hours.size());
+   EXPECT_EQ(2022120113, hours[1].time);
+   EXPECT_EQ(4, hours[1].hits);
+
+   remove(path);
+}
+
+///
+/// @brief  Tests that a missing file is an empty time series and that a file in an
+///         unknown format is rejected.
+///
+TEST(TimeSeries, BadFile)
+{
+   string_t path(string_t(testing::TempDir().c_str()) + "ut_timeseries_bad.tsh");
+   timeseries_t timeseries(path);
+   std::vector<timeseries_t::hour_t> hours;
+   FILE *file;
+
+   remove(path);
+
+   ASSERT_TRUE(timeseries.read_hours(0, UINT32_MAX, hours));
+   EXPECT_TRUE(hours.empty());
+
+   ASSERT_NE(nullptr, (file = fopen(path, "wb")));
+   ASSERT_EQ(1, fwrite("Not a time series file", 22, 1, file));
+   fclose(file);
+
+   hours.emplace_back(2022, 12, 1, 0, 1, 0, 0, 0, 0, 0);
+
+   EXPECT_FALSE(timeseries.append_hours(hours));
+   EXPECT_FALSE(timeseries.read_hours(0, UINT32_MAX, hours));
+   EXPECT_TRUE(hours.empty());
+
+   remove(path);
+}
+
+}
@@ -492,5 +492,33 @@ TEST_F(TimeStampTest, CompareSameComponentsDiffTimeZones)
    EXPECT_EQ(tstamp_utc, tstamp);
 }
 
+///
+/// @brief  Time stamps representing the same time in different time zones are
+///         equal, but only time stamps with the same components are the same.
+///
+TEST_F(TimeStampTest, IsSameTimeStamp)
+{
+   const tstamp_t tstamp_lcl_neg5hrs(2018, 4, 26, 10, 10, 25, -300);
+   const tstamp_t tstamp_utc(2018, 4, 26, 15, 10, 25);
+
+   tstamp_t tstamp;
+
+   // uninitialized time stamps are the same
+   EXPECT_TRUE(tstamp.is_same(tstamp_t()));
+
+   tstamp.reset(2018, 4, 26, 10, 10, 25, -300);
+   EXPECT_TRUE(tstamp.is_same(tstamp_lcl_neg5hrs));
+   EXPECT_FALSE(tstamp.is_same(tstamp_utc));
+   EXPECT_FALSE(tstamp.is_same(tstamp_t()));
+
+   tstamp.toutc();
+   EXPECT_EQ(tstamp_utc, tstamp_lcl_neg5hrs);
+   EXPECT_TRUE(tstamp.is_same(tstamp_utc));
+   EXPECT_FALSE(tstamp.is_same(tstamp_lcl_neg5hrs));
+
+   tstamp.shift(1);
+   EXPECT_FALSE(tstamp.is_same(tstamp_utc));
+}
+
 }
 
@@ -0,0 +1,187 @@
+/*
+    webalizer - a web server log analysis program
+
+    Copyright (c) 2004-2022, Stone Steps Inc. (www.stonesteps.ca)
+
+    See COPYING and Copyright files for additional licensing and copyright information
+
+    timer_wheel.cpp
+*/
+#include "pch.h"
+
+#include "timer_wheel.h"
+
+#include <algorithm>
+
+//
+// timer_node_t
+//
+
+void timer_node_t::unschedule(void)
+{
+   if(prev) {
+      prev->next = next;
+      next->prev = prev;
+
+      prev = next = nullptr;
+   }
+}
+
+///
+/// Links this node at the end of the list starting with `head`.
+///
+void timer_node_t::link(timer_node_t& head)
+{
+   prev = head.prev;
+   next = &head;
+
+   head.prev->next = this;
+   head.prev = this;
+}
+
+///
+/// Moves all nodes from the list starting with `head` to the end of the list
+/// starting with this node and leaves `head` empty.
+///
+void timer_node_t::splice(timer_node_t& head)
+{
+   if(head.next == &head)
+      return;
+
+   head.next->prev = prev;
+   prev->next = head.next;
+
+   head.prev->next = this;
+   prev = head.prev;
+
+   head.prev = head.next = &head;
+}
+
+//
+// timer_wheel_t
+//
+
+///
+/// The slot width is chosen so nodes expiring within `timeout` seconds fit into
+/// half of the wheel, which leaves the other half for nodes that are scheduled
+/// slightly later than expected, such as when log records are out of order.
+///
+timer_wheel_t::timer_wheel_t(int64_t timeout) :
+      slot_width(std::max((int64_t) 1, (timeout + (int64_t) SLOT_COUNT / 2 - 1) / ((int64_t) SLOT_COUNT / 2))),
+      base(0),
+      started(false)
+{
+   for(size_t index = 0; index < SLOT_COUNT; index++)
+      slots[index].prev = slots[index].next = &slots[index];
+
+   overflow.prev = overflow.next = &overflow;
+}
+
+timer_wheel_t::~timer_wheel_t(void)
+{
+   clear();
+
+   // slot heads are not linked to any nodes at this point
+   for(size_t index = 0; index < SLOT_COUNT; index++)
+      slots[index].prev = slots[index].next = nullptr;
+
+   overflow.prev = overflow.next = nullptr;
+}
+
+timer_node_t *timer_wheel_t::pop(timer_node_t& head)
+{
+   timer_node_t *node;
+
+   if(head.next == &head)
+      return nullptr;
+
+   node = head.next;
+   node->unschedule();
+
+   return node;
+}
+
+///
+/// Nodes expiring before the start of the current slot, such as those that are
+/// scheduled to expire immediately, are placed in the current slot.
+///
+void timer_wheel_t::schedule(timer_node_t& node, int64_t expiry)
+{
+   node.unschedule();
+
+   node.expiry = expiry;
+
+   if(!started) {
+      base = expiry - expiry % slot_width;
+      started = true;
+   }
+
+   if(expiry < base + slot_width)
+      node.link(slots[slot_index(base)]);
+   else if(expiry - base >= (int64_t) SLOT_COUNT * slot_width)
+      node.link(overflow);
+   else
+      node.link(slots[slot_index(expiry)]);
+}
+
+///
+/// Moves nodes from all slots between the current one and the one containing `now`
+/// into the `pending` list and makes the latter slot current. Overflow nodes are
+/// moved into the `pending` list each time the wheel completes a rotation, so they
+/// can be rescheduled into slots. If `now` is past the last slot, all nodes are
+/// collected.
+///
+void timer_wheel_t::collect(int64_t now, timer_node_t& pending)
+{
+   if(!started)
+      return;
+
+   if(now - base >= (int64_t) SLOT_COUNT * slot_width) {
+      collect_all(pending);
+      base = now - now % slot_width;
+      return;
+   }
+
+   while(true) {
+      pending.splice(slots[slot_index(base)]);
+
+      if(now < base + slot_width)
+         break;
+
+      base += slot_width;
+
+      if(slot_index(base) == 0)
+         pending.splice(overflow);
+   }
+}
+
+void timer_wheel_t::collect_all(timer_node_t& pending)
+{
+   for(size_t index = 0; index < SLOT_COUNT; index++)
+      pending.splice(slots[index]);
+
+   pending.splice(overflow);
+}
+
+void timer_wheel_t::clear(void)
+{
+   for(size_t index = 0; index < SLOT_COUNT; index++) {
+      while(slots[index].next != &slots[index])
+         slots[index].next->unschedule();
+   }
+
+   while(overflow.next != &overflow)
+      overflow.next->unschedule();
+
+   started = false;
+}
+
+bool timer_wheel_t::is_empty(void) const
+{
+   for(size_t index = 0; index < SLOT_COUNT; index++) {
+      if(slots[index].next != &slots[index])
+         return false;
+   }
+
+   return overflow.next == &overflow;
+}
@@ -0,0 +1,166 @@
+/*
+    webalizer - a web server log analysis program
+
+    Copyright (c) 2004-2022, Stone Steps Inc. (www.stonesteps.ca)
+
+    See COPYING and Copyright files for additional licensing and copyright information
+
+    timer_wheel.h
+*/
+#ifndef TIMER_WHEEL_H
+#define TIMER_WHEEL_H
+
+#include "types.h"
+
+#include <cstdint>
+
+class timer_wheel_t;
+
+///
+/// @brief  A node that may be scheduled to expire in a timer wheel.
+///
+/// Scheduled nodes are linked into circular doubly-linked lists, one per timer
+/// wheel slot, so a node can remove itself from a timer wheel without having
+/// access to the wheel, which happens when the node is destroyed. Copying or
+/// moving a node does not copy its schedule.
+///
+class timer_node_t {
+   friend class timer_wheel_t;
+
+   private:
+      timer_node_t   *prev;         ///< Previous node in the slot list, or `nullptr` if not scheduled
+      timer_node_t   *next;         ///< Next node in the slot list, or `nullptr` if not scheduled
+      int64_t        expiry;        ///< Expiry time, in seconds
+
+   private:
+      void link(timer_node_t& head);
+
+      void splice(timer_node_t& head);
+
+   public:
+      timer_node_t(void) : prev(nullptr), next(nullptr), expiry(0) {}
+
+      timer_node_t(const timer_node_t&) noexcept : timer_node_t() {}
+
+      ~timer_node_t(void) {unschedule();}
+
+      timer_node_t& operator = (const timer_node_t&) {return *this;}
+
+      /// Returns `true` if this node is scheduled in a timer wheel.
+      bool is_scheduled(void) const {return prev != nullptr;}
+
+      /// Returns the time when this node expires, in seconds.
+      int64_t get_expiry(void) const {return expiry;}
+
+      /// Removes this node from its timer wheel, if it is scheduled.
+      void unschedule(void);
+};
+
+///
+/// @brief  A timer wheel that finds nodes that expired by some time without having
+///         to examine all nodes that are not expired yet.
+///
+/// The wheel consists of `SLOT_COUNT` slots, each of which holds nodes expiring
+/// within a time interval of `slot_width` seconds. Nodes expiring past the last
+/// slot are kept in the overflow list, which is distributed into slots each time
+/// the wheel completes a rotation, which makes it a two-level hierarchical wheel.
+///
+/// Expiry times are treated as lower bounds. Nodes may be scheduled once and have
+/// their actual expiry time checked when they are popped from the wheel, which
+/// allows callers to reschedule nodes that have not expired yet, instead of
+/// updating their schedule every time the underlying expiry time changes.
+///
+class timer_wheel_t {
+   private:
+      static const size_t SLOT_COUNT = 256;
+
+   private:
+      int64_t        slot_width;    ///< Time interval covered by one slot, in seconds
+      int64_t        base;          ///< Start time of the current slot
+      bool           started;       ///< Has the current slot been set?
+
+      timer_node_t   slots[SLOT_COUNT]; ///< Slot list heads
+      timer_node_t   overflow;      ///< Nodes expiring past the last slot
+
+   private:
+      size_t slot_index(int64_t time) const {return (size_t) ((time / slot_width) % SLOT_COUNT);}
+
+      void collect(int64_t now, timer_node_t& pending);
+
+      void collect_all(timer_node_t& pending);
+
+      static timer_node_t *pop(timer_node_t& head);
+
+   public:
+      timer_wheel_t(int64_t timeout);
+
+      ~timer_wheel_t(void);
+
+      timer_wheel_t(const timer_wheel_t&) = delete;
+      timer_wheel_t& operator = (const timer_wheel_t&) = delete;
+
+      /// Schedules or reschedules a node to expire at the specified time.
+      void schedule(timer_node_t& node, int64_t expiry);
+
+      /// Removes all nodes from the wheel.
+      void clear(void);
+
+      /// Returns `true` if there are no scheduled nodes.
+      bool is_empty(void) const;
+
+      /// Removes nodes expiring at or before `now` and calls `expire_cb` for each of them.
+      template <typename expire_cb_t>
+      void expire(int64_t now, expire_cb_t expire_cb);
+
+      /// Removes all nodes and calls `expire_cb` for each of them.
+      template <typename expire_cb_t>
+      void expire_all(expire_cb_t expire_cb);
+};
+
+///
+/// Nodes that are not due yet are rescheduled, which may only happen for those in
+/// the slot containing `now` and for those in the overflow list. The callback is
+/// called with an unscheduled node and may schedule it again. Nodes scheduled by
+/// the callback are not evaluated again until the next call.
+///
+template <typename expire_cb_t>
+void timer_wheel_t::expire(int64_t now, expire_cb_t expire_cb)
+{
+   timer_node_t pending;
+   timer_node_t *node;
+
+   pending.prev = pending.next = &pending;
+
+   collect(now, pending);
+
+   while((node = pop(pending)) != nullptr) {
+      if(node->expiry > now)
+         schedule(*node, node->expiry);
+      else
+         expire_cb(*node);
+   }
+
+   pending.prev = pending.next = nullptr;
+}
+
+///
+/// The callback is called with an unscheduled node and may schedule it again,
+/// but nodes scheduled by the callback are not evaluated until the next call.
+///
+template <typename expire_cb_t>
+void timer_wheel_t::expire_all(expire_cb_t expire_cb)
+{
+   timer_node_t pending;
+   timer_node_t *node;
+
+   pending.prev = pending.next = &pending;
+
+   collect_all(pending);
+
+   while((node = pop(pending)) != nullptr)
+      expire_cb(*node);
+
+   pending.prev = pending.next = nullptr;
+}
+
+#endif // TIMER_WHEEL_H
@@ -0,0 +1,168 @@
+/*
+    webalizer - a web server log analysis program
+
+    Copyright (c) 2004-2022, Stone Steps Inc. (www.stonesteps.ca)
+
+    See COPYING and Copyright files for additional licensing and copyright information
+
+    timeseries.cpp
+*/
+#include "pch.h"
+
+#include "timeseries.h"
+
+timeseries_t::timeseries_t(const string_t& path) : path(path)
+{
+}
+
+///
+/// Validates the file header and returns the number of complete hourly records in
+/// `count`. Returns `false` if the file was created on a platform with a different
+/// byte order or in a different format.
+///
+bool timeseries_t::read_header(FILE *file, size_t& count) const
+{
+   header_t header;
+   long filesize;
+
+   if(fseek(file, 0, SEEK_SET) || fread(&header, sizeof(header), 1, file) != 1)
+      return false;
+
+   if(header.signature != SIGNATURE || header.version != FORMAT_VERSION || header.byte_order != BYTE_ORDER_VALUE || header.record_size != sizeof(hour_t))
+      return false;
+
+   if(fseek(file, 0, SEEK_END) || (filesize = ftell(file)) < (long) sizeof(header))
+      return false;
+
+   // ignore an incomplete record left by a failed append
+   count = (filesize - sizeof(header)) / sizeof(hour_t);
+
+   return true;
+}
+
+bool timeseries_t::read_time(FILE *file, size_t index, uint32_t& time) const
+{
+   hour_t hour;
+
+   if(fseek(file, (long) (sizeof(header_t) + index * sizeof(hour_t)), SEEK_SET) || fread(&hour, sizeof(hour_t), 1, file) != 1)
+      return false;
+
+   time = hour.time;
+
+   return true;
+}
+
+///
+/// Returns in `index` the position of the first record with a time that is not less
+/// than `time`, or `count` if there is no such record.
+///
+bool timeseries_t::find_time(FILE *file, size_t count, uint32_t time, size_t& index) const
+{
+   size_t first = 0, last = count, mid;
+   uint32_t midtime;
+
+   while(first < last) {
+      mid = first + (last - first) / 2;
+
+      if(!read_time(file, mid, midtime))
+         return false;
+
+      if(midtime < time)
+         first = mid + 1;
+      else
+         last = mid;
+   }
+
+   index = first;
+
+   return true;
+}
+
+///
+/// Hourly records in `hours` must be ordered by time. A new file is created if there
+/// is no time series file yet.
+///
+bool timeseries_t::append_hours(const std::vector<hour_t>& hours) const
+{
+   std::vector<hour_t>::const_iterator first = hours.begin();
+   size_t count = 0;
+   uint32_t lasttime;
+   FILE *file;
+   bool error = false;
+
+   if(hours.empty())
+      return true;
+
+   if((file = fopen(path, "r+b")) != nullptr) {
+      if(!read_header(file, count))
+         error = true;
+      else if(count) {
+         // skip hours that are already in the file
+         if(!read_time(file, count - 1, lasttime))
+            error = true;
+         else {
+            while(first != hours.end() && first->time <= lasttime)
+               ++first;
+         }
+      }
+   }
+   else {
+      header_t header = {SIGNATURE, FORMAT_VERSION, BYTE_ORDER_VALUE, sizeof(hour_t)};
+
+      if((file = fopen(path, "w+b")) == nullptr)
+         return false;
+
+      if(fwrite(&header, sizeof(header), 1, file) != 1)
+         error = true;
+   }
+
+   if(!error && first != hours.end()) {
+      size_t newcount = hours.end() - first;
+
+      if(fseek(file, (long) (sizeof(header_t) + count * sizeof(hour_t)), SEEK_SET) || fwrite(&*first, sizeof(hour_t), newcount, file) != newcount)
+         error = true;
+   }
+
+   if(fclose(file))
+      error = true;
+
+   return !error;
+}
+
+///
+/// Both ends of the time range are located with a binary search and all records
+/// in the range are read in a single read. A missing file is treated as an empty
+/// time series.
+///
+bool timeseries_t::read_hours(uint32_t first, uint32_t last, std::vector<hour_t>& hours) const
+{
+   size_t count, begin, end;
+   FILE *file;
+   bool error = false;
+
+   hours.clear();
+
+   if((file = fopen(path, "rb")) == nullptr)
+      return true;
+
+   if(!read_header(file, count) || !find_time(file, count, first, begin) || (last < UINT32_MAX && !find_time(file, count, last + 1, end)))
+      error = true;
+   else {
+      if(last == UINT32_MAX)
+         end = count;
+
+      if(begin < end) {
+         hours.resize(end - begin);
+
+         if(fseek(file, (long) (sizeof(header_t) + begin * sizeof(hour_t)), SEEK_SET) || fread(hours.data(), sizeof(hour_t), hours.size(), file) != hours.size())
+            error = true;
+      }
+   }
+
+   fclose(file);
+
+   if(error)
+      hours.clear();
+
+   return !error;
+}
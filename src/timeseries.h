@@ -0,0 +1,98 @@
+/*
+    webalizer - a web server log analysis program
+
+    Copyright (c) 2004-2022, Stone Steps Inc. (www.stonesteps.ca)
+
+    See COPYING and Copyright files for additional licensing and copyright information
+
+    timeseries.h
+*/
+#ifndef TIMESERIES_H
+#define TIMESERIES_H
+
+#include "types.h"
+#include "tstring.h"
+
+#include <cstdio>
+#include <vector>
+
+///
+/// @brief  An append-only time series file containing hourly totals across many months.
+///
+/// A time series file consists of a header, followed by fixed-width hourly records
+/// ordered by time, so any time range spanning multiple months may be located with
+/// a binary search and read with a single sequential read, without having to open
+/// monthly state databases. Records are stored in the native byte order and a file
+/// created on a platform with a different byte order is rejected.
+///
+/// Hourly records are appended only after each hour is completed and are never
+/// changed afterwards. Records that are not later than the last record in the file
+/// are ignored, so processing the same logs again does not duplicate any hours. An
+/// incomplete record left by a failed write is overwritten by the next append.
+///
+class timeseries_t {
+   public:
+      ///
+      /// @brief  Hourly totals
+      ///
+      struct hour_t {
+         uint32_t    time;             ///< Date and hour in the `YYYYMMDDHH` form
+         uint32_t    reserved;         ///< Reserved; always zero
+         uint64_t    hits;             ///< Hourly requests
+         uint64_t    files;            ///< Hourly files
+         uint64_t    pages;            ///< Hourly pages
+         uint64_t    visits;           ///< Visits started within the hour
+         uint64_t    hosts;            ///< Hosts first seen in the month within the hour
+         uint64_t    xfer;             ///< Hourly transfer amount, in bytes
+
+         public:
+            hour_t(void) : time(0), reserved(0), hits(0), files(0), pages(0), visits(0), hosts(0), xfer(0) {}
+
+            hour_t(u_int year, u_int month, u_int day, u_int hour, uint64_t hits, uint64_t files, uint64_t pages, uint64_t visits, uint64_t hosts, uint64_t xfer) :
+                  time(make_time(year, month, day, hour)), reserved(0), hits(hits), files(files), pages(pages), visits(visits), hosts(hosts), xfer(xfer) {}
+      };
+
+   private:
+      /// Time series file signature (`WTSH`).
+      static const uint32_t SIGNATURE = 0x48535457u;
+
+      /// Time series format version.
+      static const uint32_t FORMAT_VERSION = 1;
+
+      /// The value used to detect a file created on a platform with a different byte order.
+      static const uint32_t BYTE_ORDER_VALUE = 0x12345678u;
+
+      ///
+      /// @brief  Time series file header
+      ///
+      struct header_t {
+         uint32_t    signature;        ///< Time series file signature.
+         uint32_t    version;          ///< Time series format version.
+         uint32_t    byte_order;       ///< Byte order value.
+         uint32_t    record_size;      ///< Size of an hourly record, in bytes.
+      };
+
+   private:
+      string_t       path;             ///< Time series file path.
+
+   private:
+      bool read_header(FILE *file, size_t& count) const;
+
+      bool read_time(FILE *file, size_t index, uint32_t& time) const;
+
+      bool find_time(FILE *file, size_t count, uint32_t time, size_t& index) const;
+
+   public:
+      timeseries_t(const string_t& path);
+
+      /// Returns a time value in the `YYYYMMDDHH` form.
+      static uint32_t make_time(u_int year, u_int month, u_int day, u_int hour) {return ((year * 100 + month) * 100 + day) * 100 + hour;}
+
+      /// Appends hourly records ordered by time that are later than the last record in the file.
+      bool append_hours(const std::vector<hour_t>& hours) const;
+
+      /// Reads hourly records with times between `first` and `last`, inclusive.
+      bool read_hours(uint32_t first, uint32_t last, std::vector<hour_t>& hours) const;
+};
+
+#endif // TIMESERIES_H
@@ -129,6 +129,14 @@ struct tstamp_t {
 
       int64_t compare(const tstamp_t& tstamp, int mode = tm_parts::TIMESTAMP) const;
 
+      // returns true if all components and attributes are the same, without any time zone conversion
+      bool is_same(const tstamp_t& tstamp) const
+      {
+         return year == tstamp.year && month == tstamp.month && day == tstamp.day && 
+                  hour == tstamp.hour && min == tstamp.min && sec == tstamp.sec && 
+                  offset == tstamp.offset && utc == tstamp.utc && null == tstamp.null;
+      }
+
       bool operator == (const tstamp_t& tstamp) const {return compare(tstamp) == 0;}
       bool operator != (const tstamp_t& tstamp) const {return compare(tstamp) != 0;}
       bool operator > (const tstamp_t& tstamp) const {return compare(tstamp) > 0;}
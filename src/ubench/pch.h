@@ -0,0 +1,15 @@
+/*
+   webalizer - a web server log analysis program
+
+   Copyright (c) 2004-2022, Stone Steps Inc. (www.stonesteps.ca)
+
+   See COPYING and Copyright files for additional licensing and copyright information 
+   
+   pch.h
+*/
+#ifndef PCHUBENCH_H
+#define PCHUBENCH_H
+
+#include <benchmark/benchmark.h>
+
+#endif // PCHUBENCH_H
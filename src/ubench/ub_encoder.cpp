@@ -0,0 +1,39 @@
+/*
+   webalizer - a web server log analysis program
+
+   Copyright (c) 2004-2022, Stone Steps Inc. (www.stonesteps.ca)
+
+   See COPYING and Copyright files for additional licensing and copyright information
+
+   ub_encoder.cpp
+*/
+#include "pch.h"
+
+#include "../tstring.h"
+#include "../encoder.h"
+
+namespace sswbench {
+
+/// A user agent with characters that need to be encoded in all output formats.
+static const char *agent = "Mozilla/5.0 (compatible; \"Bot\" <bot@example.com> & caf\xC3\xA9/1.0; +http://www.example.com/bot.html)";
+
+///
+/// @brief  Encodes a string with the encoder function `encode_char`.
+///
+template <encode_char_t encode_char>
+static void EncodeString(benchmark::State& state)
+{
+   string_t::char_buffer_t buffer(1024);
+
+   for(auto _ : state)
+      benchmark::DoNotOptimize(encode_string<encode_char>(buffer, agent));
+
+   state.SetBytesProcessed(state.iterations() * strlen(agent));
+}
+
+BENCHMARK_TEMPLATE(EncodeString, encode_char_html);
+BENCHMARK_TEMPLATE(EncodeString, encode_char_xml);
+BENCHMARK_TEMPLATE(EncodeString, encode_char_js);
+BENCHMARK_TEMPLATE(EncodeString, encode_char_json);
+
+}
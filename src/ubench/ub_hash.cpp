@@ -0,0 +1,56 @@
+/*
+   webalizer - a web server log analysis program
+
+   Copyright (c) 2004-2022, Stone Steps Inc. (www.stonesteps.ca)
+
+   See COPYING and Copyright files for additional licensing and copyright information
+
+   ub_hash.cpp
+*/
+#include "pch.h"
+
+#include "../hashtab.h"
+#include "../tstring.h"
+
+#include <string>
+
+namespace sswbench {
+
+///
+/// @brief  Hashes strings of various lengths, from short user names to long
+///         URLs with query strings.
+///
+static void HashStr(benchmark::State& state)
+{
+   std::string str(state.range(0), 'a');
+   uint64_t hashval = 0;
+
+   for(size_t i = 0; i < str.length(); i++)
+      str[i] = (char) ('a' + i % 26);
+
+   for(auto _ : state) {
+      hashval = hash_str(hashval, str.c_str(), str.length());
+      benchmark::DoNotOptimize(hashval);
+   }
+
+   state.SetBytesProcessed(state.iterations() * str.length());
+}
+
+BENCHMARK(HashStr)->RangeMultiplier(4)->Range(8, 512);
+
+///
+/// @brief  Hashes a compound URL key, which is how URL nodes with query strings
+///         are hashed.
+///
+static void HashExUrl(benchmark::State& state)
+{
+   string_t url("/section-12/article-1234/index.html");
+   string_t srchargs("q=webalizer+log+analysis&page=2");
+
+   for(auto _ : state)
+      benchmark::DoNotOptimize(hash_ex(hash_byte(hash_ex(0, url), '?'), srchargs));
+}
+
+BENCHMARK(HashExUrl);
+
+}
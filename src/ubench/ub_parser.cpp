@@ -0,0 +1,86 @@
+/*
+   webalizer - a web server log analysis program
+
+   Copyright (c) 2004-2022, Stone Steps Inc. (www.stonesteps.ca)
+
+   See COPYING and Copyright files for additional licensing and copyright information
+
+   ub_parser.cpp
+*/
+#include "pch.h"
+
+#include "../parser.h"
+#include "../config.h"
+#include "../logrec.h"
+
+#include <vector>
+
+namespace sswbench {
+
+///
+/// @brief  Parses a log line in the specified format.
+///
+/// `parse_record` modifies the buffer, so the log line is copied into the buffer
+/// for each iteration. The copy is included in the measured time, but is cheap
+/// compared to parsing. Log lines are terminated with a new line character, the
+/// same way they are returned from log files.
+///
+static void ParseRecord(benchmark::State& state, log_type_t log_type, const char *log_format, const char *fields, const char *logline)
+{
+   config_t config;
+   string_t line(string_t(logline) + "\n");
+   std::vector<char> buffer(line.length() + 1);
+   log_struct logrec;
+
+   config.log_type = log_type;
+
+   if(log_type == LOG_APACHE)
+      config.apache_log_format = log_format;
+   else if(log_type == LOG_NGINX)
+      config.nginx_log_format = log_format;
+
+   parser_t parser(config);
+
+   if(!parser.init_parser(log_type)) {
+      state.SkipWithError("Cannot initialize the log parser");
+      return;
+   }
+
+   // W3C logs describe their fields in a directive
+   if(fields) {
+      string_t directive(string_t(fields) + "\n");
+      std::vector<char> dirbuf(directive.c_str(), directive.c_str() + directive.length() + 1);
+
+      parser.parse_record(dirbuf.data(), directive.length(), logrec);
+   }
+
+   for(auto _ : state) {
+      memcpy(buffer.data(), line.c_str(), buffer.size());
+      logrec.reset();
+
+      if(parser.parse_record(buffer.data(), buffer.size() - 1, logrec) != PARSE_CODE_OK) {
+         state.SkipWithError("Cannot parse the log line");
+         break;
+      }
+   }
+
+   state.SetBytesProcessed(state.iterations() * (buffer.size() - 1));
+}
+
+BENCHMARK_CAPTURE(ParseRecord, CLF, LOG_CLF, nullptr, nullptr,
+      "192.168.1.10 - - [30/Aug/2022:15:10:25 +0000] \"GET /section-12/article-1234/index.html?page=2 HTTP/1.1\" 200 12345 \"https://www.google.com/search?q=log+analysis\" \"Mozilla/5.0 (Windows NT 10.0; Win64; x64) AppleWebKit/537.36 (KHTML, like Gecko) Chrome/104.0.5112.102 Safari/537.36\"");
+
+BENCHMARK_CAPTURE(ParseRecord, Apache, LOG_APACHE, "%h %l %u %t \"%r\" %>s %b \"%{Referer}i\" \"%{User-Agent}i\"", nullptr,
+      "192.168.1.10 - - [30/Aug/2022:15:10:25 +0000] \"GET /section-12/article-1234/index.html?page=2 HTTP/1.1\" 200 12345 \"https://www.google.com/search?q=log+analysis\" \"Mozilla/5.0 (Windows NT 10.0; Win64; x64) AppleWebKit/537.36 (KHTML, like Gecko) Chrome/104.0.5112.102 Safari/537.36\"");
+
+BENCHMARK_CAPTURE(ParseRecord, Nginx, LOG_NGINX, "$remote_addr - $remote_user [$time_local] \"$request\" $status $bytes_sent \"$http_referer\" \"$http_user_agent\"", nullptr,
+      "192.168.1.10 - - [30/Aug/2022:15:10:25 +0000] \"GET /section-12/article-1234/index.html?page=2 HTTP/1.1\" 200 12345 \"https://www.google.com/search?q=log+analysis\" \"Mozilla/5.0 (Windows NT 10.0; Win64; x64) AppleWebKit/537.36 (KHTML, like Gecko) Chrome/104.0.5112.102 Safari/537.36\"");
+
+BENCHMARK_CAPTURE(ParseRecord, W3C, LOG_W3C, nullptr,
+      "#Fields: date time c-ip cs-username cs-method cs-uri-stem cs-uri-query sc-status sc-bytes time-taken cs(User-Agent) cs(Referer)",
+      "2022-08-30 15:10:25 192.168.1.10 - GET /section-12/article-1234/index.html page=2 200 12345 0.125 Mozilla/5.0+(Windows+NT+10.0;+Win64;+x64)+AppleWebKit/537.36+(KHTML,+like+Gecko)+Chrome/104.0.5112.102+Safari/537.36 https://www.google.com/search?q=log+analysis");
+
+BENCHMARK_CAPTURE(ParseRecord, Squid, LOG_SQUID, nullptr, nullptr,
+      "1661872225.125    125 192.168.1.10 TCP_MISS/200 12345 GET http://www.example.com/section-12/article-1234/index.html?page=2 - DIRECT/192.0.2.1 text/html");
+
+}
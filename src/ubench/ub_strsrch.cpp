@@ -0,0 +1,80 @@
+/*
+   webalizer - a web server log analysis program
+
+   Copyright (c) 2004-2022, Stone Steps Inc. (www.stonesteps.ca)
+
+   See COPYING and Copyright files for additional licensing and copyright information
+
+   ub_strsrch.cpp
+*/
+#include "pch.h"
+
+#include "../util_string.h"
+#include "../linklist.h"
+#include "../tstring.h"
+
+namespace sswbench {
+
+/// A typical user agent, which is the longest string searched against pattern lists.
+static const char *user_agent = "Mozilla/5.0 (Windows NT 10.0; Win64; x64) AppleWebKit/537.36 (KHTML, like Gecko) Chrome/104.0.5112.102 Safari/537.36 Edg/104.0.1293.70";
+
+///
+/// @brief  Searches for a substring with and without a Boyer-Moore-Horspool
+///         delta table and with case-insensitive comparisons.
+///
+static void StrStrEx(benchmark::State& state)
+{
+   const char *pattern = "Safari/537";
+   bmh_delta_table delta_table{string_t(pattern)};
+   bool use_delta = state.range(0) != 0;
+   bool nocase = state.range(1) != 0;
+
+   for(auto _ : state)
+      benchmark::DoNotOptimize(strstr_ex(user_agent, pattern, use_delta ? &delta_table : nullptr, nocase));
+}
+
+BENCHMARK(StrStrEx)->ArgNames({"delta", "nocase"})->ArgsProduct({{0, 1}, {0, 1}});
+
+///
+/// @brief  Matches a user agent against prefix, suffix and substring patterns.
+///
+static void IsInStrEx(benchmark::State& state)
+{
+   static const char *patterns[] = {"Mozilla/5.0*", "*Edg/104.0.1293.70", "Chrome"};
+
+   const char *pattern = patterns[state.range(0)];
+   bmh_delta_table delta_table{string_t(pattern)};
+   size_t slen = strlen(user_agent), plen = strlen(pattern);
+
+   for(auto _ : state)
+      benchmark::DoNotOptimize(isinstrex(user_agent, pattern, slen, plen, true, &delta_table));
+}
+
+BENCHMARK(IsInStrEx)->ArgName("pattern")->DenseRange(0, 2);
+
+///
+/// @brief  Looks up a user agent that doesn't match any of the patterns in a
+///         list, which is the most common outcome for ignore and hide lists.
+///
+static void NListIsInList(benchmark::State& state)
+{
+   nlist patterns;
+   string_t agent(user_agent);
+
+   for(int64_t i = 0; i < state.range(0); i++) {
+      switch(i % 3) {
+         case 0: patterns.add_nlist(string_t::_format("Robot-%" PRId64 "*", i)); break;
+         case 1: patterns.add_nlist(string_t::_format("*Crawler/%" PRId64, i)); break;
+         case 2: patterns.add_nlist(string_t::_format("spider-%" PRId64, i)); break;
+      }
+   }
+
+   for(auto _ : state)
+      benchmark::DoNotOptimize(patterns.isinlist(agent));
+
+   state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+BENCHMARK(NListIsInList)->RangeMultiplier(4)->Range(16, 1024);
+
+}
@@ -0,0 +1,43 @@
+/*
+   webalizer - a web server log analysis program
+
+   Copyright (c) 2004-2022, Stone Steps Inc. (www.stonesteps.ca)
+
+   See COPYING and Copyright files for additional licensing and copyright information
+
+   ub_tstamp.cpp
+*/
+#include "pch.h"
+
+#include "../tstamp.h"
+
+namespace sswbench {
+
+///
+/// @brief  Parses a W3C time stamp.
+///
+static void TStampParse(benchmark::State& state)
+{
+   tstamp_t tstamp;
+
+   for(auto _ : state)
+      benchmark::DoNotOptimize(tstamp.parse("2022-08-30 15:10:25"));
+}
+
+BENCHMARK(TStampParse);
+
+///
+/// @brief  Converts a time stamp to seconds since the epoch, which is done for
+///         every log record.
+///
+static void TStampMkTime(benchmark::State& state)
+{
+   tstamp_t tstamp(2022, 8, 30, 15, 10, 25);
+
+   for(auto _ : state)
+      benchmark::DoNotOptimize(tstamp.mktime());
+}
+
+BENCHMARK(TStampMkTime);
+
+}
@@ -0,0 +1,74 @@
+/*
+   webalizer - a web server log analysis program
+
+   Copyright (c) 2004-2022, Stone Steps Inc. (www.stonesteps.ca)
+
+   See COPYING and Copyright files for additional licensing and copyright information
+
+   ub_url.cpp
+*/
+#include "pch.h"
+
+#include "../util_url.h"
+#include "../util_ipaddr.h"
+#include "../tstring.h"
+
+namespace sswbench {
+
+///
+/// @brief  Normalizes a plain ASCII URL, which is the most common case, and a URL
+///         with URL-encoded UTF-8 and reserved characters.
+///
+static void NormUrlStr(benchmark::State& state)
+{
+   static const char *urls[] = {
+      "/section-12/article-1234/index.html",
+      "/search/%D0%BF%D0%BE%D0%B8%D1%81%D0%BA/%7Euser%2Fpath%3Fq%3D1/caf%C3%A9.html"
+   };
+
+   const char *url = urls[state.range(0)];
+   string_t::char_buffer_t strbuf;
+   string_t str;
+
+   for(auto _ : state) {
+      // the URL is normalized in place, so restore it for each iteration
+      str = url;
+      norm_url_str(str, strbuf);
+      benchmark::DoNotOptimize(str.c_str());
+   }
+}
+
+BENCHMARK(NormUrlStr)->ArgName("encoded")->DenseRange(0, 1);
+
+///
+/// @brief  URL-encodes a search string with spaces and non-ASCII characters.
+///
+static void UrlEncode(benchmark::State& state)
+{
+   string_t str("web log analysis caf\xC3\xA9 <report> & \"statistics\"");
+   string_t out;
+
+   for(auto _ : state) {
+      url_encode(str, out);
+      benchmark::DoNotOptimize(out.c_str());
+   }
+}
+
+BENCHMARK(UrlEncode);
+
+///
+/// @brief  Checks IPv4 and IPv6 addresses and a host name, which must be rejected.
+///
+static void IsIpAddress(benchmark::State& state)
+{
+   static const char *hosts[] = {"192.168.123.234", "2001:db8:85a3::8a2e:370:7334", "crawl-66-249-66-1.googlebot.com"};
+
+   const char *host = hosts[state.range(0)];
+
+   for(auto _ : state)
+      benchmark::DoNotOptimize(is_ip_address(host));
+}
+
+BENCHMARK(IsIpAddress)->ArgName("host")->DenseRange(0, 2);
+
+}
@@ -156,14 +156,19 @@ bool unode_t::match_key(const string_t& url, const string_t& srchargs) const
 //
 // serialization
 //
+///
+/// Starting with version 4, fields used as secondary database keys are stored as
+/// fixed-width values right after the URL type, followed by variable-length fields.
+/// The unused hex-encoding flag is no longer stored.
+///
 size_t unode_t::s_data_size(void) const
 {
    return base_node<unode_t>::s_data_size() + 
-            sizeof(u_char) * 3 +       // hexenc, target, urltype 
-            sizeof(u_short) +          // pathlen
-            sizeof(uint64_t) * 5 +     // count, files, entry, exit, value hash
-            sizeof(double) * 2 +       // avgtime, maxtime
-            sizeof(uint64_t);          // xfer
+            sizeof(u_char) * 2 +       // urltype, target
+            serializer_t::s_size_of_varint(pathlen) + 
+            sizeof(uint64_t) * 5 +     // count, entry, exit, xfer, value hash
+            serializer_t::s_size_of_varint(files) + 
+            sizeof(double) * 2;        // avgtime, maxtime
 }
 
 size_t unode_t::s_pack_data(void *buffer, size_t bufsize) const
@@ -173,17 +178,18 @@ size_t unode_t::s_pack_data(void *buffer, size_t bufsize) const
    size_t basesize = base_node<unode_t>::s_pack_data(buffer, bufsize);
    void *ptr = (u_char*) buffer + basesize;
 
-   ptr = sr.serialize(ptr, false);
    ptr = sr.serialize(ptr, urltype);
-   ptr = sr.serialize(ptr, pathlen);
+
+   // fixed-width fields referenced by secondary databases
    ptr = sr.serialize(ptr, count);
-   ptr = sr.serialize(ptr, files);
    ptr = sr.serialize(ptr, entry);
    ptr = sr.serialize(ptr, exit);
    ptr = sr.serialize(ptr, xfer);
-   ptr = sr.serialize(ptr, avgtime);
-
    ptr = sr.serialize(ptr, s_hash_value());
+
+   ptr = sr.serialize_varint(ptr, pathlen);
+   ptr = sr.serialize_varint(ptr, files);
+   ptr = sr.serialize(ptr, avgtime);
    ptr = sr.serialize(ptr, maxtime);
    ptr = sr.serialize(ptr, target);
 
@@ -202,28 +208,46 @@ size_t unode_t::s_unpack_data(const void *buffer, size_t bufsize, s_unpack_cb_t<
 
    u_short version = s_node_ver(buffer);
 
-   ptr = sr.s_skip_field<bool>(ptr);         // hexenc
+   if(version >= 4) {
+      ptr = sr.deserialize(ptr, urltype);
 
-   ptr = sr.deserialize(ptr, urltype);
-   ptr = sr.deserialize(ptr, pathlen);
-   ptr = sr.deserialize(ptr, count);
-   ptr = sr.deserialize(ptr, files);
-   ptr = sr.deserialize(ptr, entry);
-   ptr = sr.deserialize(ptr, exit);
-   ptr = sr.deserialize(ptr, xfer);
-   ptr = sr.deserialize(ptr, avgtime);
+      ptr = sr.deserialize(ptr, count);
+      ptr = sr.deserialize(ptr, entry);
+      ptr = sr.deserialize(ptr, exit);
+      ptr = sr.deserialize(ptr, xfer);
 
-   ptr = sr.s_skip_field<uint64_t>(ptr);      // value hash
+      ptr = sr.s_skip_field<uint64_t>(ptr);      // value hash
 
-   if(version >= 2)
+      ptr = sr.deserialize_varint(ptr, pathlen);
+      ptr = sr.deserialize_varint(ptr, files);
+      ptr = sr.deserialize(ptr, avgtime);
       ptr = sr.deserialize(ptr, maxtime);
-   else
-      maxtime = 0;
-
-   if(version >= 3)
       ptr = sr.deserialize(ptr, tmp), target = tmp;
-   else
-      target = false;
+   }
+   else {
+      ptr = sr.s_skip_field<bool>(ptr);         // hexenc
+
+      ptr = sr.deserialize(ptr, urltype);
+      ptr = sr.deserialize(ptr, pathlen);
+      ptr = sr.deserialize(ptr, count);
+      ptr = sr.deserialize(ptr, files);
+      ptr = sr.deserialize(ptr, entry);
+      ptr = sr.deserialize(ptr, exit);
+      ptr = sr.deserialize(ptr, xfer);
+      ptr = sr.deserialize(ptr, avgtime);
+
+      ptr = sr.s_skip_field<uint64_t>(ptr);      // value hash
+
+      if(version >= 2)
+         ptr = sr.deserialize(ptr, maxtime);
+      else
+         maxtime = 0;
+
+      if(version >= 3)
+         ptr = sr.deserialize(ptr, tmp), target = tmp;
+      else
+         target = false;
+   }
 
    if(upcb)
       upcb(*this, std::forward<param_t>(param) ...);
@@ -234,6 +258,13 @@ size_t unode_t::s_unpack_data(const void *buffer, size_t bufsize, s_unpack_cb_t<
 const void *unode_t::s_field_value_hash(const void *buffer, size_t bufsize, size_t& datasize)
 {
    datasize = sizeof(uint64_t);
+
+   if(s_node_ver(buffer) >= 4) {
+      return (u_char*) buffer + base_node<unode_t>::s_data_size(buffer, bufsize) + 
+               sizeof(u_char) +           // urltype
+               sizeof(uint64_t) * 4;      // count, entry, exit, xfer
+   }
+
    return (u_char*) buffer + base_node<unode_t>::s_data_size(buffer, bufsize) + 
             sizeof(u_char) * 2 + 
             sizeof(u_short) + 
@@ -245,6 +276,13 @@ const void *unode_t::s_field_value_hash(const void *buffer, size_t bufsize, size
 const void *unode_t::s_field_xfer(const void *buffer, size_t bufsize, size_t& datasize)
 {
    datasize = sizeof(uint64_t);
+
+   if(s_node_ver(buffer) >= 4) {
+      return (u_char*) buffer + base_node<unode_t>::s_data_size(buffer, bufsize) + 
+               sizeof(u_char) +           // urltype
+               sizeof(uint64_t) * 3;      // count, entry, exit
+   }
+
    return (u_char*) buffer + base_node<unode_t>::s_data_size(buffer, bufsize) + 
             sizeof(u_char) * 2 + 
             sizeof(u_short) + 
@@ -254,21 +292,52 @@ const void *unode_t::s_field_xfer(const void *buffer, size_t bufsize, size_t& da
 const void *unode_t::s_field_hits(const void *buffer, size_t bufsize, size_t& datasize)
 {
    datasize = sizeof(uint64_t);
+
+   if(s_node_ver(buffer) >= 4)
+      return (u_char*) buffer + base_node<unode_t>::s_data_size(buffer, bufsize) + sizeof(u_char);
+
    return (u_char*) buffer + base_node<unode_t>::s_data_size(buffer, bufsize) + sizeof(u_char) * 2 + sizeof(u_short);
 }
 
 const void *unode_t::s_field_entry(const void *buffer, size_t bufsize, size_t& datasize)
 {
    datasize = sizeof(uint64_t);
+
+   if(s_node_ver(buffer) >= 4)
+      return (u_char*)buffer + base_node<unode_t>::s_data_size(buffer, bufsize) + sizeof(u_char) + sizeof(uint64_t);
+
    return (u_char*)buffer + base_node<unode_t>::s_data_size(buffer, bufsize) + sizeof(u_char) * 2 + sizeof(u_short) + sizeof(uint64_t) * 2;
 }
 
 const void *unode_t::s_field_exit(const void *buffer, size_t bufsize, size_t& datasize)
 {
    datasize = sizeof(uint64_t);
+
+   if(s_node_ver(buffer) >= 4)
+      return (u_char*)buffer + base_node<unode_t>::s_data_size(buffer, bufsize) + sizeof(u_char) + sizeof(uint64_t) * 2;
+
    return (u_char*)buffer + base_node<unode_t>::s_data_size(buffer, bufsize) + sizeof(u_char) * 2 + sizeof(u_short) + sizeof(uint64_t) * 3;
 }
 
+///
+/// The path length is stored as a variable-length integer after the value hash
+/// starting with version 4, and as a fixed-width value after the URL type in
+/// earlier versions.
+///
+u_short unode_t::s_path_length(const void *buffer, size_t bufsize)
+{
+   serializer_t sr(buffer, bufsize);
+   size_t datasize;
+   u_short pathlen;
+
+   if(s_node_ver(buffer) >= 4)
+      sr.deserialize_varint((u_char*) s_field_value_hash(buffer, bufsize, datasize) + datasize, pathlen);
+   else
+      sr.deserialize((u_char*) buffer + base_node<unode_t>::s_data_size(buffer, bufsize) + sizeof(u_char) * 2, pathlen);
+
+   return pathlen;
+}
+
 int64_t unode_t::s_compare_xfer(const void *buf1, size_t buf1size, const void *buf2, size_t buf2size)
 {
    return s_compare<uint64_t>(buf1, buf1size, buf2, buf2size);
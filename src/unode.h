@@ -93,6 +93,8 @@ struct unode_t : public base_node<unode_t> {
          static const void *s_field_entry(const void *buffer, size_t bufsize, size_t& datasize);
          static const void *s_field_exit(const void *buffer, size_t bufsize, size_t& datasize);
 
+         static u_short s_path_length(const void *buffer, size_t bufsize);
+
          static int64_t s_compare_xfer(const void *buf1, size_t buf1size, const void *buf2, size_t buf2size);
          static int64_t s_compare_hits(const void *buf1, size_t buf1size, const void *buf2, size_t buf2size);
          static int64_t s_compare_entry(const void *buf1, size_t buf1size, const void *buf2, size_t buf2size);
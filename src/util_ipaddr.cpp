@@ -12,6 +12,9 @@
 
 #include "util_ipaddr.h"
 
+static bool parse_ipv4_address(const char *cp, u_char *addr);
+static bool parse_ipv6_address(const char *cp, u_char *addr);
+
 bool is_ipv4_address(const char *cp)
 {
    size_t dcnt, gcnt;    // digit and group counts
@@ -141,3 +144,155 @@ bool is_ip_address(const char *cp)
    return is_ipv4_address(cp) || is_ipv6_address(cp);
 }
 
+///
+/// Parses a dotted-decimal IPv4 address into 4 bytes pointed to by `addr`. Same
+/// as `inet_pton`, this function rejects groups with leading zeros and values
+/// that do not fit into a byte.
+///
+bool parse_ipv4_address(const char *cp, u_char *addr)
+{
+   u_int value = 0;
+   size_t dcnt = 0, gcnt = 0;    // digit and group counts
+
+   do {
+      if(string_t::isdigit(*cp)) {
+         // no leading zeros and no values over 255
+         if(dcnt && !value || (value = value * 10 + (*cp - '0')) > 255)
+            return false;
+
+         dcnt++;
+      }
+      else if(*cp == '.' || !*cp) {
+         // each group must have at least one digit and there can be only four groups
+         if(!dcnt || gcnt == 4)
+            return false;
+
+         addr[gcnt++] = (u_char) value;
+
+         value = 0;
+         dcnt = 0;
+      }
+      else
+         return false;
+   } while(*cp++);
+
+   return gcnt == 4;
+}
+
+///
+/// Parses an IPv6 address into 16 bytes pointed to by `addr`. 16-bit groups are
+/// stored in the output buffer as they are parsed and groups following compressed
+/// zeros are moved to the end of the buffer after the entire address is parsed. A
+/// trailing IPv4 address is accepted in place of the last two 16-bit groups. 
+///
+bool parse_ipv6_address(const char *cp, u_char *addr)
+{
+   u_char *ap = addr, *endp = addr + 16;
+   u_char *zerop = nullptr;         // compressed zeros position
+   const char *group = cp;          // start of the current group
+   u_int value = 0;
+   size_t xcnt = 0;                 // hex digit count
+
+   // a leading colon must be a part of compressed zeros, which are recorded at the second colon
+   if(*cp == ':' && *++cp != ':')
+      return false;
+
+   for(; *cp; cp++) {
+      if(string_t::isxdigit(*cp)) {
+         // cannot have more than four hex digits in a group
+         if(++xcnt > 4)
+            return false;
+
+         value = (value << 4) | (string_t::isdigit(*cp) ? *cp - '0' : (*cp | 0x20) - 'a' + 10);
+      }
+      else if(*cp == ':') {
+         group = cp + 1;
+
+         if(!xcnt) {
+            // compressed zeros can only occur once
+            if(zerop)
+               return false;
+
+            zerop = ap;
+            continue;
+         }
+
+         // cannot end with a single colon or have more than eight groups
+         if(!*group || ap + 2 > endp)
+            return false;
+
+         *ap++ = (u_char) (value >> 8);
+         *ap++ = (u_char) value;
+
+         value = 0;
+         xcnt = 0;
+      }
+      else if(*cp == '.') {
+         // the last group was the first byte of an IPv4 address
+         if(ap + 4 > endp || !parse_ipv4_address(group, ap))
+            return false;
+
+         ap += 4;
+         xcnt = 0;
+         break;
+      }
+      else
+         return false;
+   }
+
+   if(xcnt) {
+      if(ap + 2 > endp)
+         return false;
+
+      *ap++ = (u_char) (value >> 8);
+      *ap++ = (u_char) value;
+   }
+
+   if(zerop) {
+      // compressed zeros must represent at least one group
+      if(ap == endp)
+         return false;
+
+      memmove(endp - (ap - zerop), zerop, ap - zerop);
+      memset(zerop, 0, endp - ap);
+
+      ap = endp;
+   }
+
+   return ap == endp;
+}
+
+///
+/// Parses an IPv4 or an IPv6 address into its binary form in a single pass over
+/// the address string. Returns `false` and sets the address family to `NONE` if
+/// `str` is not a valid IP address. IP addresses accepted by this function are
+/// the same as those accepted by `inet_pton`.
+///
+bool parse_ip_address(const char *str, ipaddr_t& ipaddr)
+{
+   const char *cp;
+
+   ipaddr.family = ipaddr_t::NONE;
+
+   if(!str || !*str)
+      return false;
+
+   // IPv4 addresses contain only decimal digits and dots
+   for(cp = str; string_t::isdigit(*cp) || *cp == '.'; cp++);
+
+   if(!*cp) {
+      if(!parse_ipv4_address(str, ipaddr.addr))
+         return false;
+
+      ipaddr.family = ipaddr_t::IPV4;
+   }
+   else {
+      if(!parse_ipv6_address(str, ipaddr.addr))
+         return false;
+
+      ipaddr.family = ipaddr_t::IPV6;
+   }
+
+   return true;
+}
+
@@ -12,8 +12,29 @@
 #ifndef UTIL_IPADDR_H
 #define UTIL_IPADDR_H
 
+#include "types.h"
+
+///
+/// @brief  A binary IPv4 or IPv6 address in the network byte order
+///
+struct ipaddr_t {
+   enum family_t : u_char {
+      NONE,                   ///< Not an IP address
+      IPV4,                   ///< IPv4 address in the first 4 bytes of `addr`
+      IPV6                    ///< IPv6 address
+   };
+
+   family_t    family = NONE;    ///< IP address family
+   u_char      addr[16] = {};    ///< IP address bytes
+
+   /// Returns the size of the IP address, in bytes.
+   size_t size(void) const {return family == IPV4 ? 4 : family == IPV6 ? 16 : 0;}
+};
+
 bool is_ipv4_address(const char *str);
 bool is_ipv6_address(const char *str);
 bool is_ip_address(const char *str);
 
+bool parse_ip_address(const char *str, ipaddr_t& ipaddr);
+
 #endif // UTIL_IPADDR_H
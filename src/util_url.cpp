@@ -18,8 +18,15 @@
 #include <algorithm>
 #include <stdexcept>
 
+// SSE2 is always available on x64 and is enabled by default on x86 by most compilers
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define URL_SPAN_SSE2
+#include <emmintrin.h>
+#endif
+
 static char *to_hex(unsigned char cp, char *out);
 static char from_hex(char c);
+static size_t url_text_span(const char *str, size_t length);
 
 char *to_hex(unsigned char cp, char *out)
 {
@@ -61,6 +68,42 @@ char from_hex(char c)
    return 0;                      /* return 0 if bad...      */
 }
 
+///
+/// Returns the number of leading characters in `str` that are printable ASCII
+/// characters other than the percent character, which are never changed when
+/// URLs are normalized. Most URLs consist entirely of such characters, so SSE2,
+/// where available, is used to check 16 characters at a time. The remaining
+/// characters, including those in the block with the first special character,
+/// are checked one by one.
+///
+size_t url_text_span(const char *str, size_t length)
+{
+   size_t count = 0;
+
+#ifdef URL_SPAN_SSE2
+   const __m128i space = _mm_set1_epi8('\x20');
+   const __m128i del = _mm_set1_epi8('\x7F');
+   const __m128i pct = _mm_set1_epi8('%');
+
+   for(; count + 16 <= length; count += 16) {
+      __m128i chars = _mm_loadu_si128(reinterpret_cast<const __m128i*>(str + count));
+
+      // signed comparison flags control characters and all non-ASCII characters
+      __m128i special = _mm_or_si128(_mm_cmplt_epi8(chars, space), _mm_or_si128(_mm_cmpeq_epi8(chars, del), _mm_cmpeq_epi8(chars, pct)));
+
+      if(_mm_movemask_epi8(special))
+         break;
+   }
+#endif
+
+   for(; count < length; count++) {
+      if((unsigned char) str[count] < '\x20' || (unsigned char) str[count] >= '\x7F' || str[count] == '%')
+         break;
+   }
+
+   return count;
+}
+
 ///
 /// All non-UTF-8 characters are assumed to be encoded as CP1252 and converted to 
 /// UTF-8. This covers most maformed URLs, but will mangle characters from non-Latin1
@@ -94,8 +137,8 @@ char from_hex(char c)
 ///
 void norm_url_str(string_t& str, string_t::char_buffer_t& strbuf)
 {
-   size_t chsz, of;
-   const char *cp1, *cp2;
+   size_t chsz, of, buflen;
+   const char *cp1, *cp2, *end;
    char *bcp;
    char chr[2] = {0};
 
@@ -117,11 +160,15 @@ void norm_url_str(string_t& str, string_t::char_buffer_t& strbuf)
    if(str.isempty())
       return;
 
+   end = str.c_str() + str.length();
+
    //
    // Look for a URL-encoded sequence, a control character or a non-UTF-8 character. 
-   // All characters up to such character do not need to be examined again.
+   // All characters up to such character do not need to be examined again. Printable
+   // ASCII characters are skipped in blocks and only the remaining characters are
+   // examined one by one.
    //
-   for(cp1 = str.c_str(); *cp1; cp1 += chsz) {
+   for(cp1 = str.c_str() + url_text_span(str.c_str(), str.length()); *cp1; cp1 += chsz) {
       if((unsigned char) *cp1 < '\x20' || (unsigned char) *cp1 == '\x7F')
          break;
 
@@ -130,6 +177,8 @@ void norm_url_str(string_t& str, string_t::char_buffer_t& strbuf)
 
       if((chsz = utf8size(cp1)) == 0)
          break;
+
+      chsz += url_text_span(cp1 + chsz, end - cp1 - chsz);
    }
 
    // nothing to change if we reached the end of the string
@@ -150,6 +199,17 @@ void norm_url_str(string_t& str, string_t::char_buffer_t& strbuf)
 
    // decode URL-encoded sequences and fix misplaced % characters
    while(*cp2) {
+      // copy printable ASCII characters between URL-encoded sequences in blocks
+      if((chsz = url_text_span(cp2, end - cp2)) != 0) {
+         while(strbuf.capacity() - (bcp - strbuf) < chsz + 1)
+            bcp = realloc_buffer(strbuf, bcp);
+
+         memcpy(bcp, cp2, chsz);
+         bcp += chsz;
+         cp2 += chsz;
+         continue;
+      }
+
       // check if we have room for at least one URL-encoded sequence and the null character
       if(strbuf.capacity() - (bcp - strbuf) < 4)
          bcp = realloc_buffer(strbuf, bcp);
@@ -179,7 +239,8 @@ void norm_url_str(string_t& str, string_t::char_buffer_t& strbuf)
    }
 
    // add a null character to the buffer string
-   strbuf[bcp - strbuf] = 0;
+   buflen = bcp - strbuf;
+   strbuf[buflen] = 0;
 
    // hold onto the current offset to the first URL-encoded sequence or a non-UTF-8 character
    of = cp1 - str.c_str();
@@ -189,9 +250,21 @@ void norm_url_str(string_t& str, string_t::char_buffer_t& strbuf)
    bcp = buf + of;
 
    cp2 = strbuf;
+   end = strbuf + buflen;
 
    // convert all non-UTF-8 characters as if they are in CP1252
    while(*cp2) {
+      // copy printable ASCII characters in blocks
+      if((chsz = url_text_span(cp2, end - cp2)) != 0) {
+         while(buf.capacity() - (bcp - buf) < chsz + 1)
+            bcp = realloc_buffer(buf, bcp);
+
+         memcpy(bcp, cp2, chsz);
+         bcp += chsz;
+         cp2 += chsz;
+         continue;
+      }
+
       //
       // Check if we have enough room in the buffer for the next sequence, which can 
       // be up to 4 bytes for a UTF-8 character or 2 bytes for a CP1252 character 
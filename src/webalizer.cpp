@@ -51,6 +51,7 @@
 #include <exception>
 #include <algorithm>
 #include <stdexcept>
+#include <future>
 
 ///
 /// @mainpage
@@ -73,16 +74,20 @@
 
 static const char *copyright   = "Copyright (c) 2004-2022, Stone Steps Inc. (www.stonesteps.ca)";
 
-bool webalizer_t::abort_signal = false;   // true if Ctrl-C was pressed
+std::atomic<bool> webalizer_t::abort_signal(false);   // true if Ctrl-C was pressed
 
 ///
 /// @brief  Constructs an instance of a log processor.
 ///
-webalizer_t::webalizer_t(const config_t& config) : config(config), parser(config), state(config, &end_visit_cb, &end_download_cb, this), dns_resolver(config)
+webalizer_t::webalizer_t(const config_t& config) : config(config), parser(config), state(config, &end_visit_cb, &end_download_cb, this), dns_resolver(config), srch_hosts_only(false)
 {
    // preallocate all character buffers we need for log processing
    buffer_allocator.release_buffer(string_t::char_buffer_t(BUFSIZE));
    buffer_allocator.release_buffer(string_t::char_buffer_t(BUFSIZE));
+
+   logrec_buffer_allocator.release_buffer(string_t::char_buffer_t(BUFSIZE));
+
+   profiler.set_enabled(config.profile || !config.profile_fname.isempty());
 }
 
 ///
@@ -113,8 +118,8 @@ void webalizer_t::initialize(void)
       throw exception_t(0, string_t::_format("%s %s", config.lang.msg_dir_err,config.out_dir.c_str()));
    }
 
-   // check if the database directory has write access
-   if(access(config.db_path, R_OK | W_OK)) {
+   // check if the database directory has write access, unless the database is opened read-only
+   if(access(config.db_path, config.db_read_only ? R_OK : R_OK | W_OK)) {
       /* Error: Can't change directory to ... */
       throw exception_t(0, string_t::_format("%s %s", config.lang.msg_dir_err, config.db_path.c_str()));
    }
@@ -134,6 +139,9 @@ void webalizer_t::initialize(void)
       }
 
       init_seq_guard.add_cleanup(parser, &parser_t::cleanup_parser);
+
+      // search engines are looked up by referrer host names only if requested and no pattern needs the full URL
+      srch_hosts_only = config.is_srch_host_match();
    }
 
    //
@@ -200,7 +208,7 @@ void webalizer_t::cleanup(void)
 /// This method reports all errors to the stderr stream and returns `false` if 
 /// any output engine could not be initialized.
 ///
-bool webalizer_t::init_output_engines(void)
+bool webalizer_t::init_output_engines(const state_t& state, std::vector<output_t*>& output) const
 {
    output_t::graphinfo_t *graphinfo = nullptr;
    std::unique_ptr<output_t> optr;
@@ -245,7 +253,7 @@ bool webalizer_t::init_output_engines(void)
 ///
 /// @brief  Cleans up all selected output engines.
 ///
-void webalizer_t::cleanup_output_engines(void)
+void webalizer_t::cleanup_output_engines(std::vector<output_t*>& output)
 {
    output_t *optr;
    std::vector<output_t*>::iterator iter = output.begin();
@@ -258,6 +266,35 @@ void webalizer_t::cleanup_output_engines(void)
    output.clear();
 }
 
+///
+/// @brief  Reports processing stage times and counters, along with hash table
+///         look-up counts, in the formats requested in the configuration.
+///
+void webalizer_t::report_profile(void)
+{
+   profiler.add_htab_stats("hosts", state.hm_htab.get_hits(), state.hm_htab.get_misses(), state.hm_htab.get_swapped());
+   profiler.add_htab_stats("urls", state.um_htab.get_hits(), state.um_htab.get_misses(), state.um_htab.get_swapped());
+   profiler.add_htab_stats("referrers", state.rm_htab.get_hits(), state.rm_htab.get_misses(), state.rm_htab.get_swapped());
+   profiler.add_htab_stats("agents", state.am_htab.get_hits(), state.am_htab.get_misses(), state.am_htab.get_swapped());
+   profiler.add_htab_stats("search", state.sr_htab.get_hits(), state.sr_htab.get_misses(), state.sr_htab.get_swapped());
+   profiler.add_htab_stats("users", state.im_htab.get_hits(), state.im_htab.get_misses(), state.im_htab.get_swapped());
+   profiler.add_htab_stats("errors", state.rc_htab.get_hits(), state.rc_htab.get_misses(), state.rc_htab.get_swapped());
+   profiler.add_htab_stats("downloads", state.dl_htab.get_hits(), state.dl_htab.get_misses(), state.dl_htab.get_swapped());
+   profiler.add_htab_stats("countries", state.cc_htab.get_hits(), state.cc_htab.get_misses(), state.cc_htab.get_swapped());
+   profiler.add_htab_stats("cities", state.ct_htab.get_hits(), state.ct_htab.get_misses(), state.ct_htab.get_swapped());
+   profiler.add_htab_stats("asn", state.as_htab.get_hits(), state.as_htab.get_misses(), state.as_htab.get_swapped());
+
+   if(config.profile)
+      profiler.print_table(stdout);
+
+   if(!config.profile_fname.isempty()) {
+      string_t profile_path = make_path(config.out_dir, config.profile_fname);
+
+      if(!profiler.write_json(profile_path))
+         fprintf(stderr, "%s %s\n", config.lang.msg_prf_err, profile_path.c_str());
+   }
+}
+
 ///
 /// @brief  Updates an index document for each report type with the usage data for 
 ///         the current month in the state database.
@@ -283,10 +320,10 @@ void webalizer_t::write_main_index(void)
 /// @brief  Creates a monthly usage report document for each report type for the 
 ///         current month in the state database.
 ///
-void webalizer_t::write_monthly_report(void)
+void webalizer_t::write_monthly_report(const state_t& state, const std::vector<output_t*>& output) const
 {
    output_t *optr;
-   std::vector<output_t*>::iterator iter = output.begin();
+   std::vector<output_t*>::const_iterator iter = output.begin();
    
    while(iter != output.end()) {
       optr = *iter++;
@@ -298,6 +335,71 @@ void webalizer_t::write_monthly_report(void)
    }
 }
 
+///
+/// @brief  Generates a report for a closed month from the rolled over database 
+///         file `db_name`.
+///
+/// This method runs in a separate thread, while log records of the next month are
+/// processed into the new state database. It uses its own state and output engines 
+/// and reads only the rolled over database, the history file and the time series 
+/// file, which are not updated until `wait_month_report` returns. Configuration is
+/// shared, but is only read. Errors are thrown as exceptions and are reported to 
+/// the main thread by `wait_month_report`.
+///
+void webalizer_t::write_closed_month_report(const string_t& db_name) const
+{
+   state_t month_state(config, db_name);
+   std::vector<output_t*> month_output;
+
+   {init_seq_guard_t init_seq_guard;
+
+   if(!month_state.initialize())
+      throw exception_t(0, string_t::_format("Cannot initialize the state engine (%s)", db_name.c_str()));
+
+   init_seq_guard.add_cleanup(month_state, &state_t::cleanup);
+
+   month_state.restore_state();
+
+   if(!init_output_engines(month_state, month_output)) {
+      cleanup_output_engines(month_output);
+      throw exception_t(0, "Cannot initialize output engine");
+   }
+
+   init_seq_guard.disengage();}
+
+   try {
+      write_monthly_report(month_state, month_output);
+   }
+   catch (...) {
+      cleanup_output_engines(month_output);
+      month_state.cleanup();
+      throw;
+   }
+
+   cleanup_output_engines(month_output);
+   month_state.cleanup();
+}
+
+///
+/// @brief  Waits for the report for a closed month, if one is being generated, and
+///         rethrows any exception thrown while generating it.
+///
+/// Time spent waiting is added to the report time, so it reflects how long log 
+/// processing was stopped for reports.
+///
+void webalizer_t::wait_month_report(proc_times_t& ptms)
+{
+   if(!month_report.valid())
+      return;
+
+   profiler_t::timer_t timer(profiler, profiler_t::STAGE_REPORT);
+   uint64_t stime = msecs();
+
+   month_report.get();
+
+   ptms.rpt_time += elapsed(stime, msecs());
+}
+
 ///
 /// @brief  Prints application command line options in the selected language.
 ///
@@ -999,7 +1101,7 @@ int webalizer_t::compact_database(void)
          printf("%s: %d KB\n", config.lang.msg_cmpctdb, bytes/1024);
    }
    else
-      fprintf(stderr, "Cannot compact the database (%s)\n", status.err_msg().c_str());
+      fprintf(stderr, "%s (%s)\n", config.lang.msg_cmpt_err, status.err_msg().c_str());
    
    return 0;
 }
@@ -1020,6 +1122,7 @@ int webalizer_t::run(void)
    start_ts = msecs();
 
    if(config.prep_report) {
+      profiler_t::timer_t timer(profiler, profiler_t::STAGE_REPORT);
       retcode = prep_report();
       ptms.rpt_time += elapsed(start_ts, msecs());
    }
@@ -1091,6 +1194,9 @@ int webalizer_t::run(void)
       printf("%s %.2f %s\n", config.lang.msg_runtime, tot_time/1000., config.lang.msg_seconds);
    }
 
+   if(profiler.is_enabled())
+      report_profile();
+
    return retcode;
 }
 
@@ -1147,7 +1253,7 @@ void webalizer_t::prep_logfiles(logfile_list_t& logfiles)
 ///
 void webalizer_t::prep_lfstates(logfile_list_t& logfiles, lfp_state_list_t& lfp_states, logrec_list_t& logrecs, logrec_counts_t& lrcnt)
 {
-   string_t::char_buffer_t&& buffer = buffer_holder_t(buffer_allocator, BUFSIZE).buffer;
+   string_t::char_buffer_t&& buffer = buffer_holder_t(logrec_buffer_allocator, BUFSIZE).buffer;
    int parse_code;
    int errnum = 0;
    size_t reclen;
@@ -1257,7 +1363,7 @@ void webalizer_t::prep_lfstates(logfile_list_t& logfiles, lfp_state_list_t& lfp_
 ///
 bool webalizer_t::get_logrec(lfp_state_t& wlfs, logfile_list_t& logfiles, lfp_state_list_t& lfp_states, logrec_list_t& logrecs, logrec_counts_t& lrcnt)
 {
-   string_t::char_buffer_t&& buffer = buffer_holder_t(buffer_allocator, BUFSIZE).buffer;
+   string_t::char_buffer_t&& buffer = buffer_holder_t(logrec_buffer_allocator, BUFSIZE).buffer;
    int parse_code;
    int errnum = 0;
    size_t reclen;
@@ -1324,6 +1430,32 @@ bool webalizer_t::get_logrec(lfp_state_t& wlfs, logfile_list_t& logfiles, lfp_st
    return true;
 }
 
+///
+/// @brief  Reads log records from all log files in the time stamp order and
+///         moves them into the log record queue.
+///
+/// This method runs in the log reader thread when `LogReaderThread` is enabled,
+/// so log records are read and parsed while the main thread aggregates log
+/// records parsed earlier. Only the log reader thread may use the parser, the
+/// log files, log file states and log record counts passed into this method 
+/// until the log record queue is destroyed.
+///
+void webalizer_t::read_logrecs(logrec_queue_t& logrec_queue, logfile_list_t& logfiles, lfp_state_list_t& lfp_states, logrec_list_t& logrecs, logrec_counts_t& lrcnt)
+{
+   lfp_state_t wlfs;                   // working log file state
+
+   prep_lfstates(logfiles, lfp_states, logrecs, lrcnt);
+
+   //
+   // Log records are swapped with those in the queue, so the log record in the
+   // working state can be reused for the next record from the same log file.
+   //
+   while(!abort_signal && get_logrec(wlfs, logfiles, lfp_states, logrecs, lrcnt)) {
+      if(!logrec_queue.push_logrec(*wlfs.logrec))
+         break;
+   }
+}
+
 ///
 /// @brief  Reads log records from specified log files and aggregates counts
 ///         for each log record entity, such as an IP address or a URL, in 
@@ -1342,9 +1474,14 @@ int webalizer_t::proc_logfile(proc_times_t& ptms, logrec_counts_t& lrcnt)
    u_short termcnt = 0;
    string_t srchterms;
    string_t urlhost;
+   srch_args_t sr_args;                // search arguments of the current log record
 
    int64_t htab_tstamp = 0;            ///< A time stamp for all hash tables
 
+   tstamp_t last_log_tstamp;           // time stamp of the last log record, as it was parsed
+   tstamp_t last_rec_tstamp;           // time stamp of the last log record, in the reporting time zone
+   int64_t last_htab_tstamp = 0;       // last_rec_tstamp in seconds
+
    uint64_t total_good = 0;
 
    int retcode = 0;
@@ -1355,6 +1492,10 @@ int webalizer_t::proc_logfile(proc_times_t& ptms, logrec_counts_t& lrcnt)
    lfp_state_list_t lfp_states;        // log file states ordered by log time
    logfile_list_t logfiles;            // owns log files
    logrec_list_t logrecs;              // contains one log record per log file; owns log records
+   log_struct *logrec;                 // current log record
+
+   logrec_counts_t reader_lrcnt;       // log record counts maintained by the log reader thread
+   std::unique_ptr<logrec_queue_t> logrec_queue;   // log records read in the log reader thread
    
    tm_ranges_t::iterator dst_iter = config.dst_ranges.begin();
 
@@ -1367,13 +1508,22 @@ int webalizer_t::proc_logfile(proc_times_t& ptms, logrec_counts_t& lrcnt)
    // populate the list of log files and make sure they are readable
    prep_logfiles(logfiles);
 
-   // populate log file states, so we have one log record per log file, ordered by time
-   prep_lfstates(logfiles, lfp_states, logrecs, lrcnt);
+   //
+   // If log files are read in a separate thread, log file states are populated
+   // in that thread. Otherwise populate log file states, so we have one log 
+   // record per log file, ordered by time.
+   //
+   if(config.log_reader_thread) {
+      logrec_queue = std::make_unique<logrec_queue_t>(LOGREC_BATCH_COUNT, LOGREC_BATCH_SIZE);
+      logrec_queue->start([this, &logfiles, &lfp_states, &logrecs, &reader_lrcnt] (logrec_queue_t& queue) {read_logrecs(queue, logfiles, lfp_states, logrecs, reader_lrcnt);});
+   }
+   else
+      prep_lfstates(logfiles, lfp_states, logrecs, lrcnt);
 
    //
    // Main processing loop - go through the log files until we run out of them.
    //
-   while(logfiles.size()) {
+   while(logrec_queue || logfiles.size()) {
       
       // if we detected a Ctrl-C, break out right away 
       if(abort_signal) {
@@ -1381,9 +1531,19 @@ int webalizer_t::proc_logfile(proc_times_t& ptms, logrec_counts_t& lrcnt)
          break;
       }
    
-      // get the next record in the working log file state structure
-      if(get_logrec(wlfs, logfiles, lfp_states, logrecs, lrcnt)) {
-         log_struct& log_rec = *wlfs.logrec;
+      // get the next record from the log reader thread or from the working log file state structure
+      if(logrec_queue)
+         logrec = logrec_queue->next_logrec();
+      else
+         logrec = get_logrec(wlfs, logfiles, lfp_states, logrecs, lrcnt) ? wlfs.logrec : nullptr;
+
+      if(logrec) {
+         log_struct& log_rec = *logrec;
+
+         // time spent in DNS waits, saving state, generating reports and swapping out nodes is excluded
+         profiler_t::timer_t process_timer(profiler, profiler_t::STAGE_PROCESS);
+
+         profiler.add_counts(profiler_t::STAGE_PROCESS, 1, log_rec.xfer_size);
          
          newspammer = newthost = newvisit = false;
 
@@ -1398,19 +1558,32 @@ int webalizer_t::proc_logfile(proc_times_t& ptms, logrec_counts_t& lrcnt)
          // UTCOffset, which may not even be set, in which case it will appear that the time 
          // stamp is adjusted to UTC, while it is actually local time and may be DST adjusted.
          //
-         if(config.local_time != log_rec.tstamp.islocal()) {
-            if(config.local_time)
-               log_rec.tstamp.tolocal(config.get_utc_offset(log_rec.tstamp, dst_iter));
-            else
-               log_rec.tstamp.toutc();
+         // Consecutive log records often have the same time stamp, in which case the time
+         // stamp converted for the previous log record and its value in seconds are reused.
+         //
+         if(log_rec.tstamp.is_same(last_log_tstamp)) {
+            log_rec.tstamp = last_rec_tstamp;
+            htab_tstamp = last_htab_tstamp;
+         }
+         else {
+            last_log_tstamp = log_rec.tstamp;
+
+            if(config.local_time != log_rec.tstamp.islocal()) {
+               if(config.local_time)
+                  log_rec.tstamp.tolocal(config.get_utc_offset(log_rec.tstamp, dst_iter));
+               else
+                  log_rec.tstamp.toutc();
+            }
+
+            // hold onto the time stamp value, so we don't have to do time math more than we need
+            htab_tstamp = last_htab_tstamp = log_rec.tstamp.mktime();
+
+            last_rec_tstamp = log_rec.tstamp;
          }
 
          /* get current records timestamp (seconds since epoch) */
          tstamp_t& rec_tstamp = log_rec.tstamp;
 
-         // hold onto the time stamp value, so we don't have to do time math more than we need
-         htab_tstamp = rec_tstamp.mktime();
-
          //
          // Skip log records that we processed in the past, but not the first few that have 
          // the same time stamp (i.e. the first good log record sets cur_tstamp in the state 
@@ -1480,7 +1653,17 @@ int webalizer_t::proc_logfile(proc_times_t& ptms, logrec_counts_t& lrcnt)
          if (!state.totals.cur_tstamp.null) {
             if (state.totals.cur_tstamp.year != log_rec.tstamp.year || state.totals.cur_tstamp.month != log_rec.tstamp.month)
             {
+               //
+               // Ending downloads only updates download jobs and the download count in
+               // totals, which are not used by DNS resolution or by ending visits, so
+               // timed out downloads are ended on a separate thread while we wait for
+               // DNS look-ups and end visits below. The time stamp is copied for the
+               // thread.
+               //
+               std::future<void> downloads = std::async(std::launch::async, &webalizer_t::update_downloads, this, state.totals.cur_tstamp);
+
                if(config.is_dns_enabled()) {
+                  profiler_t::timer_t timer(profiler, profiler_t::STAGE_DNS);
                   stime = msecs();
                   dns_resolver.dns_wait();
                   ptms.dns_time += elapsed(stime, msecs());
@@ -1494,7 +1677,9 @@ int webalizer_t::proc_logfile(proc_times_t& ptms, logrec_counts_t& lrcnt)
                // no longer match for both months. 
                //
                update_visits(tstamp_t());
-               update_downloads(state.totals.cur_tstamp);
+
+               // rethrows any exception thrown while ending downloads
+               downloads.get();
             
                // state_t::set_tstamp is called later, so update hourly stats now
                state.update_hourly_stats();
@@ -1502,24 +1687,53 @@ int webalizer_t::proc_logfile(proc_times_t& ptms, logrec_counts_t& lrcnt)
                if(config.is_dns_enabled())
                   process_resolved_hosts();
 
-               // save run data for the report generator
-               stime = msecs();
-               state.save_state();
-               ptms.mnt_time += elapsed(stime, msecs());
+               // the previous month's report reads the history file, which is updated when the state is saved
+               wait_month_report(ptms);
 
-               // generate monthly reports if not in batch mode
-               if(!config.batch) {
-                  database_t::status_t status;
+               // save run data for the report generator
+               {
+                  profiler_t::timer_t timer(profiler, profiler_t::STAGE_SAVE);
                   stime = msecs();
-                  if(!(status = state.database.attach_indexes(true)).success())
-                     throw exception_t(0, string_t::_format("Cannot create secondary database indexes (%s)", status.err_msg().c_str()));
-                  write_monthly_report();                /* generate HTML for month */
-                  ptms.rpt_time += elapsed(stime, msecs());
+                  state.save_state();
+                  ptms.mnt_time += elapsed(stime, msecs());
                }
 
-               stime = msecs();
-               state.clear_month();
-               ptms.mnt_time += elapsed(stime, msecs());
+               //
+               // If requested, roll over the database and generate the report for the closed
+               // month from the renamed database file in a separate thread, while log records 
+               // of the new month are processed into a new database.
+               //
+               if(!config.batch && config.month_report_thread) {
+                  string_t db_name;
+
+                  {
+                     profiler_t::timer_t timer(profiler, profiler_t::STAGE_SAVE);
+                     stime = msecs();
+                     db_name = state.clear_month();
+                     ptms.mnt_time += elapsed(stime, msecs());
+                  }
+
+                  month_report = std::async(std::launch::async, &webalizer_t::write_closed_month_report, this, std::move(db_name));
+               }
+               else {
+                  // generate monthly reports if not in batch mode
+                  if(!config.batch) {
+                     profiler_t::timer_t timer(profiler, profiler_t::STAGE_REPORT);
+                     database_t::status_t status;
+                     stime = msecs();
+                     if(!(status = state.database.attach_indexes(true)).success())
+                        throw exception_t(0, string_t::_format("Cannot create secondary database indexes (%s)", status.err_msg().c_str()));
+                     write_monthly_report();                /* generate HTML for month */
+                     ptms.rpt_time += elapsed(stime, msecs());
+                  }
+
+                  {
+                     profiler_t::timer_t timer(profiler, profiler_t::STAGE_SAVE);
+                     stime = msecs();
+                     state.clear_month();
+                     ptms.mnt_time += elapsed(stime, msecs());
+                  }
+               }
             }
          }
 
@@ -1558,7 +1772,7 @@ int webalizer_t::proc_logfile(proc_times_t& ptms, logrec_counts_t& lrcnt)
 
          // remember spammers
          if(spammer)
-            state.sp_htab.insert(log_rec.hostname);
+            state.sp_htab.emplace(log_rec.hostname_hash, log_rec.hostname);
 
          //
          // Filter and, optionally, sort search arguments. Afer filter_srchargs returns,
@@ -1567,7 +1781,6 @@ int webalizer_t::proc_logfile(proc_times_t& ptms, logrec_counts_t& lrcnt)
          // via pointers in sr_args, which point to the search argument string in the the 
          // log record and must be maintained together to avoid dangling pointers.
          //
-         std::vector<arginfo_t, srch_arg_alloc_t> sr_args(srch_arg_alloc);
          filter_srchargs(log_rec.srchargs, sr_args);
 
          /* strip off index.html (or any aliases) */
@@ -1669,7 +1882,7 @@ int webalizer_t::proc_logfile(proc_times_t& ptms, logrec_counts_t& lrcnt)
          if(config.log_type != LOG_SQUID) {
             // if appears to be not a spammer, check their past
             if(!spammer)
-               spammer = state.sp_htab.find(log_rec.hostname) != state.sp_htab.end();
+               spammer = state.sp_htab.find(hashed_string_t(log_rec.hostname_hash, string_t::hold(log_rec.hostname.c_str(), log_rec.hostname.length()))) != state.sp_htab.end();
          }
          
          // initialize those that may be not set otherwise (e.g. if URL is not added)
@@ -1681,7 +1894,7 @@ int webalizer_t::proc_logfile(proc_times_t& ptms, logrec_counts_t& lrcnt)
          // put_hnode sets newvisit and must be called before any other put_xnode 
          // function.
          //
-         hptr = put_hnode(log_rec.hostname, rec_tstamp, htab_tstamp, log_rec.xfer_size, fileurl, pageurl, 
+         hptr = put_hnode(log_rec.hostname, log_rec.hostname_hash, rec_tstamp, htab_tstamp, log_rec.xfer_size, fileurl, pageurl, 
             spammer, ragent != nullptr, target, newvisit, newhost, newthost, newspammer);
 
          // 
@@ -1739,7 +1952,7 @@ int webalizer_t::proc_logfile(proc_times_t& ptms, logrec_counts_t& lrcnt)
          if(config.ntop_downloads || config.dump_downloads) {
             if((sptr = config.downloads.isinglist(log_rec.url)) != nullptr) {
                if(log_rec.resp_code == RC_OK || log_rec.resp_code == RC_PARTIALCONTENT)
-                  put_dlnode(*sptr, htab_tstamp, log_rec.resp_code, rec_tstamp, log_rec.proc_time, log_rec.xfer_size, *hptr, newdl);
+                  put_dlnode(*sptr, htab_tstamp, log_rec.resp_code, rec_tstamp, log_rec.proc_time, log_rec.xfer_size, *hptr, log_rec.hostname_hash, newdl);
             }
          }
 
@@ -1898,27 +2111,44 @@ int webalizer_t::proc_logfile(proc_times_t& ptms, logrec_counts_t& lrcnt)
             process_resolved_hosts();
 
          //
-         // Check periodically whether we need to write some of the values to disk. Doing
-         // so every 10K log records isn't frequent enough to have the evaluation process
-         // slow down log processing, but is not too infrequent to allow memory pile up
-         // between checks.
+         // Write some of the values to disk when hash tables grow past the memory
+         // watermark. Hash tables maintain their combined memory size, so checking
+         // the watermark is cheap and small batches of nodes are swapped out as
+         // soon as memory grows, rather than large ones every so many records.
+         // Nodes not accessed within two visit timeouts may be swapped out.
          //
-         if(total_good % 10000 == 0) {
+         int64_t swap_tstamp = htab_tstamp - static_cast<int64_t>(config.visit_timeout) * 2;
+
+         if(state.is_swap_out_due(swap_tstamp)) {
+            profiler_t::timer_t timer(profiler, profiler_t::STAGE_SWAP_OUT);
             stime = msecs();
             //
             // Use the database cache size as a guiding number for the combined size of
             // our hash tables or 10 MB if the former was not set.
             //
-            state.swap_out(htab_tstamp - static_cast<int64_t>(config.visit_timeout) * 2, config.db_cache_size);
+            state.swap_out(swap_tstamp, config.db_cache_size);
             ptms.mnt_time += elapsed(stime, msecs());
          }
       }
+      else if(logrec_queue) {
+         // the log reader thread read all log files
+         break;
+      }
    }
 
    /*********************************************/
    /* DONE READING LOG FILES - final processing */
    /*********************************************/
    
+   // stop the log reader thread and add up its log record counts
+   if(logrec_queue) {
+      logrec_queue.reset();
+
+      lrcnt.total_rec += reader_lrcnt.total_rec;
+      lrcnt.total_ignore += reader_lrcnt.total_ignore;
+      lrcnt.total_bad += reader_lrcnt.total_bad;
+   }
+
    // if there are any unprocessed log files, close them (e.g. Ctrl-C was pressed)
    for(logfile_list_t::iterator i = logfiles.begin(); i != logfiles.end(); i++) {
       if(*i && (*i)->is_open())
@@ -1946,6 +2176,7 @@ int webalizer_t::proc_logfile(proc_times_t& ptms, logrec_counts_t& lrcnt)
       if (lrcnt.total_rec > (lrcnt.total_ignore + lrcnt.total_bad))  /* did we process any?   */
       {
          if(config.is_dns_enabled()) {
+            profiler_t::timer_t timer(profiler, profiler_t::STAGE_DNS);
             stime = msecs();
             dns_resolver.dns_wait();
             ptms.dns_time += elapsed(stime, msecs());
@@ -1968,10 +2199,15 @@ int webalizer_t::proc_logfile(proc_times_t& ptms, logrec_counts_t& lrcnt)
          if(config.is_dns_enabled())
             process_resolved_hosts();
 
+         wait_month_report(ptms);
+
          // save run data for the report generator
-         stime = msecs();
-         state.save_state();
-         ptms.mnt_time += elapsed(stime, msecs());
+         {
+            profiler_t::timer_t timer(profiler, profiler_t::STAGE_SAVE);
+            stime = msecs();
+            state.save_state();
+            ptms.mnt_time += elapsed(stime, msecs());
+         }
 
          // do not generate reports or roll over the state database if Ctrl-C was pressed
          if(abort_signal)
@@ -1979,6 +2215,7 @@ int webalizer_t::proc_logfile(proc_times_t& ptms, logrec_counts_t& lrcnt)
 
          // generate intermediate reports if not in batch mode
          if(!config.batch) {
+            profiler_t::timer_t timer(profiler, profiler_t::STAGE_REPORT);
             database_t::status_t status;
             stime = msecs();
             if(!(status = state.database.attach_indexes(true)).success())
@@ -1990,6 +2227,7 @@ int webalizer_t::proc_logfile(proc_times_t& ptms, logrec_counts_t& lrcnt)
 
          // if it's the last log for the month, roll over the database
          if(config.last_log) {
+            profiler_t::timer_t timer(profiler, profiler_t::STAGE_SAVE);
             stime = msecs();
             state.clear_month();
             ptms.mnt_time += elapsed(stime, msecs());
@@ -2014,52 +2252,17 @@ int webalizer_t::proc_logfile(proc_times_t& ptms, logrec_counts_t& lrcnt)
       retcode = EXIT_SUCCESS;
    }
 
-   return retcode;
-}
-
-///
-/// @brief  Compares names of the two search arguments and returns a zero if they 
-///         are equal, a negative value if the `e1` name is less than the `e2` name
-///         or a positive value if the `e1` name is greater than the `e2` name.
-///
-int webalizer_t::qs_srcharg_name_cmp(const arginfo_t *e1, const arginfo_t *e2)
-{
-   if(!e1 && !e2)
-      return 0;
-
-   if(!e1 || !e2)
-      return e1 ? 1 : -1;
-
-   return strncmp_ex(e1->name(), e1->namelen, e2->name(), e2->namelen);
-}
-
-///
-/// @brief  Compares the two search arguments and returns a zero if they are equal, 
-///         a negative value if `e1` is less than `e2` or a positive value if `e1` 
-///         is greater than `e2`.
-///
-int webalizer_t::qs_srcharg_cmp(const arginfo_t *e1, const arginfo_t *e2)
-{
-   if(!e1 && !e2)
-      return 0;
-
-   if(!e1 || !e2)
-      return e1 ? 1 : -1;
-
-   if(!e1->arg && !e2->arg)
-      return 0;
-
-   if(!e1->arg || !e2->arg)
-      return e1->arg ? 1 : -1;
+   // report any errors in the closed month's report, if the state was not saved above
+   wait_month_report(ptms);
 
-   return strncmp_ex(e1->arg, e1->arglen, e2->arg, e2->arglen);
+   return retcode;
 }
 
 ///
 /// @brief  Checks if the specified URL, including its search argments, matches 
 ///         any pattern in the IgnoreURL list.
 ///
-bool webalizer_t::check_ignore_url_list(const string_t& url, const string_t& srchargs, std::vector<arginfo_t, srch_arg_alloc_t>& sr_args) const
+bool webalizer_t::check_ignore_url_list(const string_t& url, const string_t& srchargs, const srch_args_t& sr_args) const
 {
    // check the ignore URL filter, which may contain optional search argument names
    const gnode_t *upat = nullptr;
@@ -2079,17 +2282,17 @@ bool webalizer_t::check_ignore_url_list(const string_t& url, const string_t& src
             arginfo_t sa_key(upat->name.c_str(), upat->name.length(), upat->name.length());
 
             // use binary search to check if any of the actual argument names matches
-            if(bsearch(&sa_key, &*sr_args.begin(), sr_args.size(), sizeof(arginfo_t), (int (*)(const void*, const void*)) qs_srcharg_name_cmp))
+            if(std::binary_search(sr_args.begin(), sr_args.end(), sa_key, [] (const arginfo_t& e1, const arginfo_t& e2) {return arginfo_t::name_cmp(&e1, &e2) < 0;}))
                return true;
          }
          else {
             // otherwise make a search argument descriptor for a name that excludes the equal sign in the pattern name
             arginfo_t sa_key(upat->name.c_str(), upat->name.length() - 1, upat->name.length());
 
-            std::vector<arginfo_t, srch_arg_alloc_t>::const_iterator sr_it;
+            const arginfo_t *sr_it;
             
             // cannot use bsearch because we need to traverse all search argument names in sequence
-            sr_it = std::lower_bound(sr_args.begin(), sr_args.end(), sa_key, [] (const arginfo_t& e1, const arginfo_t& e2) {return qs_srcharg_cmp(&e1, &e2) < 0;});
+            sr_it = std::lower_bound(sr_args.begin(), sr_args.end(), sa_key, [] (const arginfo_t& e1, const arginfo_t& e2) {return arginfo_t::arg_cmp(&e1, &e2) < 0;});
 
             // iterate through all search arguments with the same name and compare values
             while(sr_it != sr_args.end() && !strncmp_ex(sr_it->name(), sr_it->namelen, upat->name, upat->name.length() - 1)) {
@@ -2110,18 +2313,24 @@ bool webalizer_t::check_ignore_url_list(const string_t& url, const string_t& src
 /// @brief  Removes excluded search arguments from the URL and optionally sorts
 ///         them by name.
 ///
-void webalizer_t::filter_srchargs(string_t& srchargs, std::vector<arginfo_t, srch_arg_alloc_t>& sr_args)
+/// Search arguments are tokenized once into `sr_args`, which point into `srchargs` 
+/// when this method returns. If the remaining arguments are the same as in the 
+/// original query string, the query string is not changed. If some arguments were 
+/// filtered out, the remaining ones are moved within the same buffer. Only sorted
+/// arguments are copied via an intermediate buffer.
+///
+void webalizer_t::filter_srchargs(string_t& srchargs, srch_args_t& sr_args)
 {
    arginfo_t arginfo;
-   char *cptr;
+   const char *cptr;
+   bool ordered = true, contiguous = true;
    string_t::char_buffer_t sa;
 
+   sr_args.clear();
+
    if(srchargs.isempty())
       return; 
 
-   // there are rarely more than 4-5 search arguments
-   sr_args.reserve(8);
-
    // if no sorting or filtering is requested, return
    if(!config.sort_srch_args && config.incl_srch_args.isempty() && config.excl_srch_args.isempty())
       return;
@@ -2132,9 +2341,7 @@ void webalizer_t::filter_srchargs(string_t& srchargs, std::vector<arginfo_t, src
       return;
    }
 
-   // detach the storage, so we can manipulate the characters directly
-   sa = srchargs.detach();
-   cptr = sa.get_buffer();
+   cptr = srchargs.c_str();
 
    // walk search arguments and create descriptors for those that aren't filtered out
    while (*cptr && *cptr != '#') {
@@ -2156,58 +2363,103 @@ void webalizer_t::filter_srchargs(string_t& srchargs, std::vector<arginfo_t, src
             (config.incl_srch_args.isinlistex(arginfo.name(), arginfo.namelen, false) || 
             !config.excl_srch_args.isinlistex(arginfo.name(), arginfo.namelen, false)))) {
 
-         if(sr_args.size() >= sr_args.capacity())
-            sr_args.reserve(sr_args.capacity() << 1);
          sr_args.push_back(arginfo);
       }
    }
 
    // if none remaining, return
-   if(!sr_args.size()) {
+   if(sr_args.empty()) {
       srchargs.reset();
       return;
    }
 
-   // sort the resulting vector, if requested
+   // sort the resulting array, if requested
    if(config.sort_srch_args && sr_args.size() > 1)
-      qsort(&sr_args[0], sr_args.size(), sizeof(arginfo_t), (int (*)(const void*, const void*)) qs_srcharg_name_cmp);
-
-   // get a buffer to copy filtered and possibly sorted search arguments
-   string_t::char_buffer_t&& buffer = buffer_holder_t(buffer_allocator, BUFSIZE).buffer;
+      sr_args.sort_by_name();
 
-   // form a new search argument string in the buffer
-   cptr = buffer;
+   // check if remaining arguments are in their original order and separated by single ampersands
    for(size_t index = 0; index < sr_args.size(); index++) {
-      if(index > 0)
-         *cptr++ = '&';
+      const char *prev_end = index ? sr_args[index-1].arg + sr_args[index-1].arglen + 1 : srchargs.c_str();
 
-      // hold onto the new name position in the buffer
-      const char *argname = cptr;
+      if(sr_args[index].arg != prev_end) {
+         contiguous = false;
 
-      cptr += strncpy_ex(cptr, BUFSIZE - (cptr-buffer), sr_args[index].arg, sr_args[index].arglen);
+         if(index && sr_args[index].arg < prev_end) {
+            ordered = false;
+            break;
+         }
+      }
+   }
 
-      // make sure we copied the entire argument
-      if(cptr - argname != sr_args[index].arglen)
-         throw std::runtime_error("Cannot filter search arguments because the buffer is too small");
+   // check if the last argument ends the query string (e.g. not followed by a fragment)
+   if(contiguous && sr_args[sr_args.size()-1].arg + sr_args[sr_args.size()-1].arglen != srchargs.c_str() + srchargs.length())
+      contiguous = false;
 
-      // re-point the argument name within the original character buffer (will contain garbage until memcpy below)
-      sr_args[index].arg = sa.get_buffer() + (argname - buffer);
-   }
+   if(!contiguous) {
+      char *bptr;
+      size_t slen;
+
+      // detach the storage, so we can manipulate the characters directly
+      sa = srchargs.detach();
+
+      if(ordered) {
+         // move the remaining arguments towards the beginning of the same buffer
+         bptr = sa.get_buffer();
+
+         for(size_t index = 0; index < sr_args.size(); index++) {
+            if(index > 0)
+               *bptr++ = '&';
+
+            // arguments never move forward, so the next one is never overwritten
+            memmove(bptr, sr_args[index].arg, sr_args[index].arglen);
+
+            sr_args[index].arg = bptr;
+            bptr += sr_args[index].arglen;
+         }
+
+         slen = bptr - sa.get_buffer();
+      }
+      else {
+         // get a buffer to copy sorted search arguments
+         string_t::char_buffer_t&& buffer = buffer_holder_t(buffer_allocator, BUFSIZE).buffer;
+
+         // form a new search argument string in the buffer
+         bptr = buffer;
+         for(size_t index = 0; index < sr_args.size(); index++) {
+            if(index > 0)
+               *bptr++ = '&';
+
+            // hold onto the new name position in the buffer
+            const char *argname = bptr;
+
+            bptr += strncpy_ex(bptr, BUFSIZE - (bptr-buffer), sr_args[index].arg, sr_args[index].arglen);
 
-   // copy to the original character buffer (sr_args can be used again after this)
-   memcpy(sa, buffer, cptr-buffer);
-   sa[cptr-buffer] = 0;
+            // make sure we copied the entire argument
+            if(bptr - argname != sr_args[index].arglen)
+               throw std::runtime_error("Cannot filter search arguments because the buffer is too small");
 
-   // attach the memory block to the string
-   srchargs.attach(std::move(sa), cptr-buffer);
+            // re-point the argument name within the original character buffer (will contain garbage until memcpy below)
+            sr_args[index].arg = sa.get_buffer() + (argname - buffer);
+         }
+
+         // copy to the original character buffer (sr_args can be used again after this)
+         slen = bptr - buffer;
+         memcpy(sa, buffer, slen);
+      }
+
+      sa[slen] = 0;
+
+      // attach the memory block to the string
+      srchargs.attach(std::move(sa), slen);
+   }
 
-   // clear the vector if the ignore URL list doesn't have search argument names and make sure it's sorted otherwise
+   // clear the array if the ignore URL list doesn't have search argument names and make sure it's sorted otherwise
    if(!config.ignored_urls.get_has_names())
       sr_args.clear();
    else {
-      // if the vector was not sorted for output, sort it for the ignore filter
+      // if the array was not sorted for output, sort it for the ignore filter
       if(!config.sort_srch_args && sr_args.size() > 1)
-         qsort(&sr_args[0], sr_args.size(), sizeof(arginfo_t), (int (*)(const void*, const void*)) qs_srcharg_name_cmp);
+         sr_args.sort_by_name();
    }
 }
 
@@ -2245,6 +2497,43 @@ bool webalizer_t::check_for_spam_urls(const char *str, size_t slen) const
    return false;
 }
 
+///
+/// @brief  Finds a run of search engine list entries matching the referrer.
+///
+/// If `SearchEngineHostMatch` is enabled and all search engine patterns are plain host
+/// names, they are matched against the referrer host name and matching runs are kept in
+/// a hash map keyed by the host name, so each subsequent lookup for the same host is a
+/// single hash probe. Otherwise, the search list is scanned for every referrer, matching
+/// patterns against the entire URL.
+///
+bool webalizer_t::find_srch_engines(const string_t& refer, glist::const_iterator& first, glist::const_iterator& last)
+{
+   string_t::const_char_buffer_t host;
+
+   if(!srch_hosts_only || (host = get_url_host(refer.c_str(), refer.length())).isempty())
+      return config.search_list.find_node_run(refer, first, last);
+
+   // the host name is not null-terminated within the referrer, so copy it into the lookup key
+   srch_host.assign(host, host.capacity());
+
+   srch_host_map_t::const_iterator iter = srch_hosts.find(srch_host);
+
+   if(iter == srch_hosts.end()) {
+      config.search_list.find_node_run(srch_host, first, last);
+
+      // the number of referrer hosts is unbounded, so start over when the map is full
+      if(srch_hosts.size() >= SRCH_HOSTS_MAX)
+         srch_hosts.clear();
+
+      iter = srch_hosts.emplace(srch_host, srch_run_t {first, last}).first;
+   }
+
+   first = iter->second.first;
+   last = iter->second.last;
+
+   return first != last;
+}
+
 ///
 /// @brief  Extracts and decodes search engine search terms from the referrer URL.
 ///
@@ -2259,7 +2548,7 @@ bool webalizer_t::srch_string(const string_t& refer, const string_t& srchargs, u
    bool newsrch = false;
    size_t slen = 0, qlen = 0;
    u_int dblscnt = 0;              // double slash count
-   glist::const_iterator iter = config.search_list.begin();
+   glist::const_iterator iter, last;
 
    // reset the search term string and count
    srchterms.clear();
@@ -2279,9 +2568,15 @@ bool webalizer_t::srch_string(const string_t& refer, const string_t& srchargs, u
    // be evaluated for performance reasons, to avoid traversing the entire 
    // list every time.
    //
-   // $$$ search_list will find the domain if it's mentioned anywhere in the URL !!!
+   // Unless patterns are matched against host names, they are matched against
+   // the entire URL and will find the domain if it's mentioned anywhere in the
+   // URL.
    //
-   while((nptr = config.search_list.find_node(refer, iter, (nptr != nullptr))) != nullptr) {
+   if(!find_srch_engines(refer, iter, last))
+      return false;
+
+   for(; iter != last; iter++) {
+      nptr = &*iter;
 
       // walk the query and look for the name we found for this domain
       cp1 = srchargs;
@@ -2409,6 +2704,7 @@ void webalizer_t::unpack_inactive_hnode_cb(hnode_t& hnode, bool active, void *ar
 ///
 storable_t<hnode_t> *webalizer_t::put_hnode(
                const string_t& ipaddr,          // IP address
+               uint64_t hashval,                // IP address hash
                const tstamp_t& tstamp,          // timestamp 
                int64_t  htab_tstamp,            // serial time stamp
                uint64_t xfer,                   // xfer size 
@@ -2424,14 +2720,11 @@ storable_t<hnode_t> *webalizer_t::put_hnode(
                )
 {
    bool found = true;
-   uint64_t hashval;
    storable_t<hnode_t> *cptr;
    storable_t<vnode_t> *visit;
 
    newnode = newvisit = newthost = newspammer = false;
 
-   hashval = hnode_t::hash_key(ipaddr);
-
    /* check if hashed */
    if((cptr = state.hm_htab.find_node(hashval, OBJ_REG, htab_tstamp, ipaddr)) == nullptr) {
       /* not hashed */
@@ -2518,6 +2811,17 @@ storable_t<hnode_t> *webalizer_t::put_hnode(
    if(target && !robot && !spammer && !cptr->visit->converted)
       cptr->visit->converted = true;
 
+   //
+   // Schedule the host node to be checked for a visit timeout. Scheduled nodes are
+   // not rescheduled on every request, but rather when they expire and the visit is
+   // found to be still active. A visit that exceeded the maximum length is checked
+   // at the next update.
+   //
+   if(config.max_visit_length && cptr->visit->end.elapsed(cptr->visit->start) >= config.max_visit_length)
+      state.visit_timers.schedule(*cptr, htab_tstamp);
+   else if(!cptr->is_scheduled())
+      state.visit_timers.schedule(*cptr, htab_tstamp + config.visit_timeout);
+
    if(cptr->storage_info.storage)
       cptr->storage_info.set_modified();
 
@@ -2910,7 +3214,7 @@ inode_t *webalizer_t::put_inode(const string_t& str,   /* ident str */
 ///
 /// @brief  Adds or updates a download node in the state database.
 ///
-dlnode_t *webalizer_t::put_dlnode(const string_t& name, int64_t htab_tstamp, u_int respcode, const tstamp_t& tstamp, uint64_t proctime, uint64_t xfer, storable_t<hnode_t>& hnode, bool& newnode)
+dlnode_t *webalizer_t::put_dlnode(const string_t& name, int64_t htab_tstamp, u_int respcode, const tstamp_t& tstamp, uint64_t proctime, uint64_t xfer, storable_t<hnode_t>& hnode, uint64_t hosthash, bool& newnode)
 {
    bool found = true;
    uint64_t hashval;
@@ -2925,7 +3229,7 @@ dlnode_t *webalizer_t::put_dlnode(const string_t& name, int64_t htab_tstamp, u_i
    if(respcode != RC_OK && respcode != RC_PARTIALCONTENT)
       return nullptr;
 
-   hashval = dlnode_t::hash_key(hnode.string, name);
+   hashval = dlnode_t::hash_key(hosthash, name);
 
    if((nptr = state.dl_htab.find_node(hashval, OBJ_REG, htab_tstamp, hnode.string, name)) == nullptr) {
       nptr = new storable_t<dlnode_t>(name, hnode);
@@ -2967,6 +3271,10 @@ dlnode_t *webalizer_t::put_dlnode(const string_t& name, int64_t htab_tstamp, u_i
       nptr->download->proctime += proctime;
    }
 
+   // schedule the download node to be checked for a download timeout (see put_hnode)
+   if(!nptr->is_scheduled())
+      state.download_timers.schedule(*nptr, htab_tstamp + config.download_timeout);
+
    if(nptr->storage_info.storage)
       nptr->storage_info.set_modified();
 
@@ -3160,20 +3468,32 @@ storable_t<vnode_t> *webalizer_t::end_visit_cb(storable_t<hnode_t> *hnode, void
 }
 
 ///
-/// @brief  Checks all hosts for active visits and ends those that exceed the
+/// @brief  Checks hosts with active visits and ends those that exceed the
 ///         maximum visit time or all if we are ending a month.
 ///
+/// Only host nodes that expired in the visit timer wheel are checked. Visits
+/// that are still active are rescheduled to expire after the visit timeout
+/// past their last request.
+///
 /// Deletes all returned ended visits, as we have no use for them at this point.
 ///
 void webalizer_t::update_visits(const tstamp_t& tstamp)
 {
-   vnode_t *visit;
-   hash_table<storable_t<hnode_t>>::iterator h_iter = state.hm_htab.begin();
-   
-   while(h_iter.next()) {
-      if((visit = update_visit(h_iter.item(), tstamp)) != nullptr)
+   auto expire_cb = [this, &tstamp](timer_node_t& node)
+   {
+      storable_t<hnode_t>& hnode = static_cast<storable_t<hnode_t>&>(static_cast<hnode_t&>(node));
+      vnode_t *visit;
+
+      if((visit = update_visit(&hnode, tstamp)) != nullptr)
          delete visit;
-   }
+      else if(hnode.visit)
+         state.visit_timers.schedule(hnode, hnode.visit->end.mktime() + config.visit_timeout);
+   };
+
+   if(tstamp.null)
+      state.visit_timers.expire_all(expire_cb);
+   else
+      state.visit_timers.expire(tstamp.mktime(), expire_cb);
 }
 
 ///
@@ -3250,21 +3570,30 @@ storable_t<danode_t> *webalizer_t::end_download_cb(storable_t<dlnode_t> *dlnode,
 }
 
 ///
-/// @brief  Checks all download nodes and ends all active downloads that exceed the 
-///         maximum download time.
+/// @brief  Checks download nodes with active downloads and ends those that exceed
+///         the maximum download time.
+///
+/// Only download nodes that expired in the download timer wheel are checked and
+/// those with downloads that are still active are rescheduled. Downloads are never
+/// ended without a time stamp.
 ///
 /// Deletes all returned ended downloads, as we have no use for them at this point. 
 ///
 void webalizer_t::update_downloads(const tstamp_t& tstamp)
 {
-   storable_t<danode_t> *download;
-   storable_t<dlnode_t> *nptr;
-   dl_hash_table::iterator iter = state.dl_htab.begin();
+   if(tstamp.null)
+      return;
+
+   state.download_timers.expire(tstamp.mktime(), [this, &tstamp](timer_node_t& node)
+   {
+      storable_t<dlnode_t>& dlnode = static_cast<storable_t<dlnode_t>&>(static_cast<dlnode_t&>(node));
+      storable_t<danode_t> *download;
 
-   while((nptr = iter.next()) != nullptr) {
-      if((download = update_download(nptr, tstamp)) != nullptr)
+      if((download = update_download(&dlnode, tstamp)) != nullptr)
          delete download;
-   }
+      else if(dlnode.download)
+         state.download_timers.schedule(dlnode, dlnode.download->tstamp.mktime() + config.download_timeout);
+   });
 }
 
 ///
@@ -3399,6 +3728,8 @@ int webalizer_t::read_log_line(string_t::char_buffer_t& buffer, logfile_t& logfi
 {
    int reclen = 0, errnum = 0;
 
+   profiler_t::timer_t timer(profiler, profiler_t::STAGE_READ);
+
    // read the line ad check if there's no more data; EOF is checked in logfile_t::get_line
    while((reclen = logfile.get_line(buffer, (u_int) buffer.capacity(), &errnum)) != 0) {
       
@@ -3413,8 +3744,10 @@ int webalizer_t::read_log_line(string_t::char_buffer_t& buffer, logfile_t& logfi
       lrcnt.total_rec++;
       
       // if the buffer is not full, return
-      if((size_t) reclen < buffer.capacity()-1 || buffer[buffer.capacity()-1] == '\n')
+      if((size_t) reclen < buffer.capacity()-1 || buffer[buffer.capacity()-1] == '\n') {
+         profiler.add_counts(profiler_t::STAGE_READ, 1, reclen);
          return reclen;
+      }
       
       lrcnt.total_bad++;              /* bump bad record counter      */
 
@@ -3470,6 +3803,10 @@ int webalizer_t::parse_log_record(string_t::char_buffer_t& buffer, size_t reclen
    if(config.debug_mode)
       lrecstr = buffer;
 
+   profiler_t::timer_t timer(profiler, profiler_t::STAGE_PARSE);
+
+   profiler.add_counts(profiler_t::STAGE_PARSE, 1, reclen);
+
    if((parse_code = parser.parse_record(buffer, reclen, logrec)) == PARSE_CODE_ERROR) {
 
       /* really bad record... */
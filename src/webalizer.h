@@ -27,10 +27,16 @@
 #include "logfile.h"
 #include "pool_allocator.h"
 #include "p2_buffer_allocator.h"
+#include "logrec_queue.h"
+#include "srch_args.h"
+#include "profiler.h"
 
 #include <zlib.h>
 #include <vector>
 #include <list>
+#include <unordered_map>
+#include <future>
+#include <atomic>
 
 #ifndef _WIN32
 #include <netinet/in.h>       /* needed for in_addr structure definition   */
@@ -52,51 +58,6 @@ class webalizer_t {
       typedef p2_buffer_allocator_tmpl<string_t::char_type> buffer_allocator_t;
       typedef char_buffer_holder_tmpl<string_t::char_type, size_t> buffer_holder_t;
       
-      ///
-      /// @brief  A URL search argument descriptor
-      ///
-      /// A search argument descriptor that points to the beginning of a search argument 
-      /// within a query string. The descriptor does not own memory contaiing the search 
-      /// argument and must have shorter life span than the underlying query string.
-      ///
-      /// Pointers returned from `name` and `value` methods should not be used in pointer
-      /// arithmetic because they may return pointer values outside of the query string 
-      /// range. Neither method ever returns a nullptr pointer.
-      ///
-      struct arginfo_t {
-         const char  *arg;             ///< Points to a search argument within the query string
-         size_t      namelen;          ///< Search argument name length
-         size_t      arglen;           ///< Entire search argument length, including name and value
-         
-         /// Constructs an empty search argument descriptor.
-         arginfo_t(void) : arg(nullptr), namelen(0), arglen(0) {}
-
-         /// Constructs a complete search argument descriptor
-         arginfo_t(const char *arg, size_t namelen, size_t arglen) : arg(arg), namelen(namelen), arglen(arglen) {}
-
-         /// Returns a pointer to the search argument name or an empty string if there is none.
-         const char *name(void) const
-         {
-            return namelen ? arg : "";
-         }
-
-         /// Returns the length of the search argument value (zero if there is no value).
-         size_t value_length(void) const 
-         {
-            // value is present only if there is an equal sign, even if namelen is zero
-            return namelen == arglen ? 0 : arglen - namelen - 1;
-         }
-
-         /// Return a pointer to the search argument value or an empty string, if there is none.
-         const char *value(void) const
-         {
-            return namelen == arglen ? "" : arg + namelen + 1;
-         }
-      };
-
-      // search argument vector allocator
-      typedef pool_allocator_t<arginfo_t, 8> srch_arg_alloc_t;
-      
       ///
       /// @brief  Log file parser state descriptor
       ///
@@ -163,6 +124,17 @@ class webalizer_t {
          uint64_t rpt_time = 0;                    ///< report time
       };
 
+      ///
+      /// @brief  A run of consecutive search engine list entries matching a referrer host name
+      ///
+      struct srch_run_t {
+         glist::const_iterator   first;      ///< First matching search list entry
+         glist::const_iterator   last;       ///< One past the last matching search list entry
+      };
+
+      /// Search engine list entries indexed by referrer host name
+      typedef std::unordered_map<string_t, srch_run_t, hash_string> srch_host_map_t;
+
       ///
       /// @brief  Run time log record counts
       ///
@@ -173,7 +145,7 @@ class webalizer_t {
       };
 
    private:
-      static bool abort_signal;                    ///< Was Ctrl-C pressed?
+      static std::atomic<bool> abort_signal;       ///< Was Ctrl-C pressed? (set in a signal handler or a console handler thread)
       
       const config_t& config;                      ///< Read-only application configuration object
       
@@ -181,28 +153,49 @@ class webalizer_t {
       state_t     state;                           ///< Monthly state database
       dns_resolver_t dns_resolver;                 ///< DNS and GeoIP resolver database
 
+      profiler_t  profiler;                        ///< Processing stage times and counters
+
       std::vector<output_t*> output;               ///< Report generators
 
+      std::future<void> month_report;              ///< Report for a closed month, generated in a separate thread
+
       buffer_allocator_t buffer_allocator;         ///< Pooled buffer allocator
+      buffer_allocator_t logrec_buffer_allocator;  ///< Pooled buffer allocator for reading log files, which may be done in a separate thread
 
       ua_token_alloc_t ua_token_alloc;             ///< Pooled user agent token allocator
       ua_grp_idx_alloc_t ua_grp_idx_alloc;         ///< Pooled group index user agent token allocator
 
-      srch_arg_alloc_t srch_arg_alloc;             ///< Pooled search argument allocator 
+      srch_host_map_t srch_hosts;                  ///< Search engine list entries indexed by referrer host name
+      string_t srch_host;                          ///< Referrer host name used as a search engine lookup key
+      bool srch_hosts_only;                        ///< Are all search engine patterns plain host names?
+
+      static const size_t SRCH_HOSTS_MAX = 16384;  ///< Maximum number of referrer host names in `srch_hosts`
+
+      static const size_t LOGREC_BATCH_COUNT = 8;  ///< Number of log record batches in the log reader queue
+      static const size_t LOGREC_BATCH_SIZE = 512; ///< Number of log records in each log reader queue batch
 
    private:
-      bool init_output_engines(void);
-      void cleanup_output_engines(void);
+      bool init_output_engines(void) {return init_output_engines(state, output);}
+      bool init_output_engines(const state_t& state, std::vector<output_t*>& output) const;
+      void cleanup_output_engines(void) {cleanup_output_engines(output);}
+      static void cleanup_output_engines(std::vector<output_t*>& output);
+
+      void report_profile(void);
 
       void write_main_index(void);
-      void write_monthly_report(void);
+      void write_monthly_report(void) {write_monthly_report(state, output);}
+      void write_monthly_report(const state_t& state, const std::vector<output_t*>& output) const;
+
+      void write_closed_month_report(const string_t& db_name) const;
+      void wait_month_report(proc_times_t& ptms);
       
       bool check_for_spam_urls(const char *str, size_t slen) const;
+      bool find_srch_engines(const string_t& refer, glist::const_iterator& first, glist::const_iterator& last);
       bool srch_string(const string_t& refer, const string_t& srchargs, u_short& termcnt, string_t& srchterms, bool spamcheck);
       void group_host_by_name(const hnode_t& hnode, const vnode_t& vnode);
       void process_resolved_hosts(void);
-      bool check_ignore_url_list(const string_t& url, const string_t& srchargs, std::vector<arginfo_t, srch_arg_alloc_t>& sr_args) const;
-      void filter_srchargs(string_t& srchargs, std::vector<arginfo_t, srch_arg_alloc_t>& sr_args);
+      bool check_ignore_url_list(const string_t& url, const string_t& srchargs, const srch_args_t& sr_args) const;
+      void filter_srchargs(string_t& srchargs, srch_args_t& sr_args);
       void proc_index_alias(string_t& url);
       void mangle_user_agent(string_t& agent);
       void filter_user_agent(string_t& agent);
@@ -216,6 +209,7 @@ class webalizer_t {
       void prep_logfiles(logfile_list_t& logfiles);
       void prep_lfstates(logfile_list_t& logfiles, lfp_state_list_t& lfp_states, logrec_list_t& logrecs, logrec_counts_t& lrcnt);
       bool get_logrec(lfp_state_t& wlfs, logfile_list_t& logfiles, lfp_state_list_t& lfp_states, logrec_list_t& logrecs, logrec_counts_t& lrcnt);
+      void read_logrecs(logrec_queue_t& logrec_queue, logfile_list_t& logfiles, lfp_state_list_t& lfp_states, logrec_list_t& logrecs, logrec_counts_t& lrcnt);
       
       int read_log_line(string_t::char_buffer_t& buffer, logfile_t& logfile, logrec_counts_t& lrcnt); 
       int parse_log_record(string_t::char_buffer_t& buffer, size_t reclen, log_struct& logrec, u_int fileid, uint64_t recnum);
@@ -223,7 +217,7 @@ class webalizer_t {
       //
       // put_xnode methods
       //
-      storable_t<hnode_t> *put_hnode(const string_t& ipaddr, const tstamp_t& tstamp, int64_t relts, uint64_t xfer, bool fileurl, bool pageurl, bool spammer, bool robot, bool target, bool& newvisit, bool& newnode, bool& newthost, bool& newspammer);
+      storable_t<hnode_t> *put_hnode(const string_t& ipaddr, uint64_t hashval, const tstamp_t& tstamp, int64_t relts, uint64_t xfer, bool fileurl, bool pageurl, bool spammer, bool robot, bool target, bool& newvisit, bool& newnode, bool& newthost, bool& newspammer);
       storable_t<hnode_t> *put_hnode(const string_t& grpname, int64_t relts, uint64_t hits, uint64_t files, uint64_t pages, uint64_t xfer, uint64_t visitlen, bool& newnode);
 
       rnode_t *put_rnode(const string_t&, int64_t relts, nodetype_t type, uint64_t, bool newvisit, bool& newnode);
@@ -238,13 +232,11 @@ class webalizer_t {
 
       rcnode_t *put_rcnode(const string_t& method, int64_t relts, const string_t& url, u_short respcode, bool restore, uint64_t count, bool *newnode = nullptr);
 
-      dlnode_t *put_dlnode(const string_t& name, int64_t relts, u_int respcode, const tstamp_t& tstamp, uint64_t proctime, uint64_t xfer, storable_t<hnode_t>& hnode, bool& newnode);
+      dlnode_t *put_dlnode(const string_t& name, int64_t relts, u_int respcode, const tstamp_t& tstamp, uint64_t proctime, uint64_t xfer, storable_t<hnode_t>& hnode, uint64_t hosthash, bool& newnode);
 
       //
       //
       //
-      static int qs_srcharg_name_cmp(const arginfo_t *e1, const arginfo_t *e2);
-      static int qs_srcharg_cmp(const arginfo_t *e1, const arginfo_t *e2);
 
       static void unpack_inactive_hnode_cb(hnode_t& hnode, bool active, void *_this);
 